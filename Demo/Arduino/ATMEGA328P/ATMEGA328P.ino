@@ -24,13 +24,28 @@ TinyCmd_CallBack_Ret LED_Callback() {
   return TINYCMD_FAILED;
 }
 
-TinyCmd_Command LED_Command = {"LED", LED_Callback};
+static TINYCMD_NAME(LED_Name, "LED");
+TinyCmd_Command LED_Command = {LED_Name, LED_Callback};
+
+// TinyCmd 的串口收发和时间接口
+static void Serial_SendChar(char c) {
+  Serial.write(c);
+}
+
+static int Serial_ReadChar(void) {
+  return Serial.read();
+}
 
 void setup() {
   // 初始化串口通信
   Serial.begin(115200);
   Serial.println("Setup started");
 
+  // 设置 TinyCmd 的串口收发和时间接口
+  TinyCmd_SendChar = Serial_SendChar;
+  TinyCmd_ReadChar = Serial_ReadChar;
+  TinyCmd_Millis = millis;
+
   // 添加命令到命令列表
   TinyCmd_Add_Cmd(&LED_Command);
 
@@ -41,30 +56,15 @@ void setup() {
 }
 
 void loop() {
-  while (Serial.available()) {
-    char c = Serial.read();
-
-    // 将读取的字符添加到缓冲区
-    TinyCmd_buf.input[TinyCmd_buf.length++] = c;
-
-    // 检查是否接收到换行符
-    if (c == '\n') {
-
-      // 打印接收到的字符串
-      Serial.print("Received: ");
-      Serial.println(TinyCmd_buf.input);
-
-      // 调用命令处理器
-      TinyCmd_Handler();
-
-    }
-  }
+  // 读取串口收到的字符，收到换行符后调用命令处理器
+  TinyCmd_Poll();
 }
 
 
 
 // 主函数
 int main(void) {
+  init();  // Arduino 的定时器(millis)等初始化
   setup();
 
   sei();  // 启用全局中断
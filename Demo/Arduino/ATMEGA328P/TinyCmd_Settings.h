@@ -0,0 +1,36 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Settings.h
+ * Author: Civic_Crab
+ * Version: 1.2.0
+ * Created on: 2024-10-24
+ *
+ * Description:
+ * Settings of the ATmega328P demo, included by TinyCmd.h. The Arduino IDE takes no -D flags.
+ * TinyCmd.c and TinyCmd.h in this folder are copies of the core in the root of the repository, made by
+ * "make arduino" (tools/TinyCmd_Arduino_Sync.py). Don't edit them here.
+ */
+
+#ifndef __TINYCMD_SETTINGS_H__
+#define __TINYCMD_SETTINGS_H__
+
+//2 KB of RAM: minimum footprint profile, command names and format strings in flash
+#define CMD_PROFILE_MIN
+#define CMD_USE_PROGMEM
+
+#endif // __TINYCMD_SETTINGS_H__
@@ -26,6 +26,8 @@
 
 #include "TinyCmd.h"
 #include <stdarg.h>
+#include <limits.h>
+#include <string.h>
 #ifndef NULL
 #define NULL ((void *)0)
 #endif //NULL
@@ -51,14 +53,444 @@ typedef struct TinyCmd_List {
 
 }TinyCmd_List;
 
+#ifdef CMD_USE_STREAM
+#if CMD_VAR_LIST_SIZE > 32
+#error "CMD_VAR_LIST_SIZE must not be bigger than 32"
+#endif
+#if (CMD_STREAM_RING_SIZE & (CMD_STREAM_RING_SIZE - 1)) != 0
+#error "CMD_STREAM_RING_SIZE must be a power of two"
+#endif
+
+//Binary stream frame: sync, seq, n, n * 4 bytes little endian samples, xor of seq..samples
+#define STREAM_FRAME_SYNC 0xA5
+
+typedef struct TinyCmd_Stream {
+    TinyCmd_Var* list[CMD_VAR_LIST_SIZE];
+    TinyCmd_Counter_Type length;
+    unsigned long select;
+    TinyCmd_Counter_Type row_len;
+    TinyCmd_Counter_Type decimation;
+    TinyCmd_StreamMode mode;
+    volatile TinyCmd_Counter_Type running;
+    volatile TinyCmd_Counter_Type tick;
+    //head is written by TinyCmd_Stream_Tick, tail by TinyCmd_Stream_Flush.
+    volatile unsigned short head;
+    volatile unsigned short tail;
+    volatile long ring[CMD_STREAM_RING_SIZE];
+    volatile unsigned long rows;
+    volatile unsigned long dropped;
+    unsigned long sent;
+    unsigned char seq;
+    TinyCmd_Counter_Type keyframe;
+    long last[CMD_VAR_LIST_SIZE];
+}TinyCmd_Stream;
+#endif //CMD_USE_STREAM
+
+#ifdef CMD_USE_XFER
+#if CMD_XFER_CHUNK > 255
+#error "CMD_XFER_CHUNK must not be bigger than 255"
+#endif
+
+#define XFER_SYNC 0x5A
+#define XFER_ACK  0x06
+#define XFER_NAK  0x15
+#define XFER_CAN  0x18
+
+typedef enum {
+    XFER_IDLE = 0,
+    XFER_RX,
+    XFER_TX,
+}TinyCmd_Xfer_Mode;
+
+typedef enum {
+    XFER_HUNT = 0,
+    XFER_SEQ,
+    XFER_LEN,
+    XFER_DATA,
+    XFER_CRC0,
+    XFER_CRC1,
+    XFER_CANCEL,
+}TinyCmd_Xfer_State;
+
+typedef struct TinyCmd_Xfer {
+    volatile unsigned char mode;
+    unsigned char state;
+    //Receive: chunk being parsed and the next expected sequence number
+    unsigned char seq;
+    unsigned char frame_seq;
+    unsigned char frame_len;
+    unsigned char pos;
+    unsigned char nak_sent;
+    unsigned short crc;
+    unsigned char chunk[CMD_XFER_CHUNK];
+    TinyCmd_Xfer_Sink sink;
+    //Send: first chunk not acknowledged and next chunk to send
+    const unsigned char* src;
+    unsigned char base_seq;
+    volatile unsigned char next_seq;
+    volatile unsigned long base;
+    volatile unsigned long next;
+    unsigned long offset;
+    unsigned long total;
+    //CMD_MILLIS() of the last byte received
+    volatile unsigned long stamp;
+}TinyCmd_Xfer;
+#endif //CMD_USE_XFER
+
+#ifdef CMD_USE_LINE_EDIT
+#if !defined(CMD_USE_LARGE_BUFFER) && CMD_EDIT_HISTORY_SIZE > 255
+#error "CMD_EDIT_HISTORY_SIZE must not be bigger than 255 without CMD_USE_LARGE_BUFFER"
+#endif
+
+//Decoder states of the line editor: plain characters, after ESC, after "ESC [" or "ESC O", in "ESC [ n ~"
+typedef enum {
+    EDIT_PLAIN = 0,
+    EDIT_ESC,
+    EDIT_CSI,
+    EDIT_PARAM,
+}TinyCmd_Edit_State;
+
+//Keys of the line editor
+typedef enum {
+    KEY_NONE = 0,
+    KEY_INSERT,
+    KEY_ENTER,
+    KEY_BACKSPACE,
+    KEY_DELETE,
+    KEY_LEFT,
+    KEY_RIGHT,
+    KEY_HOME,
+    KEY_END,
+    KEY_UP,
+    KEY_DOWN,
+    KEY_ESC,
+    KEY_TAB,
+}TinyCmd_Edit_Key;
+
+//Candidates of a Tab completion
+typedef struct TinyCmd_Completion {
+    const char* word;
+    TinyCmd_Counter_Type len;
+    //First candidate and the length all candidates have in common
+    const char* first;
+    TinyCmd_Status first_flash;
+    TinyCmd_Counter_Type count;
+    TinyCmd_Counter_Type common;
+    //Print the candidates instead of counting them
+    TinyCmd_Status list;
+}TinyCmd_Completion;
+
+typedef struct TinyCmd_Edit {
+    unsigned char state;
+    unsigned char param;
+    unsigned char last;
+    //A line is entered and waits for TinyCmd_Handler(), set until TinyCmd_Buf_Clear()
+    unsigned char pending;
+    TinyCmd_Counter_Type cursor;
+    //History: lines separated by '\0', oldest first. pos is the line shown, used when none is.
+    TinyCmd_Counter_Type used;
+    TinyCmd_Counter_Type pos;
+    char history[CMD_EDIT_HISTORY_SIZE];
+}TinyCmd_Edit;
+#endif //CMD_USE_LINE_EDIT
+
+#ifdef CMD_USE_ALIAS
+#if !defined(CMD_USE_LARGE_BUFFER) && CMD_ALIAS_ARENA_SIZE > 255
+#error "CMD_ALIAS_ARENA_SIZE must not be bigger than 255 without CMD_USE_LARGE_BUFFER"
+#endif
+#if !defined(CMD_USE_LARGE_BUFFER) && CMD_ALIAS_LINE_SIZE > 255
+#error "CMD_ALIAS_LINE_SIZE must not be bigger than 255 without CMD_USE_LARGE_BUFFER"
+#endif
+
+//Aliases: "name\0text\0" entries packed from the start of the arena, used bytes are taken.
+//Steps of a macro are separated by ';' in its text.
+typedef struct TinyCmd_Alias {
+    TinyCmd_Counter_Type used;
+    //An alias is running, its steps are read from the arena so it must not change
+    unsigned char running;
+    //Lines expanded and bytes copied by the expansions
+    unsigned long expanded;
+    unsigned long copied;
+    char arena[CMD_ALIAS_ARENA_SIZE];
+    //Step being run, TinyCmd_buf.input keeps the line and the lines received after it
+    char line[CMD_ALIAS_LINE_SIZE];
+}TinyCmd_Alias;
+#endif //CMD_USE_ALIAS
+
+#ifdef CMD_USE_SCRIPT
+#if !defined(CMD_USE_LARGE_BUFFER) && CMD_SCRIPT_LINE_SIZE > 255
+#error "CMD_SCRIPT_LINE_SIZE must not be bigger than 255 without CMD_USE_LARGE_BUFFER"
+#endif
+//Compiled script (tools/TinyCmd_Compile.py): "TCS", version, count, count command names ending with '\0',
+//then the lines: name index, argc, argc arguments. An argument is flags, len, len characters, '\0',
+//the bytes of the magnitude little endian and the IEEE-754 double little endian if COMPILED_DOUBLE.
+#define COMPILED_VERSION  1
+#define COMPILED_UINT     0x01 //str_to_uint() succeeded
+#define COMPILED_NEGATIVE 0x02 //with a '-' sign
+#define COMPILED_FLOAT    0x04 //str_to_float() succeeded, the value is the signed magnitude
+#define COMPILED_DOUBLE   0x08 //str_to_float() succeeded, the value follows
+#define COMPILED_BYTES(flags) ((flags) >> 4) //Bytes of the magnitude, 0 to 8
+#define COMPILED_NUM(p) ((p) + 2 + (p)[1] + 1)
+#define COMPILED_SIZE(p) (2 + (p)[1] + 1 + COMPILED_BYTES((p)[0]) + (((p)[0] & COMPILED_DOUBLE) ? 8 : 0))
+#endif //CMD_USE_SCRIPT
+
+#ifdef CMD_USE_CACHE
+#if !defined(CMD_USE_LARGE_BUFFER) && CMD_CACHE_SLOT_SIZE > 255
+#error "CMD_CACHE_SLOT_SIZE must not be bigger than 255 without CMD_USE_LARGE_BUFFER"
+#endif
+
+//A kept response: the arguments of the command, each ending with '\0', then the bytes its callback sent
+typedef struct TinyCmd_Cache_Slot {
+    //Command of the response, NULL for a free slot
+    const TinyCmd_Command* cmd;
+    //CMD_MILLIS() when the callback ran, and the lookup of the last use: the smallest is replaced
+    unsigned long stamp;
+    unsigned long used;
+    //Bytes of the arguments, and of the arguments and the response
+    TinyCmd_Counter_Type key;
+    TinyCmd_Counter_Type len;
+    TinyCmd_CallBack_Ret ret;
+    char data[CMD_CACHE_SLOT_SIZE];
+}TinyCmd_Cache_Slot;
+
+typedef struct TinyCmd_Cache {
+    TinyCmd_Cache_Slot slot[CMD_CACHE_SLOTS];
+    //Slot the output of the running command is copied to, NULL if none.
+    //keep is cleared when the output doesn't fit or TinyCmd_Cache_Clear() is called meanwhile.
+    TinyCmd_Cache_Slot* capture;
+    unsigned char keep;
+    unsigned long lookups;
+    unsigned long hits;
+    unsigned long misses;
+    //Responses not kept because they are bigger than a slot
+    unsigned long big;
+}TinyCmd_Cache;
+#endif //CMD_USE_CACHE
+
+#ifdef CMD_USE_PRIORITY
+#if CMD_URGENT_TOKENS > CMD_MAX_TOKENS
+#error "CMD_URGENT_TOKENS must not be bigger than CMD_MAX_TOKENS"
+#endif
+
+typedef struct TinyCmd_Prio {
+    //An urgent command is running, its output goes to CMD_SEND_URGENT
+    volatile unsigned char urgent;
+}TinyCmd_Prio;
+#endif //CMD_USE_PRIORITY
+
+#ifdef CMD_USE_FLOW
+#if CMD_FLOW_LOW >= CMD_FLOW_HIGH || CMD_FLOW_HIGH >= CMD_BUF_SIZE
+#error "CMD_FLOW_LOW must be below CMD_FLOW_HIGH, and CMD_FLOW_HIGH below CMD_BUF_SIZE"
+#endif
+
+typedef struct TinyCmd_Flow {
+    //The sender is stopped
+    volatile unsigned char stopped;
+    //Lines dropped for lack of room, lines longer than TinyCmd_buf.input, times the sender was stopped
+    unsigned int dropped;
+    unsigned int overlong;
+    unsigned int stops;
+}TinyCmd_Flow;
+#endif //CMD_USE_FLOW
+
+#ifdef CMD_USE_TIMING
+#if CMD_TIMING_BUCKETS < 1 || CMD_TIMING_BUCKETS > 32
+#error "CMD_TIMING_BUCKETS must be from 1 to 32"
+#endif
+
+//Phases of TinyCmd_Handler() timed by CMD_CYCLES()
+typedef enum {
+    TIMING_TRIM = 0,
+    TIMING_TOKENIZE,
+    TIMING_LOOKUP,
+    TIMING_CALLBACK,
+    TIMING_CLEAR,
+    TIMING_PHASES
+}TinyCmd_Timing_Phase;
+
+typedef struct TinyCmd_Timing {
+    //A line of TinyCmd_Handler() is being timed, and CMD_CYCLES() at the end of the last phase
+    unsigned char on;
+    unsigned long stamp;
+    //Histogram and longest time of each phase
+    unsigned int count[TIMING_PHASES][CMD_TIMING_BUCKETS];
+    unsigned long max[TIMING_PHASES];
+}TinyCmd_Timing;
+
+#define TIMING_START() timing_start()
+#define TIMING_MARK(phase) timing_mark(phase)
+#define TIMING_STOP() (TinyCmd_timing.on = 0)
+//The callback is timed as a whole, the lines it runs itself (scripts...) are not timed. It declares a variable.
+#define TIMING_PAUSE() unsigned char timing_on = TinyCmd_timing.on; TinyCmd_timing.on = 0
+#define TIMING_RESUME() (TinyCmd_timing.on = timing_on)
+#else
+#define TIMING_START()
+#define TIMING_MARK(phase)
+#define TIMING_STOP()
+#define TIMING_PAUSE()
+#define TIMING_RESUME()
+#endif //CMD_USE_TIMING
+
+#if defined(CMD_USE_PRIORITY) || defined(CMD_USE_FLOW)
+//The lines received while the main loop runs one are kept after it in TinyCmd_buf.input
+#define CMD_LINE_QUEUE
+
+//What is done with the rest of a line not fitting in TinyCmd_buf.input
+typedef enum {
+    QUEUE_TAKE = 0,    //It fits
+    QUEUE_DROP,        //Skipped up to the end of line, the line is dropped
+    QUEUE_CUT,         //Skipped up to the end of line, the first characters are run
+}TinyCmd_Queue_Skip;
+
+typedef struct TinyCmd_Queue {
+    //End of the line left to the main loop, 0 if none, and start of the line being received after it
+    volatile TinyCmd_Counter_Type end;
+    volatile TinyCmd_Counter_Type start;
+    volatile unsigned char skip;
+}TinyCmd_Queue;
+#endif //CMD_USE_PRIORITY || CMD_USE_FLOW
+
+#ifdef CMD_USE_DEFER_REPORT
+//Deferred report frame: sync, format index, raw arguments
+#define DEFER_FRAME_SYNC 0xA6
+#endif //CMD_USE_DEFER_REPORT
+
+//Scratch buffers: number formatting of TinyCmd_Report, memory dump and stream text lines
+#define REPORT_NUM_SIZE (CMD_FMT_MAX_PRECISION + 24)
+#ifdef CMD_USE_DUMP
+#if CMD_DUMP_LINE < 1 || CMD_DUMP_LINE > 48
+#error "CMD_DUMP_LINE must be from 1 to 48, a hexdump line is counted in TinyCmd_Counter_Type"
+#endif
+//Address, space, 3 characters per byte and a space before every 8 bytes, " |", the ASCII column, "|\n"
+#define DUMP_LINE_SIZE (sizeof(void*) * 2 + 5 + CMD_DUMP_LINE * 4 + (CMD_DUMP_LINE + 7) / 8)
+#define DUMP_BASE64_SIZE (64 + 1)
+#else
+#define DUMP_LINE_SIZE 0
+#define DUMP_BASE64_SIZE 0
+#endif //CMD_USE_DUMP
+#ifdef CMD_USE_STREAM
+//Digits of a long, sign and '\0' per value, a comma after each value, '=' and '\n'
+#define STREAM_VALUE_SIZE (sizeof(long) * CHAR_BIT * 3 / 10 + 3)
+#define STREAM_LINE_SIZE ((STREAM_VALUE_SIZE + 1) * CMD_VAR_LIST_SIZE + 2)
+//A longer line than TinyCmd_Counter_Type can count is sent in pieces
+#define STREAM_FLUSH_AT ((TinyCmd_Counter_Type)~(TinyCmd_Counter_Type)0 - STREAM_VALUE_SIZE - 2)
+#else
+#define STREAM_LINE_SIZE 0
+#endif //CMD_USE_STREAM
+#define SCRATCH_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CMD_SCRATCH_SIZE SCRATCH_MAX(SCRATCH_MAX(REPORT_NUM_SIZE, DUMP_LINE_SIZE), SCRATCH_MAX(DUMP_BASE64_SIZE, STREAM_LINE_SIZE))
+
+#if defined(CMD_USE_SHARED_SCRATCH) && defined(CMD_USE_PRIORITY)
+//An urgent command reports from the receive interrupt, maybe while the main loop uses the shared buffer
+#define SCRATCH_BUFFER(name, size) char* const name = TinyCmd_prio.urgent ? TinyCmd_scratch_urgent : TinyCmd_scratch
+#elif defined(CMD_USE_SHARED_SCRATCH)
+#define SCRATCH_BUFFER(name, size) char* const name = TinyCmd_scratch
+#else
+#define SCRATCH_BUFFER(name, size) char name[size]
+#endif //CMD_USE_SHARED_SCRATCH
+
 //Local Variables****************************************************************//
-static char* strtok_next = NULL;
+#ifdef CMD_USE_SHARED_SCRATCH
+static char TinyCmd_scratch[CMD_SCRATCH_SIZE];
+#ifdef CMD_USE_PRIORITY
+static char TinyCmd_scratch_urgent[CMD_SCRATCH_SIZE];
+#endif //CMD_USE_PRIORITY
+#endif //CMD_USE_SHARED_SCRATCH
 TinyCmd_List TinyCmdRunning_Cmd;
-TinyCmd_Counter_Type token_count;
+#ifdef CMD_USE_STREAM
+static TinyCmd_Stream TinyCmd_stream;
+#endif //CMD_USE_STREAM
+#ifdef CMD_USE_XFER
+static TinyCmd_Xfer TinyCmd_xfer;
+#endif //CMD_USE_XFER
+#ifdef CMD_USE_ALIAS
+static TinyCmd_Alias TinyCmd_alias;
+//Words of the line after the arguments TinyCmd_Run() keeps, NULL if there are none
+static const char* TinyCmd_alias_rest;
+#endif //CMD_USE_ALIAS
+#ifdef CMD_USE_SCRIPT
+//Arguments of the compiled line running, NULL for arguments parsed from text
+static const unsigned char* TinyCmd_compiled_num[CMD_MAX_PARAMS];
+//Copies of the script lines running, a nested script copies its lines after the used bytes
+static char TinyCmd_script_copy[CMD_SCRIPT_LINE_SIZE];
+static TinyCmd_Counter_Type TinyCmd_script_used;
+#endif //CMD_USE_SCRIPT
+#ifdef CMD_USE_CACHE
+static TinyCmd_Cache TinyCmd_cache;
+#endif //CMD_USE_CACHE
+#ifdef CMD_USE_PRIORITY
+static TinyCmd_Prio TinyCmd_prio;
+#endif //CMD_USE_PRIORITY
+#ifdef CMD_USE_FLOW
+static TinyCmd_Flow TinyCmd_flow;
+#endif //CMD_USE_FLOW
+#ifdef CMD_LINE_QUEUE
+static TinyCmd_Queue TinyCmd_queue;
+#endif //CMD_LINE_QUEUE
+#ifdef CMD_USE_TIMING
+static TinyCmd_Timing TinyCmd_timing;
+#endif //CMD_USE_TIMING
+
+#ifdef CMD_USE_SECTION
+//Start and end of the "tinycmd_cmd" section, defined by the linker.
+//They are weak, so a program registering no command still links and the section is empty.
+#if defined(__ARMCC_VERSION)
+extern const TinyCmd_Command TinyCmd_Section_Start[] __asm("tinycmd_cmd$$Base") __attribute__((weak));
+extern const TinyCmd_Command TinyCmd_Section_Stop[] __asm("tinycmd_cmd$$Limit") __attribute__((weak));
+#else
+extern const TinyCmd_Command TinyCmd_Section_Start[] __asm("__start_tinycmd_cmd") __attribute__((weak));
+extern const TinyCmd_Command TinyCmd_Section_Stop[] __asm("__stop_tinycmd_cmd") __attribute__((weak));
+#endif
+
+//The registered commands sorted by TinyCmd_Section_Init(), searched like TinyCmdRunning_Cmd.
+//The section is scanned while it is not sorted.
+static TinyCmd_Command* TinyCmd_section[CMD_SECTION_SIZE];
+static TinyCmd_Counter_Type TinyCmd_section_length;
+static unsigned char TinyCmd_section_sorted;
+#endif //CMD_USE_SECTION
+
+//Default port hooks, they do nothing so TinyCmd runs before the port is set up
+static void TinyCmd_Send_Nothing(char c) {
+    (void)c;
+}
+
+static int TinyCmd_Read_Nothing(void) {
+    return -1;
+}
+
+static unsigned long TinyCmd_Millis_Zero(void) {
+    return 0;
+}
+
+#ifdef CMD_LINE_QUEUE
+static void TinyCmd_Send_Queued(char c) {
+    CMD_SEND_CHAR(c);
+}
+#endif //CMD_LINE_QUEUE
+
+#ifdef CMD_USE_FLOW
+static void TinyCmd_Send_XonXoff(TinyCmd_Status go) {
+    CMD_SEND_URGENT(go ? 0x11 : 0x13);
+}
+#endif //CMD_USE_FLOW
 
 //Global Variables****************************************************************//
 TinyCmd_Buffer TinyCmd_buf;
-SendCharFunc TinyCmd_SendChar = NULL;
+SendCharFunc TinyCmd_SendChar = TinyCmd_Send_Nothing;
+ReadCharFunc TinyCmd_ReadChar = TinyCmd_Read_Nothing;
+MillisFunc TinyCmd_Millis = TinyCmd_Millis_Zero;
+#ifdef CMD_LINE_QUEUE
+SendCharFunc TinyCmd_SendUrgent = TinyCmd_Send_Queued;
+#endif //CMD_LINE_QUEUE
+#ifdef CMD_USE_FLOW
+FlowFunc TinyCmd_FlowControl = TinyCmd_Send_XonXoff;
+#endif //CMD_USE_FLOW
+#ifdef CMD_USE_TIMING
+CyclesFunc TinyCmd_Cycles = TinyCmd_Millis_Zero;
+#endif //CMD_USE_TIMING
+#ifdef CMD_USE_XFER
+TinyCmd_Xfer_Sink TinyCmd_XferSink = NULL;
+#endif //CMD_USE_XFER
 
 //Local Function****************************************************************//
 
@@ -143,16 +575,56 @@ static TinyCmd_Counter_Type TinyCmd_strlen(const char* str) {
     return p - str;
 }
 
+static void TinyCmd_Arg_Clear(void)
+{
+    for(TinyCmd_Counter_Type i = 0; i < CMD_MAX_PARAMS && TinyCmd_buf.arg[i] != NULL; i++) {
+        TinyCmd_buf.arg[i] = NULL;
+    }
+#ifdef CMD_USE_ALIAS
+    TinyCmd_alias_rest = NULL;
+#endif //CMD_USE_ALIAS
+}
+
+#ifdef CMD_LINE_QUEUE
+static void queue_keep(void);
+#endif //CMD_LINE_QUEUE
+#ifdef CMD_USE_LINE_EDIT
+static TinyCmd_Edit TinyCmd_edit;
+#endif //CMD_USE_LINE_EDIT
+#ifdef CMD_USE_FLOW
+static void flow_check(TinyCmd_Counter_Type level);
+#endif //CMD_USE_FLOW
+#ifdef CMD_USE_TIMING
+static void timing_start(void);
+static void timing_mark(TinyCmd_Timing_Phase phase);
+#endif //CMD_USE_TIMING
+
+//Only the used part is cleared, so the cost follows the line and not CMD_BUF_SIZE.
+//A line written without TinyCmd_buf.length (fgets...) is cleared up to its first '\0'.
 static TinyCmd_Status TinyCmd_Buf_Clear(void)
 {
     TinyCmd_Counter_Type i = 0;
-    for(i = 0; i < CMD_MAX_PARAMS; i++) {
-        TinyCmd_buf.arg[i] = NULL;
+    TinyCmd_Arg_Clear();
+#ifdef CMD_LINE_QUEUE
+    if (TinyCmd_queue.end > 0) {
+        queue_keep();
+        return TINYCMD_SUCCESS;
     }
-    for(i = 0; i < CMD_BUF_SIZE; i++) {
+#endif //CMD_LINE_QUEUE
+    for(i = 0; i < CMD_BUF_SIZE && (i < TinyCmd_buf.length || TinyCmd_buf.input[i] != '\0'); i++) {
         TinyCmd_buf.input[i] = '\0';
     }
     TinyCmd_buf.length = 0;
+#ifdef CMD_USE_LINE_EDIT
+    TinyCmd_edit.pending = 0;
+#endif //CMD_USE_LINE_EDIT
+#if defined(CMD_USE_FLOW) && defined(CMD_USE_LINE_EDIT)
+    {
+        CMD_PORT_ENTER_CRITICAL();
+        flow_check(0);
+        CMD_PORT_EXIT_CRITICAL();
+    }
+#endif //CMD_USE_FLOW && CMD_USE_LINE_EDIT
 
     return TINYCMD_SUCCESS;
 }
@@ -206,6 +678,29 @@ static TinyCmd_Status str_to_uint(const char* str, unsigned long long* result, i
         str++;
     }
 
+    //Hexadecimal number such as 0x1F, the prefix must be followed by a digit
+    if (str[0] == '0' && TinyCmd_tolower(str[1]) == 'x') {
+        const char* digits = str + 2;
+        str += 2;
+        for (;;) {
+            char c = TinyCmd_tolower(*str);
+            int digit;
+            if (TinyCmd_isdigit(c)) {
+                digit = c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else {
+                break;
+            }
+            if (*result >> 60) {
+                return TINYCMD_FAILED;
+            }
+            *result = (*result << 4) | digit;
+            str++;
+        }
+        return str != digits ? TINYCMD_SUCCESS : TINYCMD_FAILED;
+    }
+
     while (TinyCmd_isdigit(*str)) {
         unsigned long long new_result = *result * 10 + (*str - '0');
         if (new_result < *result) {
@@ -218,21 +713,6 @@ static TinyCmd_Status str_to_uint(const char* str, unsigned long long* result, i
     return TINYCMD_SUCCESS;
 }
 
-static TinyCmd_Status str_to_int(const char* str, long long* result, int* sign) {
-    unsigned long long unsigned_result;
-    TinyCmd_Status status = str_to_uint(str, &unsigned_result, sign);
-    if (status != TINYCMD_SUCCESS) {
-        return TINYCMD_FAILED;
-    }
-
-    *result = (long long)unsigned_result;
-    if (*sign == -1) {
-        *result = -*result;
-    }
-
-    return TINYCMD_SUCCESS;
-}
-
 static TinyCmd_Status str_to_float(const char* str, double* result) {
     if (!str || !result) {
         return TINYCMD_FAILED;
@@ -278,8 +758,11 @@ static TinyCmd_Status str_to_float(const char* str, double* result) {
         } else if (*str == '+') {
             str++;
         }
+        //Any exponent past 1000 gives inf or 0 already, stop there to keep it in the range of an int
         while (TinyCmd_isdigit((unsigned char)*str)) {
-            exponent = exponent * 10.0 + (*str - '0');
+            if (exponent < 1000.0) {
+                exponent = exponent * 10.0 + (*str - '0');
+            }
             str++;
         }
     }
@@ -295,56 +778,64 @@ static TinyCmd_Status str_to_float(const char* str, double* result) {
     return TINYCMD_SUCCESS;
 }
 
-static void itoa(int value, char* buffer, int base) {
-    char* p = buffer;
-    int sign = (base == 10 && value < 0);
-    unsigned int uvalue = (sign) ? -value : value;
+static const char TinyCmd_digits[] = "0123456789abcdef0123456789ABCDEF";
 
-    do {
-        int remainder = uvalue % base;
-        *p++ = (remainder < 10) ? remainder + '0' : remainder + 'a' - 10;
-    } while (uvalue /= base);
+//static char* utoa_rev(char* end, unsigned long long value, unsigned char base, TinyCmd_Counter_Type upper)
+//Description:Write the digits of value backwards, ending before end. Returns the first digit.
+//            The 64-bit division is only used while value doesn't fit in an unsigned long.
+static char* utoa_rev(char* end, unsigned long long value, unsigned char base, TinyCmd_Counter_Type upper)
+{
+    const char* digits = TinyCmd_digits + (upper ? 16 : 0);
+    unsigned long small;
 
-    if (sign) {
-        *p++ = '-';
+    while ((unsigned long)value != value) {
+        *--end = digits[value % base];
+        value /= base;
     }
 
-    *p = '\0';
-    for (int i = 0, j = p - buffer - 1; i < j; i++, j--) {
-        char temp = buffer[i];
-        buffer[i] = buffer[j];
-        buffer[j] = temp;
-    }
+    small = (unsigned long)value;
+    do {
+        *--end = digits[small % base];
+    } while (small /= base);
+
+    return end;
 }
 
-static void uitoa(unsigned int value, char* buffer, int base) {
+static void dtoa(double value, char* buffer, int precision) {
+    char digits[20];
     char* p = buffer;
-    do {
-        int remainder = value % base;
-        *p++ = (remainder < 10) ? remainder + '0' : remainder + 'a' - 10;
-    } while (value /= base);
+    char* q;
+    unsigned long long integer_part;
+    double fractional_part;
 
-    *p = '\0';
-    for (int i = 0, j = p - buffer - 1; i < j; i++, j--) {
-        char temp = buffer[i];
-        buffer[i] = buffer[j];
-        buffer[j] = temp;
+    if (value != value) {
+        TinyCmd_strcpy(buffer, "nan");
+        return;
     }
-}
 
-static void dtoa(double value, char* buffer, int precision) {
-    int integer_part = (int)value;
-    double fractional_part = value - integer_part;
+    if (value < 0) {
+        *p++ = '-';
+        value = -value;
+    }
 
-    if(fractional_part < 0)
-    {
-        fractional_part = -fractional_part;
+    //Round to the last printed decimal instead of truncating
+    value += 0.5 * TinyCmd_pow(10.0, -precision);
+    //The integer part has to fit in 64 bits, converting a bigger value is undefined
+    if (value >= 18446744073709551616.0) {
+        TinyCmd_strcpy(p, "inf");
+        return;
     }
+    integer_part = (unsigned long long)value;
+    fractional_part = value - integer_part;
 
-    itoa(integer_part, buffer, 10);
-    char* p = buffer + TinyCmd_strlen(buffer);
+    q = utoa_rev(digits + sizeof(digits), integer_part, 10, 0);
+    while (q < digits + sizeof(digits)) {
+        *p++ = *q++;
+    }
 
-    *p++ = '.';
+    if (precision > 0) {
+        *p++ = '.';
+    }
 
     for (int i = 0; i < precision; i++) {
         fractional_part *= 10;
@@ -356,9 +847,30 @@ static void dtoa(double value, char* buffer, int precision) {
     *p = '\0';
 }
 
+#ifdef CMD_USE_CACHE
+static void cache_capture(const char* buf, unsigned long len);
+#endif //CMD_USE_CACHE
+
 //TinyCmd_Status TinyCmd_SendChar(char c)
 //Description:Send a character to some where user designated.
 static void send_string(const char* str) {
+#ifdef CMD_USE_CACHE
+    if (TinyCmd_cache.capture != NULL) {
+        const char* end = str;
+        while (*end != '\0') {
+            end++;
+        }
+        cache_capture(str, (unsigned long)(end - str));
+    }
+#endif //CMD_USE_CACHE
+#ifdef CMD_USE_PRIORITY
+    if (TinyCmd_prio.urgent) {
+        while (*str) {
+            CMD_SEND_URGENT(*str++);
+        }
+        return;
+    }
+#endif //CMD_USE_PRIORITY
 #ifndef USE_USART_DMA_SEND_STR
     while (*str)
     {
@@ -369,6 +881,49 @@ static void send_string(const char* str) {
 #endif
 }
 
+//static void send_bytes(const char* buf, TinyCmd_Counter_Type len)
+//Description:Send a block of bytes (may contain '\0') to some where user designated.
+static void send_bytes(const char* buf, TinyCmd_Counter_Type len) {
+#ifdef CMD_USE_CACHE
+    if (TinyCmd_cache.capture != NULL) {
+        cache_capture(buf, len);
+    }
+#endif //CMD_USE_CACHE
+#ifdef CMD_USE_PRIORITY
+    if (TinyCmd_prio.urgent) {
+        while (len--) {
+            CMD_SEND_URGENT(*buf++);
+        }
+        return;
+    }
+#endif //CMD_USE_PRIORITY
+#ifndef CMD_SEND_BYTES
+    while (len--)
+    {
+        CMD_SEND_CHAR(*buf++);
+    }
+#else
+    CMD_SEND_BYTES(buf, len);
+#endif
+}
+
+//static void send_char(char c)
+//Description:Send one character of the output of a command, it is kept with the response (CMD_USE_CACHE).
+static void send_char(char c) {
+#ifdef CMD_USE_CACHE
+    if (TinyCmd_cache.capture != NULL) {
+        cache_capture(&c, 1);
+    }
+#endif //CMD_USE_CACHE
+#ifdef CMD_USE_PRIORITY
+    if (TinyCmd_prio.urgent) {
+        CMD_SEND_URGENT(c);
+        return;
+    }
+#endif //CMD_USE_PRIORITY
+    CMD_SEND_CHAR(c);
+}
+
 //TinyCmd_Status TinyCmd_trim(char *str)
 //Description:Trim the unnecessary shit(' ','\r','\n') characters from the end of the string.
 static void TinyCmd_trim(char *str) {
@@ -397,323 +952,3854 @@ char* TinyCmd_strcpy(char* dest, const char* src)
     return dest;
 }
 
-//TinyCmd_Status TinyCmd_Init(void):
-//Description:Call this function when TinyCmd_buf is filled ,namely after you call TinyCmd_PutString()
-//Returns:
-//        TINYCMD_SUCCESS: Initialization successful.
-//        TINYCMD_FAILED: Initialization failed.
-TinyCmd_Status TinyCmd_Handler(void) {
-    TinyCmd_Counter_Type i = 0;
-    const char* delims = " ";
-    char* context;
+//Command names may be flash strings (CMD_USE_PROGMEM), they are only read through NAME_CHAR
+#define NAME_CHAR(name) ((char)TINYCMD_READ_BYTE(name))
 
-    TinyCmd_trim(TinyCmd_buf.input);
+//Lists up to this length are scanned for the exact name instead of binary searched
+#define FIND_SCAN_LENGTH 8
 
-    //Read Command
-    char* token = TinyCmd_strtok_s(TinyCmd_buf.input, delims, &context);
-    char* command = token;
+#ifdef CMD_USE_SUB
+#define CMD_HAS_SUB(cmd) ((cmd)->sub_count > 0)
+#else
+#define CMD_HAS_SUB(cmd) 0
+#endif //CMD_USE_SUB
 
-    //Read arguments
-    token = TinyCmd_strtok_s(NULL, delims ,&context);
+//Modes of TinyCmd_Cmd_Order: key is a typed word, a typed prefix or another command name
+#define ORDER_KEY    0
+#define ORDER_PREFIX 1
+#define ORDER_NAMES  2
 
-    while (token != NULL) {
-        if (token_count < CMD_MAX_TOKENS) {
-            TinyCmd_buf.arg[i++] = token;
-        }
-        else {
-            // Maximum number of tokens reached.
-            strtok_next = NULL;
-            break;
-        }
-        token = TinyCmd_strtok_s(NULL, delims ,&context);
-    }
+//static int TinyCmd_Cmd_Order(const char* name, const char* key, unsigned char mode)
+//Description:Order of the sorted command list: case folded first, names equal but for case by the exact compare.
+//            With ORDER_PREFIX, 0 if name starts with key, ignoring case.
+//Returns:
+//        <0, 0 or >0 as name is ordered before, equal to or after key.
+static int TinyCmd_Cmd_Order(const char* name, const char* key, unsigned char mode)
+{
+    const char* n = name;
+    const char* k = key;
+    char nc = NAME_CHAR(n);
+    char kc = (mode == ORDER_NAMES) ? NAME_CHAR(k) : *k;
 
-    TinyCmd_Report("Command: %s\n", command);
-    TinyCmd_Report("Number of args: %d\n", i);
-    for (TinyCmd_Counter_Type j = 0; j < i; j++)
-    {
-        TinyCmd_Report("Arg[%d]: %s\n", j, TinyCmd_buf.arg[j]);
+    while (kc != '\0' && TinyCmd_tolower(nc) == TinyCmd_tolower(kc)) {
+        n++;
+        k++;
+        nc = NAME_CHAR(n);
+        kc = (mode == ORDER_NAMES) ? NAME_CHAR(k) : *k;
+    }
+    if (kc == '\0' && mode == ORDER_PREFIX) {
+        return 0;
+    }
+    if (TinyCmd_tolower(nc) != TinyCmd_tolower(kc)) {
+        return (unsigned char)TinyCmd_tolower(nc) - (unsigned char)TinyCmd_tolower(kc);
     }
-    
-    //Excute callback function of command
-    for (i = 0; i < TinyCmdRunning_Cmd.length; i++) {
 
-        if (!TinyCmd_strcmp(command, TinyCmdRunning_Cmd.list[i]->command))
-        {
-            TinyCmdRunning_Cmd.list[i]->callback();
-            //Clear TinyCmd_buf
-            TinyCmd_Buf_Clear();
+    //Equal but for case
+    n = name;
+    k = key;
+    do {
+        nc = NAME_CHAR(n++);
+        kc = (mode == ORDER_NAMES) ? NAME_CHAR(k++) : *k++;
+    } while (nc == kc && nc != '\0');
+
+    return (unsigned char)nc - (unsigned char)kc;
+}
+
+//static TinyCmd_Status TinyCmd_Name_Equal(const char* name, const char* key)
+//Description:Check if the command name is exactly the typed word key.
+static TinyCmd_Status TinyCmd_Name_Equal(const char* name, const char* key)
+{
+    char c;
+
+    while ((c = NAME_CHAR(name)) == *key) {
+        if (c == '\0') {
             return TINYCMD_SUCCESS;
         }
+        name++;
+        key++;
     }
 
-    //Clear TinyCmd_buf
-    TinyCmd_Buf_Clear();
     return TINYCMD_FAILED;
 }
 
-//TinyCmd_Status TinyCmd_Add_Cmd(TinyCmd_Command* newCmd):
-//Description:Add a new command to the TinyCmdRunning_Cmd list.
-//args:
-//        newCmd: Pointer to the TinyCmd_Command struct containing the command and callback function.
-//Returns:
-//        TINYCMD_SUCCESS: Command added successfully.
-//        TINYCMD_FAILED: Command addition failed.
-TinyCmd_Status TinyCmd_Add_Cmd(TinyCmd_Command* newCmd)
+#ifdef CMD_USE_ABBREV
+//static TinyCmd_Counter_Type TinyCmd_Name_Len(const char* name)
+static TinyCmd_Counter_Type TinyCmd_Name_Len(const char* name)
 {
-    if (newCmd == NULL){
-        return TINYCMD_FAILED;
+    TinyCmd_Counter_Type len = 0;
+
+    while (NAME_CHAR(name + len) != '\0') {
+        len++;
     }
-    else{
-        if(newCmd->callback != NULL){
-            TinyCmdRunning_Cmd.list[TinyCmdRunning_Cmd.length++] = newCmd;
-            return TINYCMD_SUCCESS;
-        }
-        else{
-            return TINYCMD_FAILED;
+
+    return len;
+}
+#endif
+
+//static TinyCmd_Counter_Type TinyCmd_Cmd_Lower_Bound(TinyCmd_Command* const* list, TinyCmd_Counter_Type length, const char* command)
+//Description:Binary search of a sorted command list, TinyCmdRunning_Cmd or the subcommands of a command.
+//Returns:
+//        Index of the first command not ordered before command, length if there is none.
+//        The commands starting with command (ignoring case) follow from there.
+static TinyCmd_Counter_Type TinyCmd_Cmd_Lower_Bound(TinyCmd_Command* const* list, TinyCmd_Counter_Type length, const char* command)
+{
+    TinyCmd_Counter_Type low = 0;
+    TinyCmd_Counter_Type high = length;
+
+    while (low < high) {
+        TinyCmd_Counter_Type mid = low + (high - low) / 2;
+        if (TinyCmd_Cmd_Order(list[mid]->command, command, ORDER_KEY) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
     }
-}
 
+    return low;
+}
 
-//TinyCmd_Status TinyCmd_Arg_Check(char* arg1,TinyCmd_Counter_Type p_arg):
-//Description:Check if the argument at position p_arg2 matches the given argument arg1.
-//args:
-//        arg1: Pointer to the argument string to compare.
-//        p_arg2: Position of the argument in the TinyCmd_buf.arg array.
+#ifdef CMD_USE_ABBREV
+//static TinyCmd_Counter_Type TinyCmd_Cmd_Abbrev(TinyCmd_Command* const* list, TinyCmd_Counter_Type length, const char* command, const TinyCmd_Command** found)
+//Description:Find the commands of a sorted list starting with command, ignoring case.
+//            A name equal to command but for case wins over the longer ones ("led" runs "LED", not "led2").
 //Returns:
-//        TINYCMD_SUCCESS: Argument matches.
-//        TINYCMD_FAILED: Argument does not match.
-TinyCmd_Status TinyCmd_Arg_Check(const char* arg1,TinyCmd_Counter_Type p_arg2)
+//        Number of matches, 2 for two or more. found is set to the match.
+static TinyCmd_Counter_Type TinyCmd_Cmd_Abbrev(TinyCmd_Command* const* list, TinyCmd_Counter_Type length,
+                                               const char* command, const TinyCmd_Command** found)
 {
-    if(!TinyCmd_strcmp(arg1,TinyCmd_buf.arg[p_arg2]))
-    {
-        return TINYCMD_SUCCESS;
+    TinyCmd_Counter_Type i = TinyCmd_Cmd_Lower_Bound(list, length, command);
+
+    //Names equal to command but for case may be ordered before it
+    while (i > 0 && !TinyCmd_Cmd_Order(list[i - 1]->command, command, ORDER_PREFIX)) {
+        i--;
     }
-    else{
-        return TINYCMD_FAILED;
+    if (i >= length || TinyCmd_Cmd_Order(list[i]->command, command, ORDER_PREFIX)) {
+        return 0;
     }
 
+    *found = list[i];
+    if (i + 1 < length && !TinyCmd_Cmd_Order(list[i + 1]->command, command, ORDER_PREFIX) &&
+        (TinyCmd_Name_Len(list[i]->command) != TinyCmd_strlen(command) ||
+         TinyCmd_Name_Len(list[i + 1]->command) == TinyCmd_strlen(command))) {
+        return 2;
+    }
+    return 1;
 }
+#endif //CMD_USE_ABBREV
 
-//char* TinyCmd_Arg_Get_Len(TinyCmd_Counter_Type p_arg):
-//Description:Get the length of the argument at position p_arg from the TinyCmd_buf.arg array.
-//args:
-//        p_arg: Position of the argument in the TinyCmd_buf.arg array.
+#if !defined(CMD_USE_SECTION) || defined(CMD_USE_SUB)
+//static const TinyCmd_Command* TinyCmd_Find_In(TinyCmd_Command* const* list, TinyCmd_Counter_Type length, const char* command)
+//Description:Look the command up in a sorted command list.
+//            With CMD_USE_ABBREV a unique prefix of a command name is accepted too, ignoring case.
 //Returns:
-//        Length of the argument string.
-TinyCmd_Counter_Type TinyCmd_Arg_Get_Len(TinyCmd_Counter_Type p_arg)
+//        The command, NULL if it is not found or the prefix is ambiguous.
+static const TinyCmd_Command* TinyCmd_Find_In(TinyCmd_Command* const* list, TinyCmd_Counter_Type length, const char* command)
 {
-    return TinyCmd_strlen(TinyCmd_buf.arg[p_arg]);
+    if (length <= FIND_SCAN_LENGTH) {
+        //Most names differ in their first character, which is cheaper to compare than to order them ignoring case
+        for (TinyCmd_Counter_Type i = 0; i < length; i++) {
+            const char* name = list[i]->command;
+            if (NAME_CHAR(name) == *command && TinyCmd_Name_Equal(name, command)) {
+                return list[i];
+            }
+        }
+    } else {
+        TinyCmd_Counter_Type i = TinyCmd_Cmd_Lower_Bound(list, length, command);
+        if (i < length && TinyCmd_Name_Equal(list[i]->command, command)) {
+            return list[i];
+        }
+    }
+
+#ifdef CMD_USE_ABBREV
+    {
+        const TinyCmd_Command* found = NULL;
+        if (*command != '\0' && TinyCmd_Cmd_Abbrev(list, length, command, &found) == 1) {
+            return found;
+        }
+    }
+#endif //CMD_USE_ABBREV
+
+    return NULL;
 }
+#endif //!CMD_USE_SECTION || CMD_USE_SUB
 
+//static const TinyCmd_Command* TinyCmd_Find_Cmd(const char* command)
+//Description:Look the command up in the commands added by TinyCmd_Add_Cmd() and the registered ones.
+//            With CMD_USE_ABBREV a unique prefix of a command name is accepted too, ignoring case.
+//Returns:
+//        The command, NULL if it is not found or the prefix is ambiguous.
+static const TinyCmd_Command* TinyCmd_Find_Cmd(const char* command)
+{
+    if (command == NULL) {
+        return NULL;
+    }
 
-TinyCmd_Status TinyCmd_Arg_To_Num(TinyCmd_Counter_Type p_arg, void* out_val, TinyCmd_NumType type) {
-    const char* str = TinyCmd_buf.arg[p_arg];
-    if (!str) return TINYCMD_FAILED;
+#ifndef CMD_USE_SECTION
+    return TinyCmd_Find_In(TinyCmdRunning_Cmd.list, TinyCmdRunning_Cmd.length, command);
+#else
+    {
+        TinyCmd_Counter_Type i = TinyCmd_Cmd_Lower_Bound(TinyCmdRunning_Cmd.list, TinyCmdRunning_Cmd.length, command);
+        if (i < TinyCmdRunning_Cmd.length && TinyCmd_Name_Equal(TinyCmdRunning_Cmd.list[i]->command, command)) {
+            return TinyCmdRunning_Cmd.list[i];
+        }
+    }
 
-    int sign = 1;
-    switch (type) {
-        case TINYCMD_UINT8: {
-            unsigned long long result;
-            TinyCmd_Status status = str_to_uint(str, &result, &sign);
-            if (status != TINYCMD_SUCCESS) {
-                return TINYCMD_FAILED;
-            }
-            if (result > UINT8_MAX) {
-                *(unsigned char*)out_val = UINT8_MAX;
-            } else {
-                *(unsigned char*)out_val = (unsigned char)result;
+    if (TinyCmd_section_sorted) {
+        TinyCmd_Counter_Type i = TinyCmd_Cmd_Lower_Bound(TinyCmd_section, TinyCmd_section_length, command);
+        if (i < TinyCmd_section_length && TinyCmd_Name_Equal(TinyCmd_section[i]->command, command)) {
+            return TinyCmd_section[i];
+        }
+    } else {
+        for (const TinyCmd_Command* cmd = TinyCmd_Section_Start; cmd < TinyCmd_Section_Stop; cmd++) {
+            if (TinyCmd_Name_Equal(cmd->command, command)) {
+                return cmd;
             }
-            break;
         }
-        case TINYCMD_INT8: {
-            long long result;
-            TinyCmd_Status status = str_to_int(str, &result, &sign);
-            if (status != TINYCMD_SUCCESS) {
-                return TINYCMD_FAILED;
+    }
+
+#ifdef CMD_USE_ABBREV
+    {
+        const TinyCmd_Command* found = NULL;
+        TinyCmd_Counter_Type matches;
+
+        if (*command == '\0') {
+            return NULL;
+        }
+        matches = TinyCmd_Cmd_Abbrev(TinyCmdRunning_Cmd.list, TinyCmdRunning_Cmd.length, command, &found);
+        if (TinyCmd_section_sorted) {
+            const TinyCmd_Command* reg = NULL;
+            TinyCmd_Counter_Type reg_matches = TinyCmd_Cmd_Abbrev(TinyCmd_section, TinyCmd_section_length, command, &reg);
+            if (reg_matches > 0) {
+                found = reg;
+                matches += reg_matches;
             }
-            if (result > INT8_MAX) {
-                *(signed char*)out_val = INT8_MAX;
-            } else if (result < INT8_MIN) {
-                *(signed char*)out_val = INT8_MIN;
-            } else {
-                *(signed char*)out_val = (signed char)result;
+        } else {
+            for (const TinyCmd_Command* cmd = TinyCmd_Section_Start; cmd < TinyCmd_Section_Stop; cmd++) {
+                if (!TinyCmd_Cmd_Order(cmd->command, command, ORDER_PREFIX)) {
+                    found = cmd;
+                    matches++;
+                }
             }
-            break;
         }
-        case TINYCMD_UINT16: {
-            unsigned long long result;
-            TinyCmd_Status status = str_to_uint(str, &result, &sign);
-            if (status != TINYCMD_SUCCESS) {
-                return TINYCMD_FAILED;
-            }
-            if (result > UINT16_MAX) {
-                *(unsigned short*)out_val = UINT16_MAX;
-            } else {
-                *(unsigned short*)out_val = (unsigned short)result;
+        return (matches == 1) ? found : NULL;
+    }
+#else
+    return NULL;
+#endif //CMD_USE_ABBREV
+#endif //CMD_USE_SECTION
+}
+
+#ifdef CMD_USE_SUB
+//static void TinyCmd_Sort_Sub(TinyCmd_Command* cmd)
+//Description:Sort the subcommands of cmd and of all its subcommands for TinyCmd_Find_In().
+static void TinyCmd_Sort_Sub(TinyCmd_Command* cmd)
+{
+    if (cmd->sub == NULL) {
+        return;
+    }
+
+    //Insertion sort, the tables are short and usually sorted already
+    for (TinyCmd_Counter_Type i = 1; i < cmd->sub_count; i++) {
+        TinyCmd_Command* key = cmd->sub[i];
+        TinyCmd_Counter_Type j = i;
+        while (j > 0 && TinyCmd_Cmd_Order(cmd->sub[j - 1]->command, key->command, ORDER_NAMES) > 0) {
+            cmd->sub[j] = cmd->sub[j - 1];
+            j--;
+        }
+        cmd->sub[j] = key;
+    }
+
+    for (TinyCmd_Counter_Type i = 0; i < cmd->sub_count; i++) {
+        TinyCmd_Sort_Sub(cmd->sub[i]);
+    }
+}
+#endif //CMD_USE_SUB
+
+#ifdef CMD_USE_CACHE
+static TinyCmd_CallBack_Ret cache_call(const TinyCmd_Command* cmd, TinyCmd_Counter_Type argc);
+//Call the callback of a command having argc arguments, it may replay a kept response instead
+#define CMD_CALL(cmd, argc) cache_call((cmd), (argc))
+#else
+#define CMD_CALL(cmd, argc) ((cmd)->callback())
+#endif //CMD_USE_CACHE
+
+//static TinyCmd_Status TinyCmd_Run(char* line, TinyCmd_CallBack_Ret* result)
+//Description:Split line into the command and TinyCmd_buf.arg and run the command, TinyCmd_buf is not cleared.
+//            The return value of the callback is stored in result if it is not NULL.
+static TinyCmd_Status TinyCmd_Run(char* line, TinyCmd_CallBack_Ret* result) {
+    TinyCmd_Counter_Type i = 0;
+    const char* delims = " ";
+    char* context;
+
+    //Read Command
+    char* token = TinyCmd_strtok_s(line, delims, &context);
+    char* command = token;
+
+    //Read arguments
+    token = TinyCmd_strtok_s(NULL, delims ,&context);
+
+    while (token != NULL) {
+        if (i < CMD_MAX_PARAMS) {
+            TinyCmd_buf.arg[i++] = token;
+        }
+        else {
+            // Maximum number of tokens reached, the rest of the line is ignored.
+#ifdef CMD_USE_ALIAS
+            //Except by the alias text, join the rest again
+            if (context != NULL) {
+                context[-1] = ' ';
             }
+            TinyCmd_alias_rest = token;
+#endif //CMD_USE_ALIAS
             break;
         }
-        case TINYCMD_INT16: {
-            long long result;
-            TinyCmd_Status status = str_to_int(str, &result, &sign);
-            if (status != TINYCMD_SUCCESS) {
+        token = TinyCmd_strtok_s(NULL, delims ,&context);
+    }
+
+#ifdef CMD_DEBUG_ECHO
+    TinyCmd_Report_P(TINYCMD_PSTR("Command: %s\n"), command);
+    TinyCmd_Report_P(TINYCMD_PSTR("Number of args: %d\n"), (int)i);
+    for (TinyCmd_Counter_Type j = 0; j < i; j++)
+    {
+        TinyCmd_Report_P(TINYCMD_PSTR("Arg[%d]: %s\n"), (int)j, TinyCmd_buf.arg[j]);
+    }
+#endif //CMD_DEBUG_ECHO
+    TIMING_MARK(TIMING_TOKENIZE);
+
+    //Excute callback function of command
+    const TinyCmd_Command* cmd = TinyCmd_Find_Cmd(command);
+
+#ifdef CMD_USE_SUB
+    //Walk down the subcommands, the leaf gets only the arguments after its own name
+    while (cmd != NULL && cmd->sub_count > 0 && i > 0) {
+        const TinyCmd_Command* sub = TinyCmd_Find_In(cmd->sub, cmd->sub_count, TinyCmd_buf.arg[0]);
+        if (sub == NULL) {
+            break;
+        }
+        for (TinyCmd_Counter_Type j = 1; j < i; j++) {
+            TinyCmd_buf.arg[j - 1] = TinyCmd_buf.arg[j];
+        }
+        TinyCmd_buf.arg[--i] = NULL;
+        cmd = sub;
+    }
+#endif //CMD_USE_SUB
+    TIMING_MARK(TIMING_LOOKUP);
+
+    if (cmd != NULL && cmd->callback != NULL) {
+        TinyCmd_CallBack_Ret ret;
+        {
+            TIMING_PAUSE();
+            ret = CMD_CALL(cmd, i);
+            TIMING_RESUME();
+        }
+        TIMING_MARK(TIMING_CALLBACK);
+        if (result != NULL) {
+            *result = ret;
+        }
+        return TINYCMD_SUCCESS;
+    }
+
+    return TINYCMD_FAILED;
+}
+
+#ifdef CMD_USE_ALIAS
+static TinyCmd_Status alias_handler(void);
+#endif //CMD_USE_ALIAS
+
+//TinyCmd_Status TinyCmd_Init(void):
+//Description:Call this function when TinyCmd_buf is filled ,namely after you call TinyCmd_PutString()
+//Returns:
+//        TINYCMD_SUCCESS: Initialization successful.
+//        TINYCMD_FAILED: Initialization failed.
+TinyCmd_Status TinyCmd_Handler(void) {
+    TinyCmd_Status ret;
+
+    TIMING_START();
+#ifdef CMD_LINE_QUEUE
+    //Bytes received after the line are the next line, a line filling the buffer has no end of line
+    if (TinyCmd_queue.end > 0 && (TinyCmd_buf.input[TinyCmd_queue.end - 1] == '\n' ||
+                                  TinyCmd_buf.input[TinyCmd_queue.end - 1] == '\r')) {
+        TinyCmd_buf.input[TinyCmd_queue.end - 1] = '\0';
+    }
+#endif //CMD_LINE_QUEUE
+    TinyCmd_trim(TinyCmd_buf.input);
+    TIMING_MARK(TIMING_TRIM);
+
+#ifdef CMD_USE_ALIAS
+    ret = alias_handler();
+#else
+    ret = TinyCmd_Run(TinyCmd_buf.input, NULL);
+#endif //CMD_USE_ALIAS
+
+    //Clear TinyCmd_buf
+    TinyCmd_Buf_Clear();
+    TIMING_MARK(TIMING_CLEAR);
+    TIMING_STOP();
+    return ret;
+}
+
+#ifdef CMD_USE_XFER
+static void xfer_put(unsigned char c);
+#endif //CMD_USE_XFER
+#ifdef CMD_USE_LINE_EDIT
+static TinyCmd_Status edit_put(char c);
+#endif //CMD_USE_LINE_EDIT
+#ifdef CMD_LINE_QUEUE
+#ifndef CMD_USE_LINE_EDIT
+static TinyCmd_Status queue_char(char c);
+#endif //CMD_USE_LINE_EDIT
+static TinyCmd_Status queue_put(void);
+#endif //CMD_LINE_QUEUE
+
+//TinyCmd_Status TinyCmd_PutChar(char c):
+//Description:Put a received character into TinyCmd_buf, for instance in the USART receive interrupt.
+//            While a binary transfer is running the character goes to the transfer instead.
+//            With CMD_USE_PRIORITY a complete line naming an urgent command is run here at once.
+//            With CMD_USE_FLOW the sender is stopped here when the lines waiting for the main loop fill the buffer.
+//args:
+//        c: The received character.
+//Returns:
+//        TINYCMD_SUCCESS: A line is complete, call TinyCmd_Handler() to run it.
+//        TINYCMD_FAILED: The line is not complete yet, or it has run already.
+TinyCmd_Status TinyCmd_PutChar(char c)
+{
+    TinyCmd_Status ret;
+
+#ifdef CMD_USE_XFER
+    if (TinyCmd_xfer.mode != XFER_IDLE) {
+        TinyCmd_xfer.stamp = CMD_MILLIS();
+        xfer_put((unsigned char)c);
+        return TINYCMD_FAILED;
+    }
+#endif //CMD_USE_XFER
+
+#if defined(CMD_USE_LINE_EDIT) && defined(CMD_USE_CACHE)
+    //The echo from an interrupt is not part of the response the main loop is keeping
+    TinyCmd_Cache_Slot* capture = TinyCmd_cache.capture;
+    TinyCmd_cache.capture = NULL;
+    ret = edit_put(c);
+    TinyCmd_cache.capture = capture;
+#elif defined(CMD_USE_LINE_EDIT)
+    ret = edit_put(c);
+#elif defined(CMD_LINE_QUEUE)
+    ret = queue_char(c);
+#else
+    if (TinyCmd_buf.length < CMD_BUF_SIZE - 1) {
+        TinyCmd_buf.input[TinyCmd_buf.length++] = c;
+    }
+
+    ret = (c == '\n' || c == '\r') ? TINYCMD_SUCCESS : TINYCMD_FAILED;
+#endif //CMD_USE_LINE_EDIT
+
+#ifdef CMD_LINE_QUEUE
+    if (ret == TINYCMD_SUCCESS) {
+        ret = queue_put();
+    }
+#endif //CMD_LINE_QUEUE
+#if defined(CMD_USE_FLOW) && defined(CMD_USE_LINE_EDIT)
+    //The editor has no room for the next line until TinyCmd_Handler() has run this one
+    if (ret == TINYCMD_SUCCESS) {
+        flow_check(CMD_FLOW_HIGH);
+    }
+#elif defined(CMD_USE_FLOW)
+    flow_check(TinyCmd_queue.end > 0 ? TinyCmd_buf.length : 0);
+#endif //CMD_USE_FLOW
+    return ret;
+}
+
+//TinyCmd_Status TinyCmd_Poll(void):
+//Description:Read the received characters by CMD_READ_CHAR() and run the command when a line is complete.
+//            Call it in the main loop instead of TinyCmd_PutChar() and TinyCmd_Handler() when the port
+//            has a receive buffer (Serial on Arduino...).
+//Returns:
+//        TINYCMD_SUCCESS: A command is found and run.
+//        TINYCMD_FAILED: No complete line yet, or the command is not found.
+TinyCmd_Status TinyCmd_Poll(void)
+{
+    int c;
+
+    while ((c = CMD_READ_CHAR()) >= 0) {
+        if (TinyCmd_PutChar((char)c) == TINYCMD_SUCCESS) {
+            return TinyCmd_Handler();
+        }
+    }
+
+    return TINYCMD_FAILED;
+}
+
+//TinyCmd_Status TinyCmd_Add_Cmd(TinyCmd_Command* newCmd):
+//Description:Add a new command to the TinyCmdRunning_Cmd list, which is kept sorted by name.
+//args:
+//        newCmd: Pointer to the TinyCmd_Command struct containing the command and callback function.
+//Returns:
+//        TINYCMD_SUCCESS: Command added successfully.
+//        TINYCMD_FAILED: Command addition failed, newCmd has neither callback nor subcommands, the command is added already
+//                        or the list is full (CMD_LIST_SIZE).
+TinyCmd_Status TinyCmd_Add_Cmd(TinyCmd_Command* newCmd)
+{
+    if (newCmd == NULL){
+        return TINYCMD_FAILED;
+    }
+    else{
+        if((newCmd->callback != NULL || CMD_HAS_SUB(newCmd)) && newCmd->command != NULL &&
+           TinyCmdRunning_Cmd.length < CMD_LIST_SIZE){
+            //Keep the list sorted for the binary search of TinyCmd_Handler(),
+            //both names may be in flash so they are compared as names
+            TinyCmd_Counter_Type i = 0;
+            int order = 1;
+            while (i < TinyCmdRunning_Cmd.length &&
+                   (order = TinyCmd_Cmd_Order(TinyCmdRunning_Cmd.list[i]->command, newCmd->command, ORDER_NAMES)) < 0) {
+                i++;
+            }
+            if (i < TinyCmdRunning_Cmd.length && order == 0) {
                 return TINYCMD_FAILED;
             }
-            if (result > INT16_MAX) {
-                *(short*)out_val = INT16_MAX;
-            } else if (result < INT16_MIN) {
-                *(short*)out_val = INT16_MIN;
-            } else {
-                *(short*)out_val = (short)result;
+            for (TinyCmd_Counter_Type j = TinyCmdRunning_Cmd.length; j > i; j--) {
+                TinyCmdRunning_Cmd.list[j] = TinyCmdRunning_Cmd.list[j - 1];
             }
-            break;
+            TinyCmdRunning_Cmd.list[i] = newCmd;
+            TinyCmdRunning_Cmd.length++;
+#ifdef CMD_USE_SUB
+            TinyCmd_Sort_Sub(newCmd);
+#endif //CMD_USE_SUB
+            return TINYCMD_SUCCESS;
+        }
+        else{
+            return TINYCMD_FAILED;
+        }
+    }
+}
+
+#ifdef CMD_USE_SECTION
+//TinyCmd_Status TinyCmd_Section_Init(void):
+//Description:Sort an index of the commands registered by TINYCMD_REGISTER, so they are found by a binary
+//            search as the added ones. Call it once at start-up, before the receive interrupt is enabled:
+//            the commands are scanned until then.
+//Returns:
+//        TINYCMD_SUCCESS: The index is sorted, it may be empty.
+//        TINYCMD_FAILED: More than CMD_SECTION_SIZE commands are registered, they are still scanned.
+TinyCmd_Status TinyCmd_Section_Init(void)
+{
+    TinyCmd_section_sorted = 0;
+    TinyCmd_section_length = 0;
+
+    //Insertion sort, it runs once
+    for (const TinyCmd_Command* cmd = TinyCmd_Section_Start; cmd < TinyCmd_Section_Stop; cmd++) {
+        TinyCmd_Counter_Type j = TinyCmd_section_length;
+        if (j >= CMD_SECTION_SIZE) {
+            TinyCmd_section_length = 0;
+            return TINYCMD_FAILED;
+        }
+        while (j > 0 && TinyCmd_Cmd_Order(TinyCmd_section[j - 1]->command, cmd->command, ORDER_NAMES) > 0) {
+            TinyCmd_section[j] = TinyCmd_section[j - 1];
+            j--;
+        }
+        //The lists hold non-const pointers, the registered commands are only read through them
+        TinyCmd_section[j] = (TinyCmd_Command*)cmd;
+        TinyCmd_section_length++;
+#ifdef CMD_USE_SUB
+        //Only the subcommand tables are written, they are in RAM
+        TinyCmd_Sort_Sub((TinyCmd_Command*)cmd);
+#endif //CMD_USE_SUB
+    }
+    TinyCmd_section_sorted = 1;
+
+    return TINYCMD_SUCCESS;
+}
+#endif //CMD_USE_SECTION
+
+
+//TinyCmd_Status TinyCmd_Arg_Check(char* arg1,TinyCmd_Counter_Type p_arg):
+//Description:Check if the argument at position p_arg2 matches the given argument arg1.
+//args:
+//        arg1: Pointer to the argument string to compare.
+//        p_arg2: Position of the argument in the TinyCmd_buf.arg array.
+//Returns:
+//        TINYCMD_SUCCESS: Argument matches.
+//        TINYCMD_FAILED: Argument does not match.
+TinyCmd_Status TinyCmd_Arg_Check(const char* arg1,TinyCmd_Counter_Type p_arg2)
+{
+    if (p_arg2 >= CMD_MAX_PARAMS || TinyCmd_buf.arg[p_arg2] == NULL) {
+        return TINYCMD_FAILED;
+    }
+    if(!TinyCmd_strcmp(arg1,TinyCmd_buf.arg[p_arg2]))
+    {
+        return TINYCMD_SUCCESS;
+    }
+    else{
+        return TINYCMD_FAILED;
+    }
+
+}
+
+//static unsigned char TinyCmd_Keyword_Slot(const char* str, TinyCmd_Counter_Type length)
+//Description:First slot of a keyword, from its length and its first and last characters, which finding the length
+//            has just read. The characters are taken | 0x20, so both cases of a letter give the same slot.
+static unsigned char TinyCmd_Keyword_Slot(const char* str, TinyCmd_Counter_Type length)
+{
+    unsigned char last = (unsigned char)(str[length > 0 ? length - 1 : 0] | 0x20);
+
+    return (unsigned char)(((unsigned char)(str[0] | 0x20) + last + 3u * length) & (CMD_KEYWORD_SLOTS - 1));
+}
+
+//static TinyCmd_Status TinyCmd_Keyword_Equal(const char* str1, const char* str2, unsigned char nocase)
+static TinyCmd_Status TinyCmd_Keyword_Equal(const char* str1, const char* str2, unsigned char nocase)
+{
+    //Keywords are mostly typed as they are listed, the same character needs no folding
+    while (*str1 != '\0' && (*str1 == *str2 || (nocase && TinyCmd_tolower(*str1) == TinyCmd_tolower(*str2)))) {
+        str1++;
+        str2++;
+    }
+    return (*str1 == '\0' && *str2 == '\0');
+}
+
+//TinyCmd_Status TinyCmd_Keywords_Init(TinyCmd_Keywords* keywords):
+//Description:Build the slots of a keyword table. Call it once at start-up for each table TinyCmd_Arg_Keyword()
+//            matches, before the receive interrupt is enabled. Calling it again builds the same slots.
+//args:
+//        keywords: Keyword table declared by TINYCMD_KEYWORDS().
+//Returns:
+//        TINYCMD_SUCCESS: The slots are built.
+//        TINYCMD_FAILED: keywords is NULL, or it has more keywords than 3/4 of CMD_KEYWORD_SLOTS and is compared
+//                        one by one.
+TinyCmd_Status TinyCmd_Keywords_Init(TinyCmd_Keywords* keywords)
+{
+    if (keywords == NULL) {
+        return TINYCMD_FAILED;
+    }
+
+    keywords->built = 0;
+    for (unsigned int h = 0; h < CMD_KEYWORD_SLOTS; h++) {
+        keywords->slot[h] = 0;
+    }
+    if (keywords->count > CMD_KEYWORD_SLOTS * 3 / 4) {
+        return TINYCMD_FAILED;
+    }
+
+    for (TinyCmd_Counter_Type i = 0; i < keywords->count; i++) {
+        const char* word = keywords->words[i];
+        unsigned char h = TinyCmd_Keyword_Slot(word, TinyCmd_strlen(word));
+        while (keywords->slot[h] != 0) {
+            h = (h + 1) & (CMD_KEYWORD_SLOTS - 1);
+        }
+        keywords->slot[h] = (unsigned char)(i + 1);
+    }
+    keywords->built = 1;
+
+    return TINYCMD_SUCCESS;
+}
+
+//int TinyCmd_Arg_Keyword(const TinyCmd_Keywords* keywords, TinyCmd_Counter_Type p_arg):
+//Description:Match the argument at position p_arg against a keyword table, so a callback can switch on the index
+//            instead of chaining TinyCmd_Arg_Check() calls. A table built by TinyCmd_Keywords_Init() is probed at the
+//            slot of the length and the first and last characters of the argument, usually one compare. The keywords of a
+//            table not built are compared one by one. The table is only read.
+//args:
+//        keywords: Keyword table declared by TINYCMD_KEYWORDS().
+//        p_arg: Position of the argument in the TinyCmd_buf.arg array.
+//Returns:
+//        Index of the keyword in keywords->words, -1 if the argument is missing or no keyword matches.
+int TinyCmd_Arg_Keyword(const TinyCmd_Keywords* keywords, TinyCmd_Counter_Type p_arg)
+{
+    const char* arg;
+
+    if (keywords == NULL || p_arg >= CMD_MAX_PARAMS || TinyCmd_buf.arg[p_arg] == NULL) {
+        return -1;
+    }
+    arg = TinyCmd_buf.arg[p_arg];
+
+    if (!keywords->built) {
+        for (TinyCmd_Counter_Type i = 0; i < keywords->count; i++) {
+            if (TinyCmd_Keyword_Equal(arg, keywords->words[i], keywords->nocase)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    //Linear probing, the table is at most 3/4 full so an empty slot ends the search
+    for (unsigned char h = TinyCmd_Keyword_Slot(arg, TinyCmd_strlen(arg)); keywords->slot[h] != 0;
+         h = (h + 1) & (CMD_KEYWORD_SLOTS - 1)) {
+        TinyCmd_Counter_Type i = keywords->slot[h] - 1;
+        if (TinyCmd_Keyword_Equal(arg, keywords->words[i], keywords->nocase)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+//char* TinyCmd_Arg_Get_Len(TinyCmd_Counter_Type p_arg):
+//Description:Get the length of the argument at position p_arg from the TinyCmd_buf.arg array.
+//args:
+//        p_arg: Position of the argument in the TinyCmd_buf.arg array.
+//Returns:
+//        Length of the argument string, 0 if there is no argument at p_arg.
+TinyCmd_Counter_Type TinyCmd_Arg_Get_Len(TinyCmd_Counter_Type p_arg)
+{
+    if (p_arg >= CMD_MAX_PARAMS || TinyCmd_buf.arg[p_arg] == NULL) {
+        return 0;
+    }
+    return TinyCmd_strlen(TinyCmd_buf.arg[p_arg]);
+}
+
+
+#ifdef CMD_USE_SCRIPT
+//static unsigned long long compiled_u64(const unsigned char* p, unsigned char n)
+//Description:Read n bytes little endian from a compiled script.
+static unsigned long long compiled_u64(const unsigned char* p, unsigned char n)
+{
+    unsigned long long v = 0;
+
+    for (; n > 0; n--) {
+        v = (v << 8) | p[n - 1];
+    }
+    return v;
+}
+#endif //CMD_USE_SCRIPT
+
+//static TinyCmd_Status arg_to_uint(TinyCmd_Counter_Type p_arg, unsigned long long* result, int* sign)
+//Description:str_to_uint() of an argument. In a compiled script it is parsed already and only read.
+static TinyCmd_Status arg_to_uint(TinyCmd_Counter_Type p_arg, unsigned long long* result, int* sign)
+{
+#ifdef CMD_USE_SCRIPT
+    const unsigned char* num = TinyCmd_compiled_num[p_arg];
+    if (num != NULL) {
+        if (!(num[0] & COMPILED_UINT)) {
+            return TINYCMD_FAILED;
+        }
+        *sign = (num[0] & COMPILED_NEGATIVE) ? -1 : 1;
+        *result = compiled_u64(COMPILED_NUM(num), COMPILED_BYTES(num[0]));
+        return TINYCMD_SUCCESS;
+    }
+#endif //CMD_USE_SCRIPT
+    return str_to_uint(TinyCmd_buf.arg[p_arg], result, sign);
+}
+
+static TinyCmd_Status arg_to_int(TinyCmd_Counter_Type p_arg, long long* result, int* sign) {
+    unsigned long long unsigned_result;
+    TinyCmd_Status status = arg_to_uint(p_arg, &unsigned_result, sign);
+    if (status != TINYCMD_SUCCESS) {
+        return TINYCMD_FAILED;
+    }
+
+    //Out of the range of long long, -9223372036854775808 is the only value without a positive counterpart
+    if (*sign == -1) {
+        if (unsigned_result > (unsigned long long)LLONG_MAX + 1) {
+            return TINYCMD_FAILED;
+        }
+        *result = unsigned_result ? -(long long)(unsigned_result - 1) - 1 : 0;
+    } else {
+        if (unsigned_result > (unsigned long long)LLONG_MAX) {
+            return TINYCMD_FAILED;
+        }
+        *result = (long long)unsigned_result;
+    }
+
+    return TINYCMD_SUCCESS;
+}
+
+//static TinyCmd_Status arg_to_float(TinyCmd_Counter_Type p_arg, double* result)
+//Description:str_to_float() of an argument. In a compiled script it is parsed already and only read.
+static TinyCmd_Status arg_to_float(TinyCmd_Counter_Type p_arg, double* result)
+{
+#ifdef CMD_USE_SCRIPT
+    const unsigned char* num = TinyCmd_compiled_num[p_arg];
+    if (num != NULL) {
+        union { unsigned long long bits; double value; } f;
+        const unsigned char* p = COMPILED_NUM(num);
+        if (num[0] & COMPILED_DOUBLE) {
+            f.bits = compiled_u64(p + COMPILED_BYTES(num[0]), 8);
+            *result = f.value;
+        } else if (num[0] & COMPILED_FLOAT) {
+            *result = (double)compiled_u64(p, COMPILED_BYTES(num[0])) * ((num[0] & COMPILED_NEGATIVE) ? -1.0 : 1.0);
+        } else {
+            return TINYCMD_FAILED;
+        }
+        return TINYCMD_SUCCESS;
+    }
+#endif //CMD_USE_SCRIPT
+    return str_to_float(TinyCmd_buf.arg[p_arg], result);
+}
+
+TinyCmd_Status TinyCmd_Arg_To_Num(TinyCmd_Counter_Type p_arg, void* out_val, TinyCmd_NumType type) {
+    if (p_arg >= CMD_MAX_PARAMS) return TINYCMD_FAILED;
+    const char* str = TinyCmd_buf.arg[p_arg];
+    if (!str) return TINYCMD_FAILED;
+
+    int sign = 1;
+    switch (type) {
+        case TINYCMD_UINT8: {
+            unsigned long long result;
+            TinyCmd_Status status = arg_to_uint(p_arg, &result, &sign);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+            if (result > UINT8_MAX) {
+                *(unsigned char*)out_val = UINT8_MAX;
+            } else {
+                *(unsigned char*)out_val = (unsigned char)result;
+            }
+            break;
+        }
+        case TINYCMD_INT8: {
+            long long result;
+            TinyCmd_Status status = arg_to_int(p_arg, &result, &sign);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+            if (result > INT8_MAX) {
+                *(signed char*)out_val = INT8_MAX;
+            } else if (result < INT8_MIN) {
+                *(signed char*)out_val = INT8_MIN;
+            } else {
+                *(signed char*)out_val = (signed char)result;
+            }
+            break;
+        }
+        case TINYCMD_UINT16: {
+            unsigned long long result;
+            TinyCmd_Status status = arg_to_uint(p_arg, &result, &sign);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+            if (result > UINT16_MAX) {
+                *(unsigned short*)out_val = UINT16_MAX;
+            } else {
+                *(unsigned short*)out_val = (unsigned short)result;
+            }
+            break;
+        }
+        case TINYCMD_INT16: {
+            long long result;
+            TinyCmd_Status status = arg_to_int(p_arg, &result, &sign);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+            if (result > INT16_MAX) {
+                *(short*)out_val = INT16_MAX;
+            } else if (result < INT16_MIN) {
+                *(short*)out_val = INT16_MIN;
+            } else {
+                *(short*)out_val = (short)result;
+            }
+            break;
+        }
+        case TINYCMD_UINT32: {
+            unsigned long long result;
+            TinyCmd_Status status = arg_to_uint(p_arg, &result, &sign);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+            #if CMD_NAME_LENGTH > 9
+            if (result > UINT32_MAX) {
+                *(unsigned int*)out_val = UINT32_MAX;
+            } else {
+                *(unsigned int*)out_val = (unsigned int)result;
+            }
+            #else
+            *(unsigned int*)out_val = (unsigned int)result;
+            #endif
+            break;
+        }
+        case TINYCMD_INT32: {
+            long long result;
+            TinyCmd_Status status = arg_to_int(p_arg, &result, &sign);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+            if (result > INT32_MAX) {
+                *(int*)out_val = INT32_MAX;
+            } else if (result < INT32_MIN) {
+                *(int*)out_val = INT32_MIN;
+            } else {
+                *(int*)out_val = (int)result;
+            }
+            break;
+        }
+        //when CMD_NAME_LENGTH > 9 a more bigger type is needed
+        #if CMD_NAME_LENGTH > 9
+        case TINYCMD_UINT64: {
+            unsigned long long result;
+            TinyCmd_Status status = arg_to_uint(p_arg, &result, &sign);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+            *(unsigned long long*)out_val = (unsigned long long)result;
+            break;
+        }
+        case TINYCMD_INT64: {
+            long long result;
+            TinyCmd_Status status = arg_to_int(p_arg, &result, &sign);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+            *(long long*)out_val = (long long)result;
+            break;
+        }
+        #endif //CMD_NAME_LENGTH > 9
+        case TINYCMD_FLOAT: {
+            double result;
+            TinyCmd_Status status = arg_to_float(p_arg, &result);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+                *(float*)out_val = (float)result;
+            break;
+        }
+        case TINYCMD_DOUBLE: {
+            double result;
+            TinyCmd_Status status = arg_to_float(p_arg, &result);
+            if (status != TINYCMD_SUCCESS) {
+                return TINYCMD_FAILED;
+            }
+                *(double*)out_val = result;
+            break;
+        }
+        default:
+            return TINYCMD_FAILED;
+    }
+
+    if (str[0] == '\0' || (str[0] == '-' && str[1] == '\0')) {
+        return TINYCMD_FAILED;
+    }
+
+    return TINYCMD_SUCCESS;
+}
+
+//static const char* fmt_parse(const char* format, TinyCmd_Fmt_Op* op)
+//Description:Parse the conversion after '%' into op: flags ('-', '0'), width, ".precision",
+//            length ("l", "ll") and conversion character.
+//            "%.N" followed by any other character is "%.Nf", like TinyCmd_Report always did.
+//Returns:
+//        The character after the conversion, NULL if it is not a conversion.
+static const char* fmt_parse(const char* format, TinyCmd_Fmt_Op* op)
+{
+    TinyCmd_Counter_Type has_precision = 0;
+    unsigned int value;
+
+    op->literal = NULL;
+    op->len = 0;
+    op->conv = 0;
+    op->flags = 0;
+    op->width = 0;
+    op->precision = 6;
+    op->length = 0;
+
+    for (;; format++) {
+        if (*format == '-') {
+            op->flags |= TINYCMD_FMT_LEFT;
+        } else if (*format == '0') {
+            op->flags |= TINYCMD_FMT_ZERO;
+        } else {
+            break;
+        }
+    }
+
+    for (value = 0; TinyCmd_isdigit(*format); format++) {
+        value = value * 10 + (*format - '0');
+        op->width = value > 255 ? 255 : value;
+    }
+
+    if (*format == '.') {
+        has_precision = 1;
+        format++;
+        for (value = 0; TinyCmd_isdigit(*format); format++) {
+            value = value * 10 + (*format - '0');
+        }
+        op->precision = value > CMD_FMT_MAX_PRECISION ? CMD_FMT_MAX_PRECISION : value;
+    }
+
+    while (*format == 'l' && op->length < 2) {
+        op->length++;
+        format++;
+    }
+
+    switch (*format) {
+        case 'i':
+            op->conv = 'd';
+            return format + 1;
+        case 'd':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+        case 's':
+        case 'f':
+        case '%':
+            op->conv = *format;
+            return format + 1;
+        default:
+            if (has_precision && op->length == 0) {
+                op->conv = 'f';
+                return *format ? format + 1 : format;
+            }
+            return NULL;
+    }
+}
+
+//static void report_pad(char c, TinyCmd_Counter_Type n)
+//Description:Send n times the character c.
+static void report_pad(char c, TinyCmd_Counter_Type n)
+{
+    char pad[8];
+
+    for (TinyCmd_Counter_Type i = 0; i < sizeof(pad); i++) {
+        pad[i] = c;
+    }
+    while (n > sizeof(pad)) {
+        send_bytes(pad, sizeof(pad));
+        n -= sizeof(pad);
+    }
+    send_bytes(pad, n);
+}
+
+//static void report_field(const TinyCmd_Fmt_Op* op, const char* body, TinyCmd_Counter_Type len, TinyCmd_Counter_Type sign)
+//Description:Send a converted field padded to the width of op.
+//            Zero padding goes between the sign (the first sign characters of body) and the digits.
+static void report_field(const TinyCmd_Fmt_Op* op, const char* body, TinyCmd_Counter_Type len, TinyCmd_Counter_Type sign)
+{
+    TinyCmd_Counter_Type pad = (op->width > len) ? op->width - len : 0;
+
+    if (pad == 0) {
+        send_bytes(body, len);
+    } else if (op->flags & TINYCMD_FMT_LEFT) {
+        send_bytes(body, len);
+        report_pad(' ', pad);
+    } else if ((op->flags & TINYCMD_FMT_ZERO) && op->conv != 's' && op->conv != 'c') {
+        send_bytes(body, sign);
+        report_pad('0', pad);
+        send_bytes(body + sign, len - sign);
+    } else {
+        report_pad(' ', pad);
+        send_bytes(body, len);
+    }
+}
+
+//static void report_conv(const TinyCmd_Fmt_Op* op, va_list* args)
+//Description:Format one argument of TinyCmd_Report and send it.
+//            Integers are written backwards into num_buffer and sent from there, no reverse and no copy.
+static void report_conv(const TinyCmd_Fmt_Op* op, va_list* args)
+{
+    SCRATCH_BUFFER(num_buffer, REPORT_NUM_SIZE);
+    char* end = num_buffer + REPORT_NUM_SIZE;
+    char* p = end;
+    TinyCmd_Counter_Type sign = 0;
+
+    switch (op->conv) {
+        case 'd': {
+            long long value;
+            if (op->length == 2) {
+                value = va_arg(*args, long long);
+            } else if (op->length == 1) {
+                value = va_arg(*args, long);
+            } else {
+                value = va_arg(*args, int);
+            }
+            p = utoa_rev(end, value < 0 ? -(unsigned long long)value : (unsigned long long)value, 10, 0);
+            if (value < 0) {
+                *--p = '-';
+                sign = 1;
+            }
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o': {
+            unsigned long long value;
+            if (op->length == 2) {
+                value = va_arg(*args, unsigned long long);
+            } else if (op->length == 1) {
+                value = va_arg(*args, unsigned long);
+            } else {
+                value = va_arg(*args, unsigned int);
+            }
+            p = utoa_rev(end, value, op->conv == 'u' ? 10 : (op->conv == 'o' ? 8 : 16), op->conv == 'X');
+            break;
+        }
+        case 'c':
+            *--p = (char)va_arg(*args, int);
+            break;
+        case '%':
+            *--p = '%';
+            break;
+        case 'f': {
+            double value = va_arg(*args, double);
+            dtoa(value, num_buffer, op->precision);
+            p = num_buffer;
+            end = p + TinyCmd_strlen(p);
+            sign = (*p == '-');
+            break;
+        }
+        case 's': {
+            const char* str = va_arg(*args, const char*);
+            TinyCmd_Counter_Type len = 0;
+            if (str == NULL) {
+                str = "(null)";
+            }
+            //Only count up to the width, longer strings need no padding
+            while (len < op->width && str[len] != '\0') {
+                len++;
+            }
+            if (len < op->width) {
+                report_field(op, str, len, 0);
+            } else {
+                send_string(str);
+            }
+            return;
+        }
+        default:
+            return;
+    }
+
+    report_field(op, p, end - p, sign);
+}
+
+#ifdef CMD_USE_PROGMEM
+//Reads of a format string in flash go through small RAM copies
+#define FMT_SPEC_SIZE  16
+#define FMT_CHUNK_SIZE 16
+#define FMT_CHAR(format, flash) ((flash) ? NAME_CHAR(format) : *(format))
+#else
+#define FMT_CHAR(format, flash) (*(format))
+#endif
+
+//static void report_format(const char* format, TinyCmd_Status flash, va_list* args)
+//Description:Send a format string of TinyCmd_Report or TinyCmd_Report_P, flash is TINYCMD_SUCCESS if it is in flash.
+static void report_format(const char* format, TinyCmd_Status flash, va_list* args)
+{
+    (void)flash;
+
+    while (FMT_CHAR(format, flash)) {
+        if (FMT_CHAR(format, flash) == '%') {
+            TinyCmd_Fmt_Op op;
+            const char* next;
+#ifdef CMD_USE_PROGMEM
+            if (flash) {
+                //fmt_parse reads RAM: copy the conversion, it is never longer than "-0255.16ll" and its character
+                char spec[FMT_SPEC_SIZE];
+                TinyCmd_Counter_Type i = 0;
+                while (i < FMT_SPEC_SIZE - 1 && (spec[i] = NAME_CHAR(format + 1 + i)) != '\0') {
+                    i++;
+                }
+                spec[i] = '\0';
+                next = fmt_parse(spec, &op);
+                if (next != NULL) {
+                    next = format + 1 + (next - spec);
+                }
+            } else
+#endif
+            {
+                next = fmt_parse(format + 1, &op);
+            }
+            if (next != NULL) {
+                report_conv(&op, args);
+                format = next;
+                continue;
+            }
+            //Not a conversion, send it as it is
+            send_char(FMT_CHAR(format, flash));
+            format++;
+            if (FMT_CHAR(format, flash)) {
+                send_char(FMT_CHAR(format, flash));
+                format++;
+            }
+        } else {
+#ifdef CMD_USE_PROGMEM
+            if (flash) {
+                //Send the literal run in chunks copied to RAM
+                char chunk[FMT_CHUNK_SIZE];
+                TinyCmd_Counter_Type len = 0;
+                char c;
+                while ((c = NAME_CHAR(format)) != '\0' && c != '%') {
+                    chunk[len++] = c;
+                    format++;
+                    if (len == FMT_CHUNK_SIZE) {
+                        send_bytes(chunk, len);
+                        len = 0;
+                    }
+                }
+                send_bytes(chunk, len);
+                continue;
+            }
+#endif
+            //Send the literal run as one block
+            const char* start = format;
+            TinyCmd_Counter_Type len = 0;
+            while (*format && *format != '%' && len < 255) {
+                format++;
+                len++;
+            }
+            send_bytes(start, len);
+        }
+    }
+}
+
+//TinyCmd_Status TinyCmd_Report(const char* format,...)
+//Description:A printf-like function print the formatted string to somewhere user designated.
+//            Conversions: %d %i %u %x %X %o %c %s %f %%, with the flags '-' (left align) and '0'
+//            (zero padding), a width, a ".precision" for %f and the length modifiers l and ll.
+TinyCmd_Status TinyCmd_Report(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    report_format(format, TINYCMD_FAILED, &args);
+
+    va_end(args);
+
+    return TINYCMD_SUCCESS;
+}
+
+#ifdef CMD_USE_PROGMEM
+//TinyCmd_Status TinyCmd_Report_P(const char* format,...)
+//Description:TinyCmd_Report with the format string in flash, e.g. TinyCmd_Report_P(TINYCMD_PSTR("%d\n"), n).
+//            %s arguments are still strings in RAM.
+TinyCmd_Status TinyCmd_Report_P(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    report_format(format, TINYCMD_SUCCESS, &args);
+
+    va_end(args);
+
+    return TINYCMD_SUCCESS;
+}
+#endif
+
+//TinyCmd_Status TinyCmd_Fmt_Compile(TinyCmd_Fmt* fmt, const char* format)
+//Description:Compile a format string of TinyCmd_Report into a list of literal runs and conversions,
+//            so it is not parsed again by every TinyCmd_Report_Fmt call.
+//args:
+//        fmt: Pointer to the TinyCmd_Fmt to fill.
+//        format: Format string, it must stay valid as long as fmt is used.
+//Returns:
+//        TINYCMD_SUCCESS: Compile successful.
+//        TINYCMD_FAILED: More than CMD_FMT_MAX_OPS ops are needed.
+TinyCmd_Status TinyCmd_Fmt_Compile(TinyCmd_Fmt* fmt, const char* format)
+{
+    if (fmt == NULL || format == NULL) {
+        return TINYCMD_FAILED;
+    }
+
+    fmt->count = 0;
+    while (*format) {
+        TinyCmd_Fmt_Op* op;
+        const char* next;
+
+        if (fmt->count >= CMD_FMT_MAX_OPS) {
+            return TINYCMD_FAILED;
+        }
+        op = &fmt->op[fmt->count++];
+
+        if (*format == '%' && (next = fmt_parse(format + 1, op)) != NULL) {
+            format = next;
+        } else {
+            //Unknown "%x" pairs are sent as they are, like TinyCmd_Report does
+            op->literal = format;
+            op->len = 0;
+            op->conv = 0;
+            while (*format && op->len < 254) {
+                if (*format == '%') {
+                    TinyCmd_Fmt_Op conv;
+                    if (op->len && fmt_parse(format + 1, &conv) != NULL) {
+                        break;
+                    }
+                    if (format[1]) {
+                        format++;
+                        op->len++;
+                    }
+                }
+                format++;
+                op->len++;
+            }
+        }
+    }
+
+    return TINYCMD_SUCCESS;
+}
+
+//TinyCmd_Status TinyCmd_Report_Fmt(const TinyCmd_Fmt* fmt,...)
+//Description:TinyCmd_Report with a format string compiled by TinyCmd_Fmt_Compile().
+//            Literal runs are sent as one block.
+TinyCmd_Status TinyCmd_Report_Fmt(const TinyCmd_Fmt* fmt, ...)
+{
+    va_list args;
+
+    if (fmt == NULL) {
+        return TINYCMD_FAILED;
+    }
+
+    va_start(args, fmt);
+
+    for (TinyCmd_Counter_Type i = 0; i < fmt->count; i++) {
+        const TinyCmd_Fmt_Op* op = &fmt->op[i];
+        if (op->conv) {
+            report_conv(op, &args);
+        } else {
+            send_bytes(op->literal, op->len);
+        }
+    }
+
+    va_end(args);
+
+    return TINYCMD_SUCCESS;
+}
+
+#ifdef CMD_USE_LINE_EDIT
+//Line editor****************************************************************//
+
+//Key of each control character, ESC starts an escape sequence
+static const unsigned char TinyCmd_edit_ctrl[32] = {
+    [0x01] = KEY_HOME,      //Ctrl-A
+    [0x02] = KEY_LEFT,      //Ctrl-B
+    [0x04] = KEY_DELETE,    //Ctrl-D
+    [0x05] = KEY_END,       //Ctrl-E
+    [0x06] = KEY_RIGHT,     //Ctrl-F
+    [0x08] = KEY_BACKSPACE, //Ctrl-H
+    [0x09] = KEY_TAB,
+    [0x0A] = KEY_ENTER,
+    [0x0D] = KEY_ENTER,
+    [0x0E] = KEY_DOWN,      //Ctrl-N
+    [0x10] = KEY_UP,        //Ctrl-P
+    [0x1B] = KEY_ESC,
+};
+
+//Key of each final character 'A'..'Z' of "ESC [ x" and "ESC O x"
+static const unsigned char TinyCmd_edit_csi[26] = {
+    ['A' - 'A'] = KEY_UP,
+    ['B' - 'A'] = KEY_DOWN,
+    ['C' - 'A'] = KEY_RIGHT,
+    ['D' - 'A'] = KEY_LEFT,
+    ['F' - 'A'] = KEY_END,
+    ['H' - 'A'] = KEY_HOME,
+};
+
+//Key of each number of "ESC [ n ~"
+static const unsigned char TinyCmd_edit_tilde[10] = {
+    [1] = KEY_HOME,
+    [3] = KEY_DELETE,
+    [4] = KEY_END,
+    [7] = KEY_HOME,
+    [8] = KEY_END,
+};
+
+//static unsigned char edit_decode(unsigned char c)
+//Description:Decode one received character into a key by one table lookup, whatever the state.
+static unsigned char edit_decode(unsigned char c)
+{
+    TinyCmd_Edit* e = &TinyCmd_edit;
+
+    switch (e->state) {
+        case EDIT_ESC:
+            e->state = (c == '[' || c == 'O') ? EDIT_CSI : EDIT_PLAIN;
+            return KEY_NONE;
+        case EDIT_CSI:
+            if (c >= '0' && c <= '9') {
+                e->param = c - '0';
+                e->state = EDIT_PARAM;
+                return KEY_NONE;
+            }
+            e->state = EDIT_PLAIN;
+            return (c >= 'A' && c <= 'Z') ? TinyCmd_edit_csi[c - 'A'] : KEY_NONE;
+        case EDIT_PARAM:
+            if (c >= '0' && c <= '9') {
+                //Two digit numbers are not editing keys
+                e->param = 0;
+                return KEY_NONE;
+            }
+            e->state = EDIT_PLAIN;
+            return (c == '~') ? TinyCmd_edit_tilde[e->param] : KEY_NONE;
+        default:
+            if (c < 32) {
+                return TinyCmd_edit_ctrl[c];
+            }
+            return (c == 0x7F) ? KEY_BACKSPACE : KEY_INSERT;
+    }
+}
+
+//static void edit_back(TinyCmd_Counter_Type n)
+//Description:Move the terminal cursor n characters to the left.
+static void edit_back(TinyCmd_Counter_Type n)
+{
+    while (n--) {
+        CMD_SEND_CHAR('\b');
+    }
+}
+
+//static void edit_show(const char* line, TinyCmd_Counter_Type len)
+//Description:Replace the whole line by len characters of line, the cursor goes to the end.
+static void edit_show(const char* line, TinyCmd_Counter_Type len)
+{
+    TinyCmd_Counter_Type old = TinyCmd_buf.length;
+
+    edit_back(TinyCmd_edit.cursor);
+    for (TinyCmd_Counter_Type i = 0; i < len; i++) {
+        TinyCmd_buf.input[i] = line[i];
+    }
+    for (TinyCmd_Counter_Type i = len; i < old; i++) {
+        TinyCmd_buf.input[i] = '\0';
+    }
+    TinyCmd_buf.input[len] = '\0';
+    TinyCmd_buf.length = len;
+    TinyCmd_edit.cursor = len;
+
+    send_bytes(TinyCmd_buf.input, len);
+    //Blank out the rest of a longer old line
+    if (old > len) {
+        for (TinyCmd_Counter_Type i = len; i < old; i++) {
+            CMD_SEND_CHAR(' ');
+        }
+        edit_back(old - len);
+    }
+}
+
+//static void edit_delete(void)
+//Description:Delete the character under the cursor and redraw the rest of the line.
+static void edit_delete(void)
+{
+    char* input = TinyCmd_buf.input;
+    TinyCmd_Counter_Type cursor = TinyCmd_edit.cursor;
+    TinyCmd_Counter_Type tail;
+
+    if (cursor >= TinyCmd_buf.length) {
+        return;
+    }
+    tail = TinyCmd_buf.length - cursor - 1;
+    for (TinyCmd_Counter_Type i = cursor; i < TinyCmd_buf.length; i++) {
+        input[i] = input[i + 1];
+    }
+    TinyCmd_buf.length--;
+
+    send_bytes(input + cursor, tail);
+    CMD_SEND_CHAR(' ');
+    edit_back(tail + 1);
+}
+
+//static void edit_insert(char c)
+//Description:Insert c at the cursor. Typing at the end of the line only echoes c.
+static void edit_insert(char c)
+{
+    char* input = TinyCmd_buf.input;
+    TinyCmd_Counter_Type cursor = TinyCmd_edit.cursor;
+    TinyCmd_Counter_Type tail = TinyCmd_buf.length - cursor;
+
+    if (TinyCmd_buf.length >= CMD_BUF_SIZE - 1) {
+        return;
+    }
+    for (TinyCmd_Counter_Type i = TinyCmd_buf.length; i > cursor; i--) {
+        input[i] = input[i - 1];
+    }
+    input[cursor] = c;
+    TinyCmd_buf.length++;
+    TinyCmd_edit.cursor++;
+
+    send_bytes(input + cursor, tail + 1);
+    edit_back(tail);
+}
+
+//static void edit_history_add(void)
+//Description:Append the line to the history. The same line stored before is removed first,
+//            then the oldest lines are dropped until it fits.
+static void edit_history_add(void)
+{
+    TinyCmd_Edit* e = &TinyCmd_edit;
+    TinyCmd_Counter_Type len = TinyCmd_buf.length;
+    TinyCmd_Counter_Type start = 0;
+    TinyCmd_Counter_Type drop;
+
+    if (len == 0 || len + 1 > CMD_EDIT_HISTORY_SIZE) {
+        return;
+    }
+
+    while (start < e->used) {
+        TinyCmd_Counter_Type end = start + TinyCmd_strlen(e->history + start) + 1;
+        if (end - start == len + 1 && !TinyCmd_strcmp(e->history + start, TinyCmd_buf.input)) {
+            for (TinyCmd_Counter_Type i = end; i < e->used; i++) {
+                e->history[i - (len + 1)] = e->history[i];
+            }
+            e->used -= len + 1;
+            break;
+        }
+        start = end;
+    }
+
+    drop = 0;
+    while (e->used - drop + len + 1 > CMD_EDIT_HISTORY_SIZE) {
+        drop += TinyCmd_strlen(e->history + drop) + 1;
+    }
+    for (TinyCmd_Counter_Type i = drop; i < e->used; i++) {
+        e->history[i - drop] = e->history[i];
+    }
+    e->used -= drop;
+
+    for (TinyCmd_Counter_Type i = 0; i <= len; i++) {
+        e->history[e->used++] = TinyCmd_buf.input[i];
+    }
+}
+
+//static void edit_history_move(TinyCmd_Status up)
+//Description:Show the line before (up) or after the one shown, after the newest comes an empty line.
+static void edit_history_move(TinyCmd_Status up)
+{
+    TinyCmd_Edit* e = &TinyCmd_edit;
+    TinyCmd_Counter_Type pos = e->pos;
+
+    if (up) {
+        if (pos == 0) {
+            return;
+        }
+        //Back over the '\0' of the line before, then to its start
+        pos--;
+        while (pos > 0 && e->history[pos - 1] != '\0') {
+            pos--;
+        }
+    } else {
+        if (pos >= e->used) {
+            return;
+        }
+        pos += TinyCmd_strlen(e->history + pos) + 1;
+    }
+
+    e->pos = pos;
+    if (pos < e->used) {
+        edit_show(e->history + pos, TinyCmd_strlen(e->history + pos));
+    } else {
+        edit_show("", 0);
+    }
+}
+
+//static TinyCmd_Counter_Type complete_common(const TinyCmd_Completion* c, const char* name, TinyCmd_Status flash)
+//Description:Length of the start name has in common with the first candidate, ignoring case.
+static TinyCmd_Counter_Type complete_common(const TinyCmd_Completion* c, const char* name, TinyCmd_Status flash)
+{
+    TinyCmd_Counter_Type i = 0;
+    char a;
+
+    (void)flash; //Only read through FMT_CHAR with CMD_USE_PROGMEM
+    while (i < c->common && (a = FMT_CHAR(c->first + i, c->first_flash)) != '\0' &&
+           TinyCmd_tolower(a) == TinyCmd_tolower(FMT_CHAR(name + i, flash))) {
+        i++;
+    }
+
+    return i;
+}
+
+//static void complete_add(TinyCmd_Completion* c, const char* name, TinyCmd_Status flash)
+//Description:Count or print one candidate, flash is TINYCMD_SUCCESS for a command name.
+static void complete_add(TinyCmd_Completion* c, const char* name, TinyCmd_Status flash)
+{
+    if (c->list) {
+        char ch;
+        while ((ch = FMT_CHAR(name, flash)) != '\0') {
+            CMD_SEND_CHAR(ch);
+            name++;
+        }
+        send_bytes("  ", 2);
+        return;
+    }
+
+    if (c->count++ == 0) {
+        c->first = name;
+        c->first_flash = flash;
+        c->common = (TinyCmd_Counter_Type)-1;
+    }
+    c->common = complete_common(c, name, flash);
+}
+
+//static TinyCmd_Counter_Type complete_bound(TinyCmd_Command* const* list, TinyCmd_Counter_Type length,
+//                                           const char* word, TinyCmd_Status upper)
+//Description:Binary search of the sorted list: the first name starting with word (upper is TINYCMD_FAILED)
+//            or the first name after them (upper is TINYCMD_SUCCESS), ignoring case.
+static TinyCmd_Counter_Type complete_bound(TinyCmd_Command* const* list, TinyCmd_Counter_Type length,
+                                           const char* word, TinyCmd_Status upper)
+{
+    TinyCmd_Counter_Type lo = 0;
+    TinyCmd_Counter_Type hi = length;
+
+    while (lo < hi) {
+        TinyCmd_Counter_Type mid = lo + (hi - lo) / 2;
+        int order = TinyCmd_Cmd_Order(list[mid]->command, word, ORDER_PREFIX);
+        if (order < 0 || (upper && order == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+//static void complete_list(TinyCmd_Completion* c, TinyCmd_Command* const* list, TinyCmd_Counter_Type length)
+//Description:Add the names of a sorted list starting with the word. The range is found by two binary
+//            searches, and only its first and last names are compared when counting.
+static void complete_list(TinyCmd_Completion* c, TinyCmd_Command* const* list, TinyCmd_Counter_Type length)
+{
+    TinyCmd_Counter_Type lo = complete_bound(list, length, c->word, TINYCMD_FAILED);
+    TinyCmd_Counter_Type hi = complete_bound(list + lo, length - lo, c->word, TINYCMD_SUCCESS) + lo;
+
+    if (lo == hi) {
+        return;
+    }
+    if (c->list) {
+        for (TinyCmd_Counter_Type i = lo; i < hi; i++) {
+            complete_add(c, list[i]->command, TINYCMD_SUCCESS);
+        }
+        return;
+    }
+
+    //Sorted ignoring case: what the first and the last have in common, all in between have too
+    complete_add(c, list[lo]->command, TINYCMD_SUCCESS);
+    if (hi - lo > 1) {
+        complete_add(c, list[hi - 1]->command, TINYCMD_SUCCESS);
+        c->count += hi - lo - 2;
+    }
+}
+
+//static void complete_candidates(TinyCmd_Completion* c, const TinyCmd_Command* cmd, TinyCmd_Status subs)
+//Description:Add the candidates of the word: the commands when cmd is NULL, otherwise the subcommands
+//            of cmd (if subs) and the keywords of its arguments.
+static void complete_candidates(TinyCmd_Completion* c, const TinyCmd_Command* cmd, TinyCmd_Status subs)
+{
+    if (cmd == NULL) {
+        complete_list(c, TinyCmdRunning_Cmd.list, TinyCmdRunning_Cmd.length);
+#ifdef CMD_USE_SECTION
+        if (TinyCmd_section_sorted) {
+            complete_list(c, TinyCmd_section, TinyCmd_section_length);
+        } else {
+            for (const TinyCmd_Command* reg = TinyCmd_Section_Start; reg < TinyCmd_Section_Stop; reg++) {
+                if (!TinyCmd_Cmd_Order(reg->command, c->word, ORDER_PREFIX)) {
+                    complete_add(c, reg->command, TINYCMD_SUCCESS);
+                }
+            }
+        }
+#endif //CMD_USE_SECTION
+        return;
+    }
+
+#ifdef CMD_USE_SUB
+    if (subs && cmd->sub_count > 0) {
+        complete_list(c, cmd->sub, cmd->sub_count);
+    }
+#else
+    (void)subs;
+#endif //CMD_USE_SUB
+    if (cmd->keywords != NULL) {
+        for (TinyCmd_Counter_Type i = 0; i < cmd->keywords->count; i++) {
+            const char* word = cmd->keywords->words[i];
+            TinyCmd_Counter_Type j = 0;
+            while (j < c->len && TinyCmd_tolower(word[j]) == TinyCmd_tolower(c->word[j])) {
+                j++;
+            }
+            if (j == c->len) {
+                complete_add(c, word, TINYCMD_FAILED);
+            }
+        }
+    }
+}
+
+//static void edit_complete(void)
+//Description:Tab: complete the last word of the line. A single candidate is completed and followed by a space,
+//            several are completed as far as they agree, and listed when they don't agree any further.
+static void edit_complete(void)
+{
+    char* input = TinyCmd_buf.input;
+    TinyCmd_Counter_Type length = TinyCmd_buf.length;
+    TinyCmd_Counter_Type start = length;
+    TinyCmd_Counter_Type pos = 0;
+    const TinyCmd_Command* cmd = NULL;
+    TinyCmd_Status subs = TINYCMD_SUCCESS;
+    TinyCmd_Completion c;
+
+    if (TinyCmd_edit.cursor != length) {
+        return;
+    }
+    while (start > 0 && input[start - 1] != ' ') {
+        start--;
+    }
+
+    //Walk the command and subcommand words before the last one
+    while (pos < start) {
+        TinyCmd_Counter_Type end = pos;
+        if (input[pos] == ' ') {
+            pos++;
+            continue;
+        }
+        while (input[end] != ' ') {
+            end++;
+        }
+        input[end] = '\0';
+        if (cmd == NULL) {
+            cmd = TinyCmd_Find_Cmd(input + pos);
+            if (cmd == NULL) {
+                input[end] = ' ';
+                CMD_SEND_CHAR('\a');
+                return;
+            }
+#ifdef CMD_USE_SUB
+        } else if (subs && cmd->sub_count > 0) {
+            const TinyCmd_Command* sub = TinyCmd_Find_In(cmd->sub, cmd->sub_count, input + pos);
+            if (sub != NULL) {
+                cmd = sub;
+            } else {
+                subs = TINYCMD_FAILED;
+            }
+#endif //CMD_USE_SUB
+        } else {
+            subs = TINYCMD_FAILED;
+        }
+        input[end] = ' ';
+        pos = end;
+    }
+
+    c.word = input + start;
+    c.len = length - start;
+    c.count = 0;
+    c.common = 0;
+    c.list = TINYCMD_FAILED;
+    complete_candidates(&c, cmd, subs);
+
+    if (c.count == 0) {
+        CMD_SEND_CHAR('\a');
+        return;
+    }
+    if (c.count > 1 && c.common <= c.len) {
+        //Nothing more to complete: list them and show the line again
+        send_bytes("\r\n", 2);
+        c.list = TINYCMD_SUCCESS;
+        complete_candidates(&c, cmd, subs);
+        send_bytes("\r\n", 2);
+        send_bytes(input, length);
+        return;
+    }
+
+    //Retype the word in the case of the candidate and complete it
+    edit_back(c.len);
+    TinyCmd_edit.cursor = start;
+    TinyCmd_buf.length = start;
+    for (TinyCmd_Counter_Type i = 0; i < c.common; i++) {
+        edit_insert(FMT_CHAR(c.first + i, c.first_flash));
+    }
+    if (c.count == 1) {
+        edit_insert(' ');
+    }
+}
+
+//static TinyCmd_Status edit_put(char c)
+//Description:TinyCmd_PutChar() with the line editor: decode the key and edit TinyCmd_buf.input.
+//            "\r\n" is one Enter. While the entered line waits for TinyCmd_Handler() the keys are dropped
+//            with a bell, they would edit the line before it has run.
+static TinyCmd_Status edit_put(char c)
+{
+    TinyCmd_Edit* e = &TinyCmd_edit;
+    unsigned char last = e->last;
+    unsigned char key;
+
+    e->last = (unsigned char)c;
+    if (e->pending) {
+        if (c != '\n' || last != '\r') {
+            CMD_SEND_CHAR('\a');
+        }
+        return TINYCMD_FAILED;
+    }
+    key = edit_decode((unsigned char)c);
+
+    switch (key) {
+        case KEY_INSERT:
+            edit_insert(c);
+            break;
+        case KEY_ENTER:
+            if (c == '\n' && last == '\r') {
+                break;
+            }
+            send_bytes("\r\n", 2);
+            e->cursor = 0;
+            if (TinyCmd_buf.length == 0) {
+                //Nothing to run on an empty line
+                e->pos = e->used;
+                break;
+            }
+            edit_history_add();
+            e->pos = e->used;
+            e->pending = 1;
+            return TINYCMD_SUCCESS;
+        case KEY_BACKSPACE:
+            if (e->cursor > 0) {
+                e->cursor--;
+                CMD_SEND_CHAR('\b');
+                edit_delete();
+            }
+            break;
+        case KEY_DELETE:
+            edit_delete();
+            break;
+        case KEY_LEFT:
+            if (e->cursor > 0) {
+                e->cursor--;
+                CMD_SEND_CHAR('\b');
+            }
+            break;
+        case KEY_RIGHT:
+            if (e->cursor < TinyCmd_buf.length) {
+                CMD_SEND_CHAR(TinyCmd_buf.input[e->cursor++]);
+            }
+            break;
+        case KEY_HOME:
+            edit_back(e->cursor);
+            e->cursor = 0;
+            break;
+        case KEY_END:
+            send_bytes(TinyCmd_buf.input + e->cursor, TinyCmd_buf.length - e->cursor);
+            e->cursor = TinyCmd_buf.length;
+            break;
+        case KEY_UP:
+        case KEY_DOWN:
+            edit_history_move(key == KEY_UP ? TINYCMD_SUCCESS : TINYCMD_FAILED);
+            break;
+        case KEY_ESC:
+            e->state = EDIT_ESC;
+            break;
+        case KEY_TAB:
+            edit_complete();
+            break;
+        default:
+            break;
+    }
+
+    return TINYCMD_FAILED;
+}
+#endif //CMD_USE_LINE_EDIT
+
+#ifdef CMD_USE_XFER
+//Binary transfer****************************************************************//
+
+//CRC-16/CCITT (poly 0x1021), the table size follows CMD_PORT_WORD
+#if CMD_PORT_WORD >= 4
+//One lookup per byte, the 512 bytes table is cheap on 32-bit parts
+static const unsigned short TinyCmd_crc_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+static unsigned short xfer_crc(unsigned short crc, unsigned char c)
+{
+    return (unsigned short)((crc << 8) ^ TinyCmd_crc_table[(crc >> 8) ^ c]);
+}
+#else
+//One lookup per nibble, a 32 bytes table for 8-bit parts
+static const unsigned short TinyCmd_crc_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+static unsigned short xfer_crc(unsigned short crc, unsigned char c)
+{
+    crc = (crc << 4) ^ TinyCmd_crc_table[(crc >> 12) ^ (c >> 4)];
+    crc = (crc << 4) ^ TinyCmd_crc_table[(crc >> 12) ^ (c & 0x0F)];
+    return crc;
+}
+#endif
+
+static void xfer_reply(unsigned char type, unsigned char seq)
+{
+    char reply[2];
+    reply[0] = (char)type;
+    reply[1] = (char)seq;
+    send_bytes(reply, 2);
+}
+
+//A whole chunk is received, pass it to the sink if it is the expected one
+static void xfer_chunk(void)
+{
+    if (TinyCmd_xfer.frame_seq != TinyCmd_xfer.seq) {
+        //Go back N: chunks after a lost one are dropped, the sender resends from the NAKed one
+        if (!TinyCmd_xfer.nak_sent) {
+            xfer_reply(XFER_NAK, TinyCmd_xfer.seq);
+            TinyCmd_xfer.nak_sent = 1;
+        }
+        return;
+    }
+
+    if (TinyCmd_xfer.sink != NULL &&
+        !TinyCmd_xfer.sink(TinyCmd_xfer.offset, TinyCmd_xfer.chunk, TinyCmd_xfer.frame_len)) {
+        xfer_reply(XFER_CAN, XFER_CAN);
+        TinyCmd_xfer.mode = XFER_IDLE;
+        return;
+    }
+
+    xfer_reply(XFER_ACK, TinyCmd_xfer.seq);
+    TinyCmd_xfer.seq++;
+    TinyCmd_xfer.nak_sent = 0;
+    TinyCmd_xfer.offset += TinyCmd_xfer.frame_len;
+    if (TinyCmd_xfer.offset >= TinyCmd_xfer.total) {
+        TinyCmd_xfer.mode = XFER_IDLE;
+    }
+}
+
+//ACK or NAK from the receiver while sending
+static void xfer_tx_reply(unsigned char type, unsigned char seq)
+{
+    unsigned char ahead = (unsigned char)(seq - TinyCmd_xfer.base_seq);
+    unsigned char sent = (unsigned char)(TinyCmd_xfer.next_seq - TinyCmd_xfer.base_seq);
+
+    if (type == XFER_CAN) {
+        TinyCmd_xfer.mode = XFER_IDLE;
+        return;
+    }
+    if (type == XFER_ACK && ahead < sent) {
+        //Cumulative: everything up to seq is received
+        TinyCmd_xfer.base_seq = seq + 1;
+        TinyCmd_xfer.base += (unsigned long)(ahead + 1) * CMD_XFER_CHUNK;
+        if (TinyCmd_xfer.base >= TinyCmd_xfer.total) {
+            TinyCmd_xfer.mode = XFER_IDLE;
+        }
+    } else if (type == XFER_NAK && ahead <= sent) {
+        //Go back to the chunk the receiver expects
+        TinyCmd_xfer.base_seq = seq;
+        TinyCmd_xfer.base += (unsigned long)ahead * CMD_XFER_CHUNK;
+        TinyCmd_xfer.next_seq = seq;
+        TinyCmd_xfer.next = TinyCmd_xfer.base;
+        //The receiver expects the chunk after the last one: it has everything, only the last ACK was lost
+        if (TinyCmd_xfer.base >= TinyCmd_xfer.total) {
+            TinyCmd_xfer.mode = XFER_IDLE;
+        }
+    }
+}
+
+//Byte received while a transfer is running
+static void xfer_put(unsigned char c)
+{
+    switch (TinyCmd_xfer.state) {
+        case XFER_HUNT:
+            if (TinyCmd_xfer.mode == XFER_TX && (c == XFER_ACK || c == XFER_NAK || c == XFER_CAN)) {
+                TinyCmd_xfer.frame_len = c;
+                TinyCmd_xfer.state = XFER_SEQ;
+            } else if (TinyCmd_xfer.mode == XFER_RX && c == XFER_SYNC) {
+                TinyCmd_xfer.crc = 0xFFFF;
+                TinyCmd_xfer.state = XFER_SEQ;
+            } else if (c == XFER_CAN) {
+                //A single CAN may be a payload byte of a damaged chunk, two in a row abort
+                TinyCmd_xfer.state = XFER_CANCEL;
+            }
+            break;
+        case XFER_CANCEL:
+            TinyCmd_xfer.state = XFER_HUNT;
+            if (c == XFER_CAN) {
+                TinyCmd_xfer.mode = XFER_IDLE;
+            } else if (c == XFER_SYNC) {
+                TinyCmd_xfer.crc = 0xFFFF;
+                TinyCmd_xfer.state = XFER_SEQ;
+            }
+            break;
+        case XFER_SEQ:
+            if (TinyCmd_xfer.mode == XFER_TX) {
+                xfer_tx_reply(TinyCmd_xfer.frame_len, c);
+                TinyCmd_xfer.state = XFER_HUNT;
+                break;
+            }
+            TinyCmd_xfer.frame_seq = c;
+            TinyCmd_xfer.crc = xfer_crc(TinyCmd_xfer.crc, c);
+            TinyCmd_xfer.state = XFER_LEN;
+            break;
+        case XFER_LEN:
+            if (c == 0 || c > CMD_XFER_CHUNK) {
+                TinyCmd_xfer.state = XFER_HUNT;
+                break;
+            }
+            TinyCmd_xfer.frame_len = c;
+            TinyCmd_xfer.pos = 0;
+            TinyCmd_xfer.crc = xfer_crc(TinyCmd_xfer.crc, c);
+            TinyCmd_xfer.state = XFER_DATA;
+            break;
+        case XFER_DATA:
+            TinyCmd_xfer.chunk[TinyCmd_xfer.pos++] = c;
+            TinyCmd_xfer.crc = xfer_crc(TinyCmd_xfer.crc, c);
+            if (TinyCmd_xfer.pos >= TinyCmd_xfer.frame_len) {
+                TinyCmd_xfer.state = XFER_CRC0;
+            }
+            break;
+        case XFER_CRC0:
+            TinyCmd_xfer.crc ^= c;
+            TinyCmd_xfer.state = XFER_CRC1;
+            break;
+        case XFER_CRC1:
+            TinyCmd_xfer.crc ^= (unsigned short)c << 8;
+            TinyCmd_xfer.state = XFER_HUNT;
+            if (TinyCmd_xfer.crc == 0) {
+                xfer_chunk();
+            } else if (!TinyCmd_xfer.nak_sent) {
+                xfer_reply(XFER_NAK, TinyCmd_xfer.seq);
+                TinyCmd_xfer.nak_sent = 1;
+            }
+            break;
+        default:
+            TinyCmd_xfer.state = XFER_HUNT;
+            break;
+    }
+}
+
+//TinyCmd_Status TinyCmd_Xfer_Recv(TinyCmd_Xfer_Sink sink, unsigned long len):
+//Description:Switch TinyCmd_PutChar() into binary reception of len bytes.
+//            Every chunk received in order is passed to sink from TinyCmd_xfer.chunk, in the receive
+//            interrupt that completes it.
+//            ACK 0xFF is sent to tell the sender to start with chunk 0.
+//Returns:
+//        TINYCMD_SUCCESS: Reception started.
+//        TINYCMD_FAILED: Another transfer is running or len is 0.
+TinyCmd_Status TinyCmd_Xfer_Recv(TinyCmd_Xfer_Sink sink, unsigned long len)
+{
+    if (TinyCmd_xfer.mode != XFER_IDLE || len == 0) {
+        return TINYCMD_FAILED;
+    }
+
+    TinyCmd_xfer.sink = sink;
+    TinyCmd_xfer.total = len;
+    TinyCmd_xfer.offset = 0;
+    TinyCmd_xfer.seq = 0;
+    TinyCmd_xfer.nak_sent = 0;
+    TinyCmd_xfer.state = XFER_HUNT;
+    TinyCmd_xfer.stamp = CMD_MILLIS();
+    TinyCmd_xfer.mode = XFER_RX;
+    xfer_reply(XFER_ACK, 0xFF);
+
+    return TINYCMD_SUCCESS;
+}
+
+//TinyCmd_Status TinyCmd_Xfer_Send(const void* data, unsigned long len):
+//Description:Start sending len bytes from data. The chunks are sent by TinyCmd_Xfer_Poll(),
+//            the ACK and NAK of the receiver come in by TinyCmd_PutChar().
+//Returns:
+//        TINYCMD_SUCCESS: Sending started.
+//        TINYCMD_FAILED: Another transfer is running, data is NULL or len is 0.
+TinyCmd_Status TinyCmd_Xfer_Send(const void* data, unsigned long len)
+{
+    if (TinyCmd_xfer.mode != XFER_IDLE || data == NULL || len == 0) {
+        return TINYCMD_FAILED;
+    }
+
+    TinyCmd_xfer.src = (const unsigned char*)data;
+    TinyCmd_xfer.total = len;
+    TinyCmd_xfer.base = 0;
+    TinyCmd_xfer.next = 0;
+    TinyCmd_xfer.base_seq = 0;
+    TinyCmd_xfer.next_seq = 0;
+    TinyCmd_xfer.state = XFER_HUNT;
+    TinyCmd_xfer.mode = XFER_TX;
+
+    return TINYCMD_SUCCESS;
+}
+
+//TinyCmd_Status TinyCmd_Xfer_Poll(void):
+//Description:Send the chunks allowed by the window. Call this function in the main loop.
+//            The receiver sends NAK with the expected chunk when it times out, so lost chunks are resent.
+//            While receiving, the NAK is sent here after CMD_XFER_TIMEOUT ms without a byte.
+//Returns:
+//        TINYCMD_SUCCESS: A transfer is running.
+//        TINYCMD_FAILED: No transfer is running.
+TinyCmd_Status TinyCmd_Xfer_Poll(void)
+{
+    if (TinyCmd_xfer.mode == XFER_RX) {
+        unsigned long now = CMD_MILLIS();
+        TinyCmd_Status timeout = TINYCMD_FAILED;
+        {
+            CMD_PORT_ENTER_CRITICAL();
+            if (now - TinyCmd_xfer.stamp >= CMD_XFER_TIMEOUT) {
+                //The rest of the chunk being parsed is lost, wait for the resent one
+                TinyCmd_xfer.stamp = now;
+                TinyCmd_xfer.state = XFER_HUNT;
+                timeout = TINYCMD_SUCCESS;
+            }
+            CMD_PORT_EXIT_CRITICAL();
+        }
+        if (timeout) {
+            xfer_reply(XFER_NAK, TinyCmd_xfer.seq);
+        }
+        return TINYCMD_SUCCESS;
+    }
+    if (TinyCmd_xfer.mode != XFER_TX) {
+        return TINYCMD_FAILED;
+    }
+
+    while (TinyCmd_xfer.next < TinyCmd_xfer.total &&
+           (unsigned char)(TinyCmd_xfer.next_seq - TinyCmd_xfer.base_seq) < CMD_XFER_WINDOW) {
+        char head[3];
+        char tail[2];
+        unsigned long left = TinyCmd_xfer.total - TinyCmd_xfer.next;
+        unsigned char len = (left < CMD_XFER_CHUNK) ? (unsigned char)left : CMD_XFER_CHUNK;
+        const unsigned char* data = TinyCmd_xfer.src + TinyCmd_xfer.next;
+        unsigned short crc = 0xFFFF;
+
+        head[0] = (char)XFER_SYNC;
+        head[1] = (char)TinyCmd_xfer.next_seq;
+        head[2] = (char)len;
+        crc = xfer_crc(crc, (unsigned char)head[1]);
+        crc = xfer_crc(crc, len);
+        for (unsigned char i = 0; i < len; i++) {
+            crc = xfer_crc(crc, data[i]);
+        }
+        tail[0] = (char)(crc & 0xFF);
+        tail[1] = (char)(crc >> 8);
+
+        //The payload is sent straight from the source memory
+        send_bytes(head, 3);
+        send_bytes((const char*)data, len);
+        send_bytes(tail, 2);
+
+        TinyCmd_xfer.next_seq++;
+        TinyCmd_xfer.next += len;
+    }
+
+    return TINYCMD_SUCCESS;
+}
+
+//void TinyCmd_Xfer_Abort(void):
+//Description:Stop the running transfer and tell the other side by CAN.
+void TinyCmd_Xfer_Abort(void)
+{
+    if (TinyCmd_xfer.mode != XFER_IDLE) {
+        TinyCmd_xfer.mode = XFER_IDLE;
+        xfer_reply(XFER_CAN, XFER_CAN);
+    }
+}
+
+//Built-in command:
+//  rx <len>           Receive len bytes into TinyCmd_XferSink.
+static TinyCmd_CallBack_Ret rx_callback(void)
+{
+    unsigned long long len;
+    int sign;
+
+    if (TinyCmd_XferSink == NULL || TinyCmd_buf.arg[0] == NULL || !str_to_uint(TinyCmd_buf.arg[0], &len, &sign)) {
+        return TINYCMD_FAILED;
+    }
+    return TinyCmd_Xfer_Recv(TinyCmd_XferSink, (unsigned long)len);
+}
+
+//Built-in command:
+//  tx <addr> <len>    Send len bytes from addr (decimal or 0x hexadecimal).
+static TinyCmd_CallBack_Ret tx_callback(void)
+{
+    unsigned long long addr;
+    unsigned long long len;
+    int sign;
+
+    if (TinyCmd_buf.arg[0] == NULL || !str_to_uint(TinyCmd_buf.arg[0], &addr, &sign) ||
+        TinyCmd_buf.arg[1] == NULL || !str_to_uint(TinyCmd_buf.arg[1], &len, &sign)) {
+        return TINYCMD_FAILED;
+    }
+    return TinyCmd_Xfer_Send((const void*)(unsigned long)addr, (unsigned long)len);
+}
+
+static TINYCMD_NAME(rx_name, "rx");
+static TINYCMD_NAME(tx_name, "tx");
+TinyCmd_Command TinyCmd_Rx_Cmd = {.command = rx_name, .callback = &rx_callback};
+TinyCmd_Command TinyCmd_Tx_Cmd = {.command = tx_name, .callback = &tx_callback};
+#endif //CMD_USE_XFER
+
+#ifdef CMD_USE_DEFER_REPORT
+//Deferred report****************************************************************//
+
+//Put the n low bytes of value into the frame little endian, the frame is sent first if it's full.
+static void defer_put(char* frame, TinyCmd_Counter_Type* pos, TinyCmd_Counter_Type size,
+                      unsigned long long value, TinyCmd_Counter_Type n)
+{
+    if (*pos + n > size) {
+        send_bytes(frame, *pos);
+        *pos = 0;
+    }
+    while (n--) {
+        frame[(*pos)++] = (char)(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+//TinyCmd_Status TinyCmd_Report_Id(unsigned int id,...)
+//Description:Deferred version of TinyCmd_Report. Sends 0xA6, the index of the format string in
+//            TinyCmd_Fmt_Table and the raw arguments, no number is formatted on the device.
+//            Integers are sent as 32-bit values ("l" in the width of long, 64-bit for "ll"), %c as one byte,
+//            %f as a 32-bit float and %s as the string with its '\0', all little endian.
+//args:
+//        id: Index of the format string in TinyCmd_Fmt_Table, unsigned int as va_start needs a
+//            promoted type for the last named parameter. It is sent in one byte.
+//Returns:
+//        TINYCMD_SUCCESS: Report successful.
+//        TINYCMD_FAILED: id is not in the format table or bigger than 255.
+TinyCmd_Status TinyCmd_Report_Id(unsigned int id, ...)
+{
+    char frame[16];
+    TinyCmd_Counter_Type pos = 0;
+    const char* format;
+    va_list args;
+
+    if (id >= TinyCmd_Fmt_Count || id > 0xFF) {
+        return TINYCMD_FAILED;
+    }
+    format = TinyCmd_Fmt_Table[id];
+
+    va_start(args, id);
+
+    frame[pos++] = (char)DEFER_FRAME_SYNC;
+    frame[pos++] = (char)id;
+
+    while (*format) {
+        TinyCmd_Fmt_Op op;
+        const char* next;
+
+        if (*format++ != '%' || (next = fmt_parse(format, &op)) == NULL) {
+            continue;
+        }
+        format = next;
+
+        switch (op.conv) {
+            case 'd':
+                if (op.length == 2) {
+                    defer_put(frame, &pos, sizeof(frame), (unsigned long long)va_arg(args, long long), 8);
+                } else if (op.length == 1) {
+                    defer_put(frame, &pos, sizeof(frame), (unsigned long long)va_arg(args, long), sizeof(long));
+                } else {
+                    defer_put(frame, &pos, sizeof(frame), (unsigned long long)va_arg(args, int), 4);
+                }
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                if (op.length == 2) {
+                    defer_put(frame, &pos, sizeof(frame), va_arg(args, unsigned long long), 8);
+                } else if (op.length == 1) {
+                    defer_put(frame, &pos, sizeof(frame), va_arg(args, unsigned long), sizeof(unsigned long));
+                } else {
+                    defer_put(frame, &pos, sizeof(frame), va_arg(args, unsigned int), 4);
+                }
+                break;
+            case 'c':
+                defer_put(frame, &pos, sizeof(frame), (unsigned long long)va_arg(args, int), 1);
+                break;
+            case 'f': {
+                //The float is sent as it is stored in memory: its bytes are copied into the low bytes of
+                //bits, all supported targets are little endian
+                float value = (float)va_arg(args, double);
+                unsigned long bits = 0;
+                memcpy(&bits, &value, sizeof(value));
+                defer_put(frame, &pos, sizeof(frame), bits, sizeof(value));
+                break;
+            }
+            case 's': {
+                const char* str = va_arg(args, const char*);
+                if (str == NULL) {
+                    str = "(null)";
+                }
+                send_bytes(frame, pos);
+                pos = 0;
+                send_string(str);
+                send_char('\0');
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    send_bytes(frame, pos);
+
+    va_end(args);
+
+    return TINYCMD_SUCCESS;
+}
+#endif //CMD_USE_DEFER_REPORT
+
+#ifdef CMD_USE_DUMP
+//Memory dump****************************************************************//
+
+//Integer type holding an address, unsigned long except on LLP64 (64-bit Windows)
+#if defined(_WIN64)
+typedef unsigned long long TinyCmd_Addr;
+#else
+typedef unsigned long TinyCmd_Addr;
+#endif
+
+static const char TinyCmd_base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+//Hexdump line: "address  xx xx .. xx  xx .. xx  |ascii|\n", built in one buffer and sent at once.
+static void dump_hex_line(const unsigned char* data, TinyCmd_Counter_Type n)
+{
+    SCRATCH_BUFFER(line, DUMP_LINE_SIZE);
+    TinyCmd_Counter_Type pos = 0;
+    TinyCmd_Addr addr = (TinyCmd_Addr)data;
+
+    for (int shift = sizeof(void*) * 8 - 4; shift >= 0; shift -= 4) {
+        line[pos++] = TinyCmd_digits[(addr >> shift) & 0x0F];
+    }
+    line[pos++] = ' ';
+
+    for (TinyCmd_Counter_Type i = 0; i < CMD_DUMP_LINE; i++) {
+        if (i % 8 == 0) {
+            line[pos++] = ' ';
+        }
+        if (i < n) {
+            line[pos++] = TinyCmd_digits[data[i] >> 4];
+            line[pos++] = TinyCmd_digits[data[i] & 0x0F];
+        } else {
+            line[pos++] = ' ';
+            line[pos++] = ' ';
+        }
+        line[pos++] = ' ';
+    }
+
+    line[pos++] = ' ';
+    line[pos++] = '|';
+    for (TinyCmd_Counter_Type i = 0; i < n; i++) {
+        line[pos++] = (data[i] >= 0x20 && data[i] < 0x7F) ? (char)data[i] : '.';
+    }
+    line[pos++] = '|';
+    line[pos++] = '\n';
+
+    send_bytes(line, pos);
+}
+
+//Base64 line: up to 48 bytes encoded into 64 characters and '\n'.
+static void dump_base64_line(const unsigned char* data, TinyCmd_Counter_Type n)
+{
+    SCRATCH_BUFFER(line, DUMP_BASE64_SIZE);
+    TinyCmd_Counter_Type pos = 0;
+
+    for (TinyCmd_Counter_Type i = 0; i < n; i += 3) {
+        unsigned long block = (unsigned long)data[i] << 16;
+        if (i + 1 < n) {
+            block |= (unsigned long)data[i + 1] << 8;
+        }
+        if (i + 2 < n) {
+            block |= data[i + 2];
+        }
+        line[pos++] = TinyCmd_base64[(block >> 18) & 0x3F];
+        line[pos++] = TinyCmd_base64[(block >> 12) & 0x3F];
+        line[pos++] = (i + 1 < n) ? TinyCmd_base64[(block >> 6) & 0x3F] : '=';
+        line[pos++] = (i + 2 < n) ? TinyCmd_base64[block & 0x3F] : '=';
+    }
+    line[pos++] = '\n';
+
+    send_bytes(line, pos);
+}
+
+//TinyCmd_Status TinyCmd_Dump(const void* addr, unsigned long len, TinyCmd_DumpMode mode):
+//Description:Send len bytes from addr as classic hexdump lines or as base64 lines.
+//            Every line is built in a buffer and sent as one block.
+//args:
+//        addr: Start address of the memory.
+//        len: Number of bytes.
+//        mode: TINYCMD_DUMP_HEX or TINYCMD_DUMP_BASE64.
+//Returns:
+//        TINYCMD_SUCCESS: Dump successful.
+//        TINYCMD_FAILED: addr is NULL.
+TinyCmd_Status TinyCmd_Dump(const void* addr, unsigned long len, TinyCmd_DumpMode mode)
+{
+    const unsigned char* data = (const unsigned char*)addr;
+    TinyCmd_Counter_Type step = (mode == TINYCMD_DUMP_BASE64) ? 48 : CMD_DUMP_LINE;
+
+    if (data == NULL) {
+        return TINYCMD_FAILED;
+    }
+
+    while (len > 0) {
+        TinyCmd_Counter_Type n = (len < step) ? (TinyCmd_Counter_Type)len : step;
+        if (mode == TINYCMD_DUMP_BASE64) {
+            dump_base64_line(data, n);
+        } else {
+            dump_hex_line(data, n);
+        }
+        data += n;
+        len -= n;
+    }
+
+    return TINYCMD_SUCCESS;
+}
+
+//Built-in command:
+//  md <addr> <len> [b64]    Dump len bytes from addr (decimal or 0x hexadecimal) as hexdump or base64.
+static TinyCmd_CallBack_Ret dump_callback(void)
+{
+    unsigned long long addr;
+    unsigned long long len = CMD_DUMP_LINE;
+    int sign;
+
+    if (TinyCmd_buf.arg[0] == NULL || !str_to_uint(TinyCmd_buf.arg[0], &addr, &sign) ||
+        (TinyCmd_buf.arg[1] != NULL && !str_to_uint(TinyCmd_buf.arg[1], &len, &sign))) {
+        TinyCmd_Report_P(TINYCMD_PSTR("md: md <addr> <len> [b64]\n"));
+        return TINYCMD_FAILED;
+    }
+
+    return TinyCmd_Dump((const void*)(TinyCmd_Addr)addr, (unsigned long)len,
+                        TinyCmd_Arg_Check("b64", 2) ? TINYCMD_DUMP_BASE64 : TINYCMD_DUMP_HEX);
+}
+
+static TINYCMD_NAME(dump_name, "md");
+TinyCmd_Command TinyCmd_Dump_Cmd = {.command = dump_name, .callback = &dump_callback};
+#endif //CMD_USE_DUMP
+
+#ifdef CMD_USE_STREAM
+//Telemetry stream****************************************************************//
+
+static void ltoa(long value, char* buffer) {
+    char* p = buffer;
+    unsigned long uvalue = (value < 0) ? -(unsigned long)value : (unsigned long)value;
+
+    do {
+        *p++ = (uvalue % 10) + '0';
+    } while (uvalue /= 10);
+
+    if (value < 0) {
+        *p++ = '-';
+    }
+
+    *p = '\0';
+    for (int i = 0, j = p - buffer - 1; i < j; i++, j--) {
+        char temp = buffer[i];
+        buffer[i] = buffer[j];
+        buffer[j] = temp;
+    }
+}
+
+//Scaled FLOAT and DOUBLE samples and 64-bit variables saturate at the range of long,
+//converting an out of range value to long is undefined.
+static long stream_round_f(float value) {
+    if (value != value) {
+        return 0;
+    }
+    if (value >= (float)LONG_MAX) {
+        return LONG_MAX;
+    }
+    if (value <= (float)LONG_MIN) {
+        return LONG_MIN;
+    }
+    return (long)(value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+static long stream_round(double value) {
+    if (value != value) {
+        return 0;
+    }
+    if (value >= (double)LONG_MAX) {
+        return LONG_MAX;
+    }
+    if (value <= (double)LONG_MIN) {
+        return LONG_MIN;
+    }
+    return (long)(value < 0 ? value - 0.5 : value + 0.5);
+}
+
+static long stream_sample(const TinyCmd_Var* var) {
+    switch (var->type) {
+        case TINYCMD_UINT8:  return *(const volatile unsigned char*)var->ptr;
+        case TINYCMD_INT8:   return *(const volatile signed char*)var->ptr;
+        case TINYCMD_UINT16: return *(const volatile unsigned short*)var->ptr;
+        case TINYCMD_INT16:  return *(const volatile short*)var->ptr;
+        case TINYCMD_UINT32: return (long)*(const volatile unsigned int*)var->ptr;
+        case TINYCMD_INT32:  return *(const volatile int*)var->ptr;
+        #if CMD_NAME_LENGTH > 9
+        case TINYCMD_UINT64: {
+            unsigned long long value = *(const volatile unsigned long long*)var->ptr;
+            return value > LONG_MAX ? LONG_MAX : (long)value;
+        }
+        case TINYCMD_INT64: {
+            long long value = *(const volatile long long*)var->ptr;
+            return value > LONG_MAX ? LONG_MAX : value < LONG_MIN ? LONG_MIN : (long)value;
+        }
+        #endif //CMD_NAME_LENGTH > 9
+        case TINYCMD_FLOAT:  return stream_round_f(*(const volatile float*)var->ptr * var->scale);
+        case TINYCMD_DOUBLE: return stream_round(*(const volatile double*)var->ptr * var->scale);
+        default:
+            return 0;
+    }
+}
+
+static TinyCmd_Var* stream_find(const char* name, TinyCmd_Counter_Type* index) {
+    for (TinyCmd_Counter_Type i = 0; i < TinyCmd_stream.length; i++) {
+        if (!TinyCmd_strcmp(name, TinyCmd_stream.list[i]->name)) {
+            *index = i;
+            return TinyCmd_stream.list[i];
+        }
+    }
+    return NULL;
+}
+
+static void stream_send_bin(const long* row, TinyCmd_Counter_Type n) {
+    char frame[3 + 4 * CMD_VAR_LIST_SIZE + 1];
+    TinyCmd_Counter_Type pos = 0;
+    unsigned char check;
+
+    frame[pos++] = (char)STREAM_FRAME_SYNC;
+    frame[pos++] = (char)TinyCmd_stream.seq++;
+    frame[pos++] = (char)n;
+    for (TinyCmd_Counter_Type i = 0; i < n; i++) {
+        unsigned long value = (unsigned long)row[i];
+        frame[pos++] = (char)(value & 0xFF);
+        frame[pos++] = (char)((value >> 8) & 0xFF);
+        frame[pos++] = (char)((value >> 16) & 0xFF);
+        frame[pos++] = (char)((value >> 24) & 0xFF);
+    }
+
+    check = 0;
+    for (TinyCmd_Counter_Type i = 1; i < pos; i++) {
+        check ^= (unsigned char)frame[i];
+    }
+    frame[pos++] = (char)check;
+
+    send_bytes(frame, pos);
+}
+
+//Text row: "=v0,v1,...\n" for a keyframe, "d0,d1,...\n" for deltas to the previous row.
+//A zero delta is sent as an empty field. Deltas wrap around modulo the width of long,
+//the host adds them to the previous row modulo the same width.
+static void stream_send_text(const long* row, TinyCmd_Counter_Type n) {
+    SCRATCH_BUFFER(line, STREAM_LINE_SIZE);
+    TinyCmd_Counter_Type pos = 0;
+    TinyCmd_Counter_Type key = (TinyCmd_stream.keyframe == 0);
+
+    if (key) {
+        line[pos++] = '=';
+    }
+    if (++TinyCmd_stream.keyframe >= CMD_STREAM_KEYFRAME) {
+        TinyCmd_stream.keyframe = 0;
+    }
+
+    for (TinyCmd_Counter_Type i = 0; i < n; i++) {
+        long value = key ? row[i] : (long)((unsigned long)row[i] - (unsigned long)TinyCmd_stream.last[i]);
+        if (pos > STREAM_FLUSH_AT) {
+            send_bytes(line, pos);
+            pos = 0;
+        }
+        if (i) {
+            line[pos++] = ',';
+        }
+        if (key || value) {
+            ltoa(value, line + pos);
+            pos += TinyCmd_strlen(line + pos);
+        }
+        TinyCmd_stream.last[i] = row[i];
+    }
+    line[pos++] = '\n';
+
+    send_bytes(line, pos);
+}
+
+//TinyCmd_Status TinyCmd_Var_Add(TinyCmd_Var* newVar):
+//Description:Add a new variable to the stream variable list.
+//args:
+//        newVar: Pointer to the TinyCmd_Var struct describing the variable.
+//Returns:
+//        TINYCMD_SUCCESS: Variable added successfully.
+//        TINYCMD_FAILED: Variable addition failed.
+TinyCmd_Status TinyCmd_Var_Add(TinyCmd_Var* newVar)
+{
+    if (newVar == NULL || newVar->ptr == NULL || newVar->name == NULL) {
+        return TINYCMD_FAILED;
+    }
+    if (TinyCmd_stream.length >= CMD_VAR_LIST_SIZE) {
+        return TINYCMD_FAILED;
+    }
+    TinyCmd_stream.list[TinyCmd_stream.length++] = newVar;
+    return TINYCMD_SUCCESS;
+}
+
+//TinyCmd_Status TinyCmd_Stream_Select(const char* name, TinyCmd_Status on):
+//Description:Add the variable to or remove it from the streamed row. The stream is stopped.
+//args:
+//        name: Name of the variable.
+//        on: TINYCMD_SUCCESS to stream the variable, TINYCMD_FAILED to remove it.
+//Returns:
+//        TINYCMD_SUCCESS: Selection changed.
+//        TINYCMD_FAILED: Variable not found.
+TinyCmd_Status TinyCmd_Stream_Select(const char* name, TinyCmd_Status on)
+{
+    TinyCmd_Counter_Type i;
+
+    if (stream_find(name, &i) == NULL) {
+        return TINYCMD_FAILED;
+    }
+
+    TinyCmd_Stream_Stop();
+    if (on) {
+        TinyCmd_stream.select |= 1ul << i;
+    } else {
+        TinyCmd_stream.select &= ~(1ul << i);
+    }
+    return TINYCMD_SUCCESS;
+}
+
+//TinyCmd_Status TinyCmd_Stream_Start(TinyCmd_Counter_Type decimation, TinyCmd_StreamMode mode):
+//Description:Start streaming the selected variables.
+//args:
+//        decimation: One row is sampled every decimation calls of TinyCmd_Stream_Tick().
+//        mode: TINYCMD_STREAM_BIN or TINYCMD_STREAM_TEXT.
+//Returns:
+//        TINYCMD_SUCCESS: Stream started.
+//        TINYCMD_FAILED: No variable is selected or a row doesn't fit in the ring buffer.
+TinyCmd_Status TinyCmd_Stream_Start(TinyCmd_Counter_Type decimation, TinyCmd_StreamMode mode)
+{
+    TinyCmd_Counter_Type n = 0;
+
+    TinyCmd_Stream_Stop();
+    for (TinyCmd_Counter_Type i = 0; i < TinyCmd_stream.length; i++) {
+        if (TinyCmd_stream.select & (1ul << i)) {
+            n++;
+        }
+    }
+    if (n == 0 || n > CMD_STREAM_RING_SIZE) {
+        return TINYCMD_FAILED;
+    }
+
+    TinyCmd_stream.row_len = n;
+    TinyCmd_stream.decimation = decimation ? decimation : 1;
+    TinyCmd_stream.mode = mode;
+    TinyCmd_stream.tick = 0;
+    TinyCmd_stream.tail = TinyCmd_stream.head;
+    TinyCmd_stream.rows = 0;
+    TinyCmd_stream.dropped = 0;
+    TinyCmd_stream.sent = 0;
+    TinyCmd_stream.seq = 0;
+    TinyCmd_stream.keyframe = 0;
+    TinyCmd_stream.running = 1;
+
+    return TINYCMD_SUCCESS;
+}
+
+//void TinyCmd_Stream_Stop(void):
+//Description:Stop streaming. Rows which are not flushed yet are discarded.
+void TinyCmd_Stream_Stop(void)
+{
+    TinyCmd_stream.running = 0;
+    TinyCmd_stream.tail = TinyCmd_stream.head;
+}
+
+//void TinyCmd_Stream_Tick(void):
+//Description:Call this function at a fixed rate, for instance in a timer interrupt.
+//            Every "decimation" calls a row of the selected variables is put into the ring buffer.
+//            When the ring buffer is full the row is dropped and counted.
+void TinyCmd_Stream_Tick(void)
+{
+    unsigned short head;
+
+    if (!TinyCmd_stream.running) {
+        return;
+    }
+    if (++TinyCmd_stream.tick < TinyCmd_stream.decimation) {
+        return;
+    }
+    TinyCmd_stream.tick = 0;
+    TinyCmd_stream.rows++;
+
+    head = TinyCmd_stream.head;
+    if ((unsigned short)(CMD_STREAM_RING_SIZE - (unsigned short)(head - TinyCmd_stream.tail)) < TinyCmd_stream.row_len) {
+        TinyCmd_stream.dropped++;
+        return;
+    }
+
+    for (TinyCmd_Counter_Type i = 0; i < TinyCmd_stream.length; i++) {
+        if (TinyCmd_stream.select & (1ul << i)) {
+            TinyCmd_stream.ring[head++ & (CMD_STREAM_RING_SIZE - 1)] = stream_sample(TinyCmd_stream.list[i]);
+        }
+    }
+    //Publish the whole row at once
+    TinyCmd_stream.head = head;
+}
+
+//void TinyCmd_Stream_Flush(void):
+//Description:Send all rows in the ring buffer. Call this function in the main loop.
+void TinyCmd_Stream_Flush(void)
+{
+    long row[CMD_VAR_LIST_SIZE];
+    TinyCmd_Counter_Type n = TinyCmd_stream.row_len;
+    unsigned short tail = TinyCmd_stream.tail;
+
+    if (!TinyCmd_stream.running) {
+        return;
+    }
+
+    //head and tail are two bytes on 8-bit parts, TinyCmd_Stream_Tick must not see half of them
+    for (;;) {
+        unsigned short head;
+        {
+            CMD_PORT_ENTER_CRITICAL();
+            head = TinyCmd_stream.head;
+            CMD_PORT_EXIT_CRITICAL();
+        }
+        if ((unsigned short)(head - tail) < n) {
+            break;
+        }
+        for (TinyCmd_Counter_Type i = 0; i < n; i++) {
+            row[i] = TinyCmd_stream.ring[tail++ & (CMD_STREAM_RING_SIZE - 1)];
+        }
+        {
+            CMD_PORT_ENTER_CRITICAL();
+            TinyCmd_stream.tail = tail;
+            CMD_PORT_EXIT_CRITICAL();
+        }
+
+        if (TinyCmd_stream.mode == TINYCMD_STREAM_BIN) {
+            stream_send_bin(row, n);
+        } else {
+            stream_send_text(row, n);
+        }
+        TinyCmd_stream.sent++;
+    }
+}
+
+//Built-in command:
+//  stream                   List the variables, "*" marks the streamed ones.
+//  stream add <name>        Add a variable to the streamed row.
+//  stream del <name>        Remove a variable from the streamed row.
+//  stream on <decim> [bin]  Start streaming, text mode unless "bin" is given.
+//  stream off               Stop streaming.
+//  stream stat              Print sampled, dropped and sent rows.
+static TinyCmd_CallBack_Ret stream_callback(void)
+{
+    const char* sub = TinyCmd_buf.arg[0];
+
+    if (sub == NULL) {
+        for (TinyCmd_Counter_Type i = 0; i < TinyCmd_stream.length; i++) {
+            TinyCmd_Var* var = TinyCmd_stream.list[i];
+            TinyCmd_Report_P(TINYCMD_PSTR("%s%s %d %f\n"), (TinyCmd_stream.select & (1ul << i)) ? "*" : " ",
+                             var->name, var->type, (double)var->scale);
+        }
+        return TINYCMD_SUCCESS;
+    }
+    if (TinyCmd_Arg_Check("add", 0) || TinyCmd_Arg_Check("del", 0)) {
+        TinyCmd_Status on = TinyCmd_Arg_Check("add", 0);
+        if (TinyCmd_buf.arg[1] == NULL || !TinyCmd_Stream_Select(TinyCmd_buf.arg[1], on)) {
+            TinyCmd_Report_P(TINYCMD_PSTR("stream: no such variable\n"));
+            return TINYCMD_FAILED;
+        }
+        return TINYCMD_SUCCESS;
+    }
+    if (TinyCmd_Arg_Check("on", 0)) {
+        unsigned char decimation = 1;
+        TinyCmd_StreamMode mode = TinyCmd_Arg_Check("bin", 2) ? TINYCMD_STREAM_BIN : TINYCMD_STREAM_TEXT;
+        if (TinyCmd_buf.arg[1] != NULL) {
+            TinyCmd_Arg_To_Num(1, &decimation, TINYCMD_UINT8);
+        }
+        if (!TinyCmd_Stream_Start(decimation, mode)) {
+            TinyCmd_Report_P(TINYCMD_PSTR("stream: nothing selected\n"));
+            return TINYCMD_FAILED;
+        }
+        return TINYCMD_SUCCESS;
+    }
+    if (TinyCmd_Arg_Check("off", 0)) {
+        TinyCmd_Stream_Stop();
+        return TINYCMD_SUCCESS;
+    }
+    if (TinyCmd_Arg_Check("stat", 0)) {
+        unsigned long rows;
+        unsigned long dropped;
+        {
+            CMD_PORT_ENTER_CRITICAL();
+            rows = TinyCmd_stream.rows;
+            dropped = TinyCmd_stream.dropped;
+            CMD_PORT_EXIT_CRITICAL();
+        }
+        TinyCmd_Report_P(TINYCMD_PSTR("rows %u dropped %u sent %u\n"), (unsigned int)rows,
+                         (unsigned int)dropped, (unsigned int)TinyCmd_stream.sent);
+        return TINYCMD_SUCCESS;
+    }
+
+    return TINYCMD_FAILED;
+}
+
+static TINYCMD_NAME(stream_name, "stream");
+TinyCmd_Command TinyCmd_Stream_Cmd = {.command = stream_name, .callback = &stream_callback};
+#endif //CMD_USE_STREAM
+
+#ifdef CMD_USE_ALIAS
+//Aliases****************************************************************//
+
+//static const char* alias_find(const char* word, TinyCmd_Counter_Type len)
+//Description:Find the alias named by the len characters of word.
+//Returns:
+//        The name of the alias in the arena, its text follows the name.
+//        NULL: No such alias.
+static const char* alias_find(const char* word, TinyCmd_Counter_Type len)
+{
+    const char* p = TinyCmd_alias.arena;
+    const char* end = TinyCmd_alias.arena + TinyCmd_alias.used;
+
+    while (p < end) {
+        TinyCmd_Counter_Type i = 0;
+        while (i < len && p[i] == word[i]) {
+            i++;
+        }
+        if (i == len && p[i] == '\0') {
+            return p;
+        }
+        //Skip the name and the text
+        p += TinyCmd_strlen(p) + 1;
+        p += TinyCmd_strlen(p) + 1;
+    }
+
+    return NULL;
+}
+
+//static TinyCmd_Counter_Type alias_size(const char* alias)
+//Description:Bytes of an alias entry in the arena.
+static TinyCmd_Counter_Type alias_size(const char* alias)
+{
+    TinyCmd_Counter_Type name = TinyCmd_strlen(alias) + 1;
+
+    return name + TinyCmd_strlen(alias + name) + 1;
+}
+
+//static void alias_delete(const char* alias)
+//Description:Remove an alias entry, the entries after it move down so the free space stays in one block.
+static void alias_delete(const char* alias)
+{
+    TinyCmd_Counter_Type from = (TinyCmd_Counter_Type)(alias - TinyCmd_alias.arena);
+    TinyCmd_Counter_Type size = alias_size(alias);
+
+    for (TinyCmd_Counter_Type i = from + size; i < TinyCmd_alias.used; i++) {
+        TinyCmd_alias.arena[i - size] = TinyCmd_alias.arena[i];
+    }
+    TinyCmd_alias.used -= size;
+}
+
+//static TinyCmd_Status alias_handler(void)
+//Description:Run the line in TinyCmd_buf.input. If its first word is an alias, every step of the alias is copied
+//            to TinyCmd_alias.line in turn and run, the rest of the line is added to the last step.
+//            TinyCmd_buf.input is only read, the lines queued after it and TinyCmd_buf.length stay as they are.
+//            The steps are run as commands, an alias in a step is not expanded.
+//            The steps stop at the first one whose command is not found.
+//Returns:
+//        TINYCMD_SUCCESS: The command or all steps are found and run.
+//        TINYCMD_FAILED: A command is not found, or a step and the rest of the line don't fit into the buffer.
+static TinyCmd_Status alias_handler(void)
+{
+    const char* input = TinyCmd_buf.input;
+    char* line = TinyCmd_alias.line;
+    TinyCmd_Counter_Type start = 0;
+    TinyCmd_Counter_Type end;
+    TinyCmd_Counter_Type rest_len;
+    const char* step;
+    TinyCmd_Status ret = TINYCMD_SUCCESS;
+
+    while (input[start] == ' ') {
+        start++;
+    }
+    end = start;
+    while (input[end] != ' ' && input[end] != '\0') {
+        end++;
+    }
+    step = (end > start) ? alias_find(input + start, end - start) : NULL;
+    if (step == NULL) {
+        return TinyCmd_Run(TinyCmd_buf.input, NULL);
+    }
+    step += end - start + 1;
+
+    //Check every step fits with the rest of the line
+    rest_len = TinyCmd_strlen(input + end);
+    for (const char* p = step; ; p++) {
+        const char* s = p;
+        while (*p != ';' && *p != '\0') {
+            p++;
+        }
+        if ((unsigned long)(p - s) + rest_len >= CMD_ALIAS_LINE_SIZE - 1) {
+            TinyCmd_Report_P(TINYCMD_PSTR("alias: line too long\n"));
+            return TINYCMD_FAILED;
+        }
+        if (*p == '\0') {
+            break;
+        }
+    }
+
+    TinyCmd_alias.expanded++;
+    TinyCmd_alias.running = 1;
+
+    while (ret == TINYCMD_SUCCESS) {
+        TinyCmd_Counter_Type len = 0;
+        TinyCmd_Status last;
+
+        while (*step == ' ') {
+            step++;
+        }
+        while (step[len] != ';' && step[len] != '\0') {
+            line[len] = step[len];
+            len++;
+        }
+        last = (step[len] == '\0');
+        step += len;
+        if (last) {
+            //The rest keeps its leading space
+            for (TinyCmd_Counter_Type i = 0; i < rest_len; i++) {
+                line[len++] = input[end + i];
+            }
+        }
+        line[len] = '\0';
+        TinyCmd_alias.copied += len;
+
+        TinyCmd_Arg_Clear();
+        ret = TinyCmd_Run(line, NULL);
+        if (last) {
+            break;
+        }
+        step++;
+    }
+    TinyCmd_alias.running = 0;
+
+    return ret;
+}
+
+//Built-in command:
+//  alias                    List the aliases, the arena and the expansion cost.
+//  alias <name>             Delete an alias.
+//  alias <name> <text>      Define an alias, steps of a macro are separated by ';'.
+static TinyCmd_CallBack_Ret alias_callback(void)
+{
+    const char* name = TinyCmd_buf.arg[0];
+    const char* text = TinyCmd_buf.arg[1];
+    const char* old;
+    TinyCmd_Counter_Type name_len;
+    TinyCmd_Counter_Type text_len = 0;
+    TinyCmd_Counter_Type free_bytes;
+    TinyCmd_Counter_Type i;
+
+    if (name == NULL) {
+        for (const char* p = TinyCmd_alias.arena; p < TinyCmd_alias.arena + TinyCmd_alias.used; p += alias_size(p)) {
+            TinyCmd_Report_P(TINYCMD_PSTR("%s: %s\n"), p, p + TinyCmd_strlen(p) + 1);
+        }
+        TinyCmd_Report_P(TINYCMD_PSTR("arena %u/%u bytes, expanded %u, copied %u bytes\n"),
+                         (unsigned int)TinyCmd_alias.used, (unsigned int)CMD_ALIAS_ARENA_SIZE,
+                         (unsigned int)TinyCmd_alias.expanded, (unsigned int)TinyCmd_alias.copied);
+        return TINYCMD_SUCCESS;
+    }
+
+    if (TinyCmd_alias.running) {
+        TinyCmd_Report_P(TINYCMD_PSTR("alias: busy\n"));
+        return TINYCMD_FAILED;
+    }
+    name_len = TinyCmd_strlen(name);
+    old = alias_find(name, name_len);
+    if (text == NULL) {
+        if (old == NULL) {
+            return TINYCMD_FAILED;
+        }
+        alias_delete(old);
+        return TINYCMD_SUCCESS;
+    }
+    //An alias never hides a command
+    if (TinyCmd_Find_Cmd(name) != NULL || TinyCmd_strchr(name, ';') != NULL) {
+        TinyCmd_Report_P(TINYCMD_PSTR("alias: bad name\n"));
+        return TINYCMD_FAILED;
+    }
+
+    //The text is the arguments after the name and the rest of the line joined by spaces,
+    //the arguments may come from a compiled script
+    for (i = 1; i < CMD_MAX_PARAMS && TinyCmd_buf.arg[i] != NULL; i++) {
+        text_len += TinyCmd_strlen(TinyCmd_buf.arg[i]) + 1;
+    }
+    if (TinyCmd_alias_rest != NULL) {
+        text_len += TinyCmd_strlen(TinyCmd_alias_rest) + 1;
+    }
+    text_len--;
+    free_bytes = CMD_ALIAS_ARENA_SIZE - TinyCmd_alias.used + (old != NULL ? alias_size(old) : 0);
+    if (name_len + text_len + 2 > free_bytes) {
+        TinyCmd_Report_P(TINYCMD_PSTR("alias: arena full\n"));
+        return TINYCMD_FAILED;
+    }
+    if (old != NULL) {
+        alias_delete(old);
+    }
+
+    char* p = TinyCmd_alias.arena + TinyCmd_alias.used;
+    TinyCmd_strcpy(p, name);
+    p += name_len + 1;
+    for (i = 1; i < CMD_MAX_PARAMS && TinyCmd_buf.arg[i] != NULL; i++) {
+        if (i > 1) {
+            *p++ = ' ';
+        }
+        TinyCmd_strcpy(p, TinyCmd_buf.arg[i]);
+        p += TinyCmd_strlen(p);
+    }
+    if (TinyCmd_alias_rest != NULL) {
+        *p++ = ' ';
+        TinyCmd_strcpy(p, TinyCmd_alias_rest);
+    }
+    TinyCmd_alias.used += name_len + text_len + 2;
+
+    return TINYCMD_SUCCESS;
+}
+
+static TINYCMD_NAME(alias_name, "alias");
+TinyCmd_Command TinyCmd_Alias_Cmd = {.command = alias_name, .callback = &alias_callback};
+#endif //CMD_USE_ALIAS
+
+#ifdef CMD_USE_SCRIPT
+//Script****************************************************************//
+
+//static TinyCmd_Status script_line(char* line, char* end, unsigned long number)
+//Description:Run the line of a script from line to end, end is the '\n' or the end of the line.
+//            The line is ended by a '\0' while it runs, then the '\0' written by the tokenizer are turned
+//            back into spaces and the byte at end is put back, so the script can be run again.
+//Returns:
+//        TINYCMD_SUCCESS: The line is empty or a comment, or its command is found and its callback succeeded.
+//        TINYCMD_FAILED: The command is not found or its callback failed.
+static TinyCmd_Status script_line(char* line, char* end, unsigned long number)
+{
+    char* stop = end;
+    char saved;
+    TinyCmd_CallBack_Ret result = TINYCMD_FAILED;
+    TinyCmd_Status found;
+
+    while (line < stop && *line == ' ') {
+        line++;
+    }
+    while (stop > line && (stop[-1] == ' ' || stop[-1] == '\r')) {
+        stop--;
+    }
+    if (line == stop || *line == '#') {
+        return TINYCMD_SUCCESS;
+    }
+
+    saved = *stop;
+    *stop = '\0';
+    TinyCmd_Arg_Clear();
+    found = TinyCmd_Run(line, &result);
+    //Leave no pointer into the script, the next line of TinyCmd_Handler() expects the unused arguments to be NULL
+    TinyCmd_Arg_Clear();
+    for (char* p = line; p < stop; p++) {
+        if (*p == '\0') {
+            *p = ' ';
+        }
+    }
+    *stop = saved;
+
+    if (!found || !result) {
+        TinyCmd_Report_P(TINYCMD_PSTR("script: line %u failed\n"), (unsigned int)number);
+        return TINYCMD_FAILED;
+    }
+    return TINYCMD_SUCCESS;
+}
+
+//static TinyCmd_Status script_copy(const char* line, unsigned long len, TinyCmd_Status flash, unsigned long number)
+//Description:Copy a line of a script that can't be written to TinyCmd_script_copy and run it there,
+//            flash is TINYCMD_SUCCESS if the script is in flash. TinyCmd_buf.input is not used: it holds the line
+//            running the script and the lines queued after it. The copy stays taken while the line runs,
+//            a script run by its callback copies its lines after it.
+static TinyCmd_Status script_copy(const char* line, unsigned long len, TinyCmd_Status flash, unsigned long number)
+{
+    char* copy = TinyCmd_script_copy + TinyCmd_script_used;
+    TinyCmd_Status ret;
+
+    (void)flash; //Only read through FMT_CHAR with CMD_USE_PROGMEM
+    if (len > (unsigned long)(CMD_SCRIPT_LINE_SIZE - 1 - TinyCmd_script_used)) {
+        TinyCmd_Report_P(TINYCMD_PSTR("script: line %u too long\n"), (unsigned int)number);
+        return TINYCMD_FAILED;
+    }
+    for (TinyCmd_Counter_Type i = 0; i < len; i++) {
+        copy[i] = FMT_CHAR(line + i, flash);
+    }
+
+    TinyCmd_script_used += (TinyCmd_Counter_Type)(len + 1);
+    ret = script_line(copy, copy + len, number);
+    TinyCmd_script_used -= (TinyCmd_Counter_Type)(len + 1);
+    return ret;
+}
+
+//TinyCmd_Status TinyCmd_Script_Run(char* script, unsigned long len, TinyCmd_Status stop):
+//Description:Run the lines of a script in RAM or in a private file mapping. Each line is tokenized in place,
+//            TinyCmd_buf.arg points into the script while its callback runs, and the script is the same
+//            again afterwards. A last line without '\n' is copied like a line of TinyCmd_Script_Run_P()
+//            as there is no room for its '\0'. Aliases are not expanded. It may be called from a callback, whose
+//            arguments are back when the script ends.
+//args:
+//        script: The script, lines end with '\n' or "\r\n".
+//        len: Length of the script in bytes.
+//        stop: TINYCMD_SUCCESS to stop at the first line that fails, TINYCMD_FAILED to run all lines.
+//Returns:
+//        TINYCMD_SUCCESS: All lines succeeded.
+//        TINYCMD_FAILED: A command is not found or its callback failed, the line is reported.
+TinyCmd_Status TinyCmd_Script_Run(char* script, unsigned long len, TinyCmd_Status stop)
+{
+    char* end = script + len;
+    unsigned long number = 0;
+    TinyCmd_Status ret = TINYCMD_SUCCESS;
+    char* saved[CMD_MAX_PARAMS];
+
+    //Arguments of the callback running the script
+    for (TinyCmd_Counter_Type n = 0; n < CMD_MAX_PARAMS; n++) {
+        saved[n] = TinyCmd_buf.arg[n];
+    }
+    while (script < end) {
+        char* eol = script;
+        TinyCmd_Status ok;
+
+        while (eol < end && *eol != '\n') {
+            eol++;
+        }
+        number++;
+        if (eol < end) {
+            ok = script_line(script, eol, number);
+        } else {
+            ok = script_copy(script, (unsigned long)(eol - script), TINYCMD_FAILED, number);
+        }
+        if (!ok) {
+            ret = TINYCMD_FAILED;
+            if (stop) {
+                break;
+            }
+        }
+        script = eol + 1;
+    }
+    for (TinyCmd_Counter_Type n = 0; n < CMD_MAX_PARAMS; n++) {
+        TinyCmd_buf.arg[n] = saved[n];
+    }
+
+    return ret;
+}
+
+//TinyCmd_Status TinyCmd_Script_Run_P(const char* script, unsigned long len, TinyCmd_Status stop):
+//Description:Same as TinyCmd_Script_Run() for a script that can't be written, such as a flash page.
+//            Each line is copied to a static buffer, so it must be shorter than CMD_SCRIPT_LINE_SIZE.
+//            With CMD_USE_PROGMEM the script is read from flash on AVR (TINYCMD_FLASH).
+TinyCmd_Status TinyCmd_Script_Run_P(const char* script, unsigned long len, TinyCmd_Status stop)
+{
+    const char* end = script + len;
+    unsigned long number = 0;
+    TinyCmd_Status ret = TINYCMD_SUCCESS;
+    char* saved[CMD_MAX_PARAMS];
+
+    //Arguments of the callback running the script
+    for (TinyCmd_Counter_Type n = 0; n < CMD_MAX_PARAMS; n++) {
+        saved[n] = TinyCmd_buf.arg[n];
+    }
+    while (script < end) {
+        const char* eol = script;
+
+        while (eol < end && FMT_CHAR(eol, TINYCMD_SUCCESS) != '\n') {
+            eol++;
+        }
+        number++;
+        if (!script_copy(script, (unsigned long)(eol - script), TINYCMD_SUCCESS, number)) {
+            ret = TINYCMD_FAILED;
+            if (stop) {
+                break;
+            }
+        }
+        script = eol + 1;
+    }
+    for (TinyCmd_Counter_Type n = 0; n < CMD_MAX_PARAMS; n++) {
+        TinyCmd_buf.arg[n] = saved[n];
+    }
+
+    return ret;
+}
+
+//static const unsigned char* compiled_skip(const unsigned char* p, const unsigned char* end)
+//Description:Check the argument at p lies in the image.
+//Returns:
+//        The next argument, NULL if the argument is broken.
+static const unsigned char* compiled_skip(const unsigned char* p, const unsigned char* end)
+{
+    if (end - p < 3 || end - p - 3 < p[1] || COMPILED_NUM(p)[-1] != '\0' || COMPILED_BYTES(p[0]) > 8 ||
+        end - p < COMPILED_SIZE(p)) {
+        return NULL;
+    }
+
+    return p + COMPILED_SIZE(p);
+}
+
+//TinyCmd_Status TinyCmd_Compiled_Load(TinyCmd_Compiled* script, const void* image, unsigned long len,
+//                                     const TinyCmd_Command** cmds, TinyCmd_Counter_Type size):
+//Description:Check a script compiled by tools/TinyCmd_Compile.py and look its command names up once,
+//            so TinyCmd_Compiled_Run() neither tokenizes, looks commands up nor parses numbers.
+//args:
+//        script: The loaded script.
+//        image: The compiled script in RAM or in memory mapped flash, it is used in place while the script is loaded.
+//        len: Length of the image in bytes.
+//        cmds: Array of size entries for the commands of the script.
+//Returns:
+//        TINYCMD_SUCCESS: The script is loaded.
+//        TINYCMD_FAILED: The image is broken, a command is not found (it is reported) or cmds is too small.
+TinyCmd_Status TinyCmd_Compiled_Load(TinyCmd_Compiled* script, const void* image, unsigned long len,
+                                     const TinyCmd_Command** cmds, TinyCmd_Counter_Type size)
+{
+    const unsigned char* p = (const unsigned char*)image;
+    const unsigned char* end = p + len;
+    TinyCmd_Counter_Type count;
+
+    if (sizeof(double) != 8 || len < 5 || p[0] != 'T' || p[1] != 'C' || p[2] != 'S' ||
+        p[3] != COMPILED_VERSION || p[4] > size) {
+        return TINYCMD_FAILED;
+    }
+    count = p[4];
+    p += 5;
+
+    for (TinyCmd_Counter_Type i = 0; i < count; i++) {
+        const unsigned char* name = p;
+        while (p < end && *p != '\0') {
+            p++;
         }
-        case TINYCMD_UINT32: {
-            unsigned long long result;
-            TinyCmd_Status status = str_to_uint(str, &result, &sign);
-            if (status != TINYCMD_SUCCESS) {
+        if (p == end) {
+            return TINYCMD_FAILED;
+        }
+        p++;
+        cmds[i] = TinyCmd_Find_Cmd((const char*)name);
+        if (cmds[i] == NULL) {
+            TinyCmd_Report_P(TINYCMD_PSTR("script: no command %s\n"), (const char*)name);
+            return TINYCMD_FAILED;
+        }
+    }
+    script->lines = p;
+
+    //Check every line once, so running it needs no check
+    while (p < end) {
+        TinyCmd_Counter_Type argc;
+        if (end - p < 2 || p[0] >= count) {
+            return TINYCMD_FAILED;
+        }
+        argc = p[1];
+        if (argc > CMD_MAX_PARAMS) {
+            return TINYCMD_FAILED;
+        }
+        p += 2;
+        for (TinyCmd_Counter_Type i = 0; i < argc; i++) {
+            p = compiled_skip(p, end);
+            if (p == NULL) {
                 return TINYCMD_FAILED;
             }
-            #if CMD_NAME_LENGTH > 9
-            if (result > UINT32_MAX) {
-                *(unsigned int*)out_val = UINT32_MAX;
-            } else {
-                *(unsigned int*)out_val = (unsigned int)result;
-            }
-            #else
-            *(unsigned int*)out_val = (unsigned int)result;
-            #endif
-            break;
         }
-        case TINYCMD_INT32: {
-            long long result;
-            TinyCmd_Status status = str_to_int(str, &result, &sign);
-            if (status != TINYCMD_SUCCESS) {
-                return TINYCMD_FAILED;
+    }
+
+    script->end = end;
+    script->cmds = cmds;
+    return TINYCMD_SUCCESS;
+}
+
+//TinyCmd_Status TinyCmd_Compiled_Run(const TinyCmd_Compiled* script, TinyCmd_Status stop):
+//Description:Run a script loaded by TinyCmd_Compiled_Load(). The callbacks are the same: TinyCmd_buf.arg points to
+//            the argument strings in the image, and TinyCmd_Arg_To_Num() reads the numbers parsed by the compiler.
+//            Only the subcommands are looked up while it runs.
+//args:
+//        stop: TINYCMD_SUCCESS to stop at the first line that fails, TINYCMD_FAILED to run all lines.
+//Returns:
+//        TINYCMD_SUCCESS: All lines succeeded.
+//        TINYCMD_FAILED: A subcommand is not found or a callback failed, the line is reported.
+TinyCmd_Status TinyCmd_Compiled_Run(const TinyCmd_Compiled* script, TinyCmd_Status stop)
+{
+    const unsigned char* p = script->lines;
+    unsigned long number = 0;
+    TinyCmd_Status ret = TINYCMD_SUCCESS;
+
+    while (p < script->end) {
+        const TinyCmd_Command* cmd = script->cmds[p[0]];
+        TinyCmd_Counter_Type argc = p[1];
+        TinyCmd_CallBack_Ret result = TINYCMD_FAILED;
+
+        number++;
+        p += 2;
+        TinyCmd_Arg_Clear();
+        for (TinyCmd_Counter_Type i = 0; i < argc; i++) {
+            TinyCmd_buf.arg[i] = (char*)(p + 2);
+            TinyCmd_compiled_num[i] = p;
+            p += COMPILED_SIZE(p);
+        }
+
+#ifdef CMD_USE_SUB
+        //Walk down the subcommands like TinyCmd_Run()
+        while (cmd != NULL && cmd->sub_count > 0 && argc > 0) {
+            const TinyCmd_Command* sub = TinyCmd_Find_In(cmd->sub, cmd->sub_count, TinyCmd_buf.arg[0]);
+            if (sub == NULL) {
+                break;
             }
-            if (result > INT32_MAX) {
-                *(int*)out_val = INT32_MAX;
-            } else if (result < INT32_MIN) {
-                *(int*)out_val = INT32_MIN;
-            } else {
-                *(int*)out_val = (int)result;
+            for (TinyCmd_Counter_Type j = 1; j < argc; j++) {
+                TinyCmd_buf.arg[j - 1] = TinyCmd_buf.arg[j];
+                TinyCmd_compiled_num[j - 1] = TinyCmd_compiled_num[j];
             }
-            break;
+            TinyCmd_buf.arg[--argc] = NULL;
+            cmd = sub;
         }
-        //when CMD_NAME_LENGTH > 9 a more bigger type is needed
-        #if CMD_NAME_LENGTH > 9
-        case TINYCMD_UINT64: {
-            unsigned long long result;
-            TinyCmd_Status status = str_to_uint(str, &result, &sign);
-            if (status != TINYCMD_SUCCESS) {
-                return TINYCMD_FAILED;
-            }
-            *(unsigned long long*)out_val = (unsigned long long)result;
-            break;
+#endif //CMD_USE_SUB
+        if (cmd->callback != NULL) {
+            result = CMD_CALL(cmd, argc);
         }
-        case TINYCMD_INT64: {
-            long long result;
-            TinyCmd_Status status = str_to_int(str, &result, &sign);
-            if (status != TINYCMD_SUCCESS) {
-                return TINYCMD_FAILED;
+        for (TinyCmd_Counter_Type i = 0; i < argc; i++) {
+            TinyCmd_compiled_num[i] = NULL;
+        }
+        TinyCmd_Arg_Clear();
+
+        if (!result) {
+            TinyCmd_Report_P(TINYCMD_PSTR("script: line %u failed\n"), (unsigned int)number);
+            ret = TINYCMD_FAILED;
+            if (stop) {
+                break;
             }
-            *(long long*)out_val = (long long)result;
+        }
+    }
+    TinyCmd_Arg_Clear();
+
+    return ret;
+}
+#endif //CMD_USE_SCRIPT
+
+#ifdef CMD_USE_CACHE
+//Response cache****************************************************************//
+
+//static void cache_capture(const char* buf, unsigned long len)
+//Description:Copy output of the running command to its slot. Once it doesn't fit, the response is not kept.
+static void cache_capture(const char* buf, unsigned long len)
+{
+    TinyCmd_Cache_Slot* slot = TinyCmd_cache.capture;
+
+    if (!TinyCmd_cache.keep) {
+        return;
+    }
+    if (len > (unsigned long)(CMD_CACHE_SLOT_SIZE - slot->len)) {
+        TinyCmd_cache.keep = 0;
+        TinyCmd_cache.big++;
+        return;
+    }
+    for (unsigned long i = 0; i < len; i++) {
+        slot->data[slot->len++] = buf[i];
+    }
+}
+
+//static TinyCmd_Cache_Slot* cache_find(const TinyCmd_Command* cmd, TinyCmd_Counter_Type argc)
+//Description:Find the response of cmd kept for the argc arguments in TinyCmd_buf.arg.
+//Returns:
+//        The slot of the response.
+//        NULL: No response is kept.
+static TinyCmd_Cache_Slot* cache_find(const TinyCmd_Command* cmd, TinyCmd_Counter_Type argc)
+{
+    for (TinyCmd_Counter_Type n = 0; n < CMD_CACHE_SLOTS; n++) {
+        TinyCmd_Cache_Slot* slot = &TinyCmd_cache.slot[n];
+        const char* key = slot->data;
+        const char* end = slot->data + slot->key;
+        TinyCmd_Counter_Type i = 0;
+
+        if (slot->cmd != cmd) {
+            continue;
+        }
+        while (i < argc && key < end && TinyCmd_strcmp(key, TinyCmd_buf.arg[i]) == 0) {
+            key += TinyCmd_strlen(key) + 1;
+            i++;
+        }
+        if (i == argc && key == end) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+//static TinyCmd_CallBack_Ret cache_call(const TinyCmd_Command* cmd, TinyCmd_Counter_Type argc)
+//Description:Run the callback of cmd with the argc arguments in TinyCmd_buf.arg. If cmd has a cache_ms and the
+//            response to the same arguments is kept and not older than cache_ms, it is sent again instead.
+//            Otherwise the output of the callback is copied to a free or the least recently used slot.
+//Returns:
+//        The return value of the callback, kept with the response.
+static TinyCmd_CallBack_Ret cache_call(const TinyCmd_Command* cmd, TinyCmd_Counter_Type argc)
+{
+    TinyCmd_Cache_Slot* slot;
+    TinyCmd_CallBack_Ret ret;
+
+    if (cmd->cache_ms == 0) {
+        return cmd->callback();
+    }
+
+    TinyCmd_cache.lookups++;
+    slot = cache_find(cmd, argc);
+    if (slot != NULL) {
+        if (cmd->cache_ms == TINYCMD_CACHE_KEEP || CMD_MILLIS() - slot->stamp < cmd->cache_ms) {
+            TinyCmd_cache.hits++;
+            slot->used = TinyCmd_cache.lookups;
+            send_bytes(slot->data + slot->key, slot->len - slot->key);
+            return slot->ret;
+        }
+        slot->cmd = NULL;
+    }
+    TinyCmd_cache.misses++;
+
+    //A command run by the callback of a kept command is already part of that response
+    if (TinyCmd_cache.capture != NULL) {
+        return cmd->callback();
+    }
+
+    slot = &TinyCmd_cache.slot[0];
+    for (TinyCmd_Counter_Type n = 1; n < CMD_CACHE_SLOTS && slot->cmd != NULL; n++) {
+        if (TinyCmd_cache.slot[n].cmd == NULL || TinyCmd_cache.slot[n].used < slot->used) {
+            slot = &TinyCmd_cache.slot[n];
+        }
+    }
+    slot->cmd = NULL;
+    slot->len = 0;
+    slot->stamp = CMD_MILLIS();
+    TinyCmd_cache.keep = 1;
+    TinyCmd_cache.capture = slot;
+    //The arguments are the key, the output of the callback follows them
+    for (TinyCmd_Counter_Type i = 0; i < argc; i++) {
+        cache_capture(TinyCmd_buf.arg[i], TinyCmd_strlen(TinyCmd_buf.arg[i]) + 1);
+    }
+    slot->key = slot->len;
+
+    ret = cmd->callback();
+
+    TinyCmd_cache.capture = NULL;
+    if (TinyCmd_cache.keep && ret != TINYCMD_FAILED) {
+        slot->cmd = cmd;
+        slot->used = TinyCmd_cache.lookups;
+        slot->ret = ret;
+    }
+
+    return ret;
+}
+
+//void TinyCmd_Cache_Clear(const TinyCmd_Command* cmd):
+//Description:Drop the kept responses of a command, call it when the data it reports changes
+//            (e.g. in the callback of "config set" for "config get").
+//args:
+//        cmd: The command, NULL drops all responses.
+void TinyCmd_Cache_Clear(const TinyCmd_Command* cmd)
+{
+    for (TinyCmd_Counter_Type n = 0; n < CMD_CACHE_SLOTS; n++) {
+        if (cmd == NULL || TinyCmd_cache.slot[n].cmd == cmd) {
+            TinyCmd_cache.slot[n].cmd = NULL;
+        }
+    }
+    //The response being kept may be older than the change
+    TinyCmd_cache.keep = 0;
+}
+
+//Built-in command:
+//  cache          Print the hits, the misses, the responses too big to keep and the slots in use.
+//  cache clear    Drop all responses.
+static TinyCmd_CallBack_Ret cache_callback(void)
+{
+    TinyCmd_Counter_Type used = 0;
+
+    if (TinyCmd_buf.arg[0] != NULL) {
+        if (!TinyCmd_Arg_Check("clear", 0)) {
+            return TINYCMD_FAILED;
+        }
+        TinyCmd_Cache_Clear(NULL);
+        return TINYCMD_SUCCESS;
+    }
+
+    for (TinyCmd_Counter_Type n = 0; n < CMD_CACHE_SLOTS; n++) {
+        used += (TinyCmd_cache.slot[n].cmd != NULL);
+    }
+    TinyCmd_Report_P(TINYCMD_PSTR("hits %u misses %u big %u slots %u/%u\n"), (unsigned int)TinyCmd_cache.hits,
+                     (unsigned int)TinyCmd_cache.misses, (unsigned int)TinyCmd_cache.big,
+                     (unsigned int)used, (unsigned int)CMD_CACHE_SLOTS);
+    return TINYCMD_SUCCESS;
+}
+
+static TINYCMD_NAME(cache_name, "cache");
+TinyCmd_Command TinyCmd_Cache_Cmd = {.command = cache_name, .callback = &cache_callback};
+#endif //CMD_USE_CACHE
+
+#ifdef CMD_USE_PRIORITY
+//Priority commands****************************************************************//
+
+//static TinyCmd_Status prio_run(char* line, char* end)
+//Description:Run the line from line to end at once if it names an urgent command and has at most CMD_URGENT_TOKENS
+//            words. All arguments of the command the main loop may be running are kept and given back after it.
+//Returns:
+//        TINYCMD_SUCCESS: The command is urgent and has run.
+//        TINYCMD_FAILED: It is not, the line is left as it was.
+static TinyCmd_Status prio_run(char* line, char* end)
+{
+    char* token[CMD_URGENT_TOKENS];
+    //All arguments of the main loop's command, those the urgent command doesn't get are NULL while it runs
+    char* saved[CMD_MAX_PARAMS];
+    TinyCmd_Counter_Type count = 0;
+    TinyCmd_Counter_Type i = 1;
+    char last = *end;
+    char* p = line;
+    const TinyCmd_Command* cmd = NULL;
+
+    //Split the words, the spaces after them are put back if the line is not urgent
+    *end = '\0';
+    while (p < end) {
+        if (*p == ' ') {
+            p++;
+            continue;
+        }
+        if (count == CMD_URGENT_TOKENS) {
+            count = 0;
             break;
         }
-        #endif //CMD_NAME_LENGTH > 9
-        case TINYCMD_FLOAT: {
-            double result;
-            TinyCmd_Status status = str_to_float(str, &result);
-            if (status != TINYCMD_SUCCESS) {
-                return TINYCMD_FAILED;
-            }
-                *(float*)out_val = (float)result;
+        token[count++] = p;
+        while (p < end && *p != ' ') {
+            p++;
+        }
+        if (p < end) {
+            *p++ = '\0';
+        }
+    }
+
+    if (count > 0) {
+        cmd = TinyCmd_Find_Cmd(token[0]);
+    }
+#ifdef CMD_USE_SUB
+    while (cmd != NULL && cmd->sub_count > 0 && i < count) {
+        const TinyCmd_Command* sub = TinyCmd_Find_In(cmd->sub, cmd->sub_count, token[i]);
+        if (sub == NULL) {
             break;
         }
-        case TINYCMD_DOUBLE: {
-            double result;
-            TinyCmd_Status status = str_to_float(str, &result);
-            if (status != TINYCMD_SUCCESS) {
-                return TINYCMD_FAILED;
+        cmd = sub;
+        i++;
+    }
+#endif //CMD_USE_SUB
+    if (cmd == NULL || cmd->callback == NULL || cmd->priority == TINYCMD_PRIORITY_NORMAL) {
+        for (p = line; p < end; p++) {
+            if (*p == '\0') {
+                *p = ' ';
             }
-                *(double*)out_val = result;
-            break;
         }
-        default:
+        *end = last;
+        return TINYCMD_FAILED;
+    }
+
+    {
+#ifdef CMD_USE_SCRIPT
+        const unsigned char* saved_num[CMD_MAX_PARAMS];
+#endif //CMD_USE_SCRIPT
+#ifdef CMD_USE_CACHE
+        //The output is not part of a response the main loop is keeping
+        TinyCmd_Cache_Slot* capture = TinyCmd_cache.capture;
+        TinyCmd_cache.capture = NULL;
+#endif //CMD_USE_CACHE
+#ifdef CMD_USE_ALIAS
+        const char* saved_rest = TinyCmd_alias_rest;
+        TinyCmd_alias_rest = NULL;
+#endif //CMD_USE_ALIAS
+        for (TinyCmd_Counter_Type n = 0; n < CMD_MAX_PARAMS; n++) {
+            saved[n] = TinyCmd_buf.arg[n];
+            TinyCmd_buf.arg[n] = (i + n < count) ? token[i + n] : NULL;
+#ifdef CMD_USE_SCRIPT
+            saved_num[n] = TinyCmd_compiled_num[n];
+            TinyCmd_compiled_num[n] = NULL;
+#endif //CMD_USE_SCRIPT
+        }
+
+        TinyCmd_prio.urgent = 1;
+        cmd->callback();
+        TinyCmd_prio.urgent = 0;
+
+        for (TinyCmd_Counter_Type n = 0; n < CMD_MAX_PARAMS; n++) {
+            TinyCmd_buf.arg[n] = saved[n];
+#ifdef CMD_USE_SCRIPT
+            TinyCmd_compiled_num[n] = saved_num[n];
+#endif //CMD_USE_SCRIPT
+        }
+#ifdef CMD_USE_ALIAS
+        TinyCmd_alias_rest = saved_rest;
+#endif //CMD_USE_ALIAS
+#ifdef CMD_USE_CACHE
+        TinyCmd_cache.capture = capture;
+#endif //CMD_USE_CACHE
+    }
+
+    return TINYCMD_SUCCESS;
+}
+#endif //CMD_USE_PRIORITY
+
+#ifdef CMD_LINE_QUEUE
+//Line queue****************************************************************//
+
+#ifndef CMD_USE_LINE_EDIT
+//static TinyCmd_Status queue_char(char c)
+//Description:TinyCmd_PutChar() of the plain input: put c after the lines waiting for the main loop.
+//            A line not fitting in TinyCmd_buf.input is skipped up to its end of line. It is dropped if lines wait
+//            before it, otherwise it is longer than the buffer and CMD_OVERLONG_POLICY tells what is done.
+//Returns:
+//        TINYCMD_SUCCESS: A line is complete.
+//        TINYCMD_FAILED: The line is not complete yet, or it is dropped.
+static TinyCmd_Status queue_char(char c)
+{
+    TinyCmd_Status line = (c == '\n' || c == '\r') ? TINYCMD_SUCCESS : TINYCMD_FAILED;
+
+    if (TinyCmd_queue.skip != QUEUE_TAKE) {
+        if (line && TinyCmd_queue.skip == QUEUE_DROP) {
+            TinyCmd_queue.skip = QUEUE_TAKE;
             return TINYCMD_FAILED;
+        }
+        if (line) {
+            TinyCmd_queue.skip = QUEUE_TAKE;
+        }
+        return line;
+    }
+    if (TinyCmd_buf.length < CMD_BUF_SIZE - 1) {
+        TinyCmd_buf.input[TinyCmd_buf.length++] = c;
+        return line;
+    }
+    if (line && TinyCmd_queue.start == 0) {
+        //The line fills the buffer alone, the last byte stays '\0' for its end
+        return TINYCMD_SUCCESS;
+    }
+    if (line && TinyCmd_queue.start == TinyCmd_buf.length) {
+        //Empty line
+        return TINYCMD_FAILED;
     }
 
-    if (str[0] == '\0' || (str[0] == '-' && str[1] == '\0')) {
+    //No room for the line
+    if (TinyCmd_queue.start == 0 && CMD_OVERLONG_POLICY == TINYCMD_OVERLONG_TRUNCATE) {
+        TinyCmd_queue.skip = QUEUE_CUT;
+    } else {
+        for (TinyCmd_Counter_Type i = TinyCmd_queue.start; i < TinyCmd_buf.length; i++) {
+            TinyCmd_buf.input[i] = '\0';
+        }
+        TinyCmd_buf.length = TinyCmd_queue.start;
+        TinyCmd_queue.skip = line ? QUEUE_TAKE : QUEUE_DROP;
+    }
+#ifdef CMD_USE_FLOW
+    if (TinyCmd_queue.start == 0) {
+        TinyCmd_flow.overlong++;
+    } else {
+        TinyCmd_flow.dropped++;
+    }
+#endif //CMD_USE_FLOW
+    return TINYCMD_FAILED;
+}
+#endif //CMD_USE_LINE_EDIT
+
+//static TinyCmd_Status queue_put(void)
+//Description:A line is complete in TinyCmd_buf.input. Run it if it is urgent, otherwise leave it to the main loop
+//            and receive the next line after it. An urgent or empty line is removed.
+//Returns:
+//        TINYCMD_SUCCESS: The line is left to the main loop.
+//        TINYCMD_FAILED: The line is urgent and has run, or it is empty.
+static TinyCmd_Status queue_put(void)
+{
+    char* line = TinyCmd_buf.input + TinyCmd_queue.start;
+    char* end = TinyCmd_buf.input + TinyCmd_buf.length;
+    char* p = line;
+
+    if (end > line && (end[-1] == '\n' || end[-1] == '\r')) {
+        end--;
+    }
+    while (p < end && *p == ' ') {
+        p++;
+    }
+#ifdef CMD_USE_PRIORITY
+    if (p == end || prio_run(line, end)) {
+#else
+    if (p == end) {
+#endif //CMD_USE_PRIORITY
+        for (p = line; p < TinyCmd_buf.input + TinyCmd_buf.length; p++) {
+            *p = '\0';
+        }
+        TinyCmd_buf.length = TinyCmd_queue.start;
+#ifdef CMD_USE_LINE_EDIT
+        TinyCmd_edit.pending = 0;
+#endif //CMD_USE_LINE_EDIT
         return TINYCMD_FAILED;
     }
 
+#ifndef CMD_USE_LINE_EDIT
+    //The line editor edits the whole buffer, only the plain input receives a line while the main loop runs one
+    if (TinyCmd_queue.end == 0) {
+        TinyCmd_queue.end = TinyCmd_buf.length;
+    }
+    TinyCmd_queue.start = TinyCmd_buf.length;
+#endif //CMD_USE_LINE_EDIT
     return TINYCMD_SUCCESS;
 }
 
-//TinyCmd_Status TinyCmd_Report(const char* format,...)
-//Description:A printf-like function print the formatted string to somewhere user designated.
-TinyCmd_Status TinyCmd_Report(const char* format, ...)
+//static void queue_keep(void)
+//Description:Clear the line run by the main loop. The lines received meanwhile move to the start of TinyCmd_buf.input,
+//            the first complete one is run by the next TinyCmd_Handler() call.
+static void queue_keep(void)
 {
-    va_list args;
-    va_start(args, format);
+    CMD_PORT_ENTER_CRITICAL();
+    TinyCmd_Counter_Type from = TinyCmd_queue.end;
+    TinyCmd_Counter_Type length = TinyCmd_buf.length;
+    TinyCmd_Counter_Type i;
 
-    char buffer[CMD_RPT_BUF_SIZE];
-    TinyCmd_Counter_Type pos = 0;
-    TinyCmd_Counter_Type max_len = sizeof(buffer);
+    for (i = 0; i < length - from; i++) {
+        TinyCmd_buf.input[i] = TinyCmd_buf.input[from + i];
+    }
+    for (; i < length; i++) {
+        TinyCmd_buf.input[i] = '\0';
+    }
+    TinyCmd_buf.length = length - from;
+    TinyCmd_queue.start -= from;
+    TinyCmd_queue.end = 0;
+    for (i = 0; i < TinyCmd_queue.start; i++) {
+        if (TinyCmd_buf.input[i] == '\n' || TinyCmd_buf.input[i] == '\r') {
+            TinyCmd_queue.end = i + 1;
+            break;
+        }
+    }
+#ifdef CMD_USE_FLOW
+    flow_check(TinyCmd_queue.end > 0 ? TinyCmd_buf.length : 0);
+#endif //CMD_USE_FLOW
+    CMD_PORT_EXIT_CRITICAL();
+}
+#endif //CMD_LINE_QUEUE
 
-    while (*format && pos < max_len - 1) {
-        if (*format == '%') {
-            format++;
-            switch (*format) {
-                case 'd': {
-                    int value = va_arg(args, int);
-                    char num_buffer[32];
-                    itoa(value, num_buffer, 10);
-                    send_string(num_buffer);
-                    break;
-                }
-                case 'u': {
-                    unsigned int value = va_arg(args, unsigned int);
-                    char num_buffer[32];
-                    uitoa(value, num_buffer, 10);
-                    send_string(num_buffer);
-                    break;
-                }
-                case '.':
-                {
-                    double value = va_arg(args, double);
-                    char num_buffer[64];
-                    dtoa(value, num_buffer, (*(++format) - '0'));
-                    send_string(num_buffer);
-                    format++;
-                    break;
-                }
-                case 'f': {
-                    double value = va_arg(args, double);
-                    char num_buffer[64];
-                    dtoa(value, num_buffer, 6);
-                    send_string(num_buffer);
-                    break;
-                }
-                case 's': {
-                    const char* str = va_arg(args, const char*);
-                    send_string(str);
-                    break;
-                }
-                default:
-                    CMD_SEND_CHAR('%');
-                    CMD_SEND_CHAR(*format);
-                    break;
-            }
-        } else {
-            CMD_SEND_CHAR(*format);
+#ifdef CMD_USE_FLOW
+//Flow control****************************************************************//
+
+//static void flow_check(TinyCmd_Counter_Type level)
+//Description:Stop the sender when the lines waiting for the main loop fill level bytes of TinyCmd_buf.input, from
+//            CMD_FLOW_HIGH on, and let it go on at CMD_FLOW_LOW. A partial line alone gives level 0: the main loop
+//            has nothing to run, so stopping the sender would never end.
+static void flow_check(TinyCmd_Counter_Type level)
+{
+    if (!TinyCmd_flow.stopped && level >= CMD_FLOW_HIGH) {
+        TinyCmd_flow.stopped = 1;
+        TinyCmd_flow.stops++;
+        CMD_FLOW_CONTROL(TINYCMD_FAILED);
+    } else if (TinyCmd_flow.stopped && level <= CMD_FLOW_LOW) {
+        TinyCmd_flow.stopped = 0;
+        CMD_FLOW_CONTROL(TINYCMD_SUCCESS);
+    }
+}
+
+//Built-in command:
+//  flow          Print the lines dropped for lack of room, the lines longer than TinyCmd_buf.input
+//                and the times the sender was stopped.
+//  flow clear    Set the counts to 0.
+static TinyCmd_CallBack_Ret flow_callback(void)
+{
+    TinyCmd_Status clear = TINYCMD_FAILED;
+    unsigned int dropped, overlong, stops;
+
+    if (TinyCmd_buf.arg[0] != NULL) {
+        if (!TinyCmd_Arg_Check("clear", 0)) {
+            return TINYCMD_FAILED;
         }
-        format++;
+        clear = TINYCMD_SUCCESS;
     }
 
-    va_end(args);
+    {
+        //The counts are written by TinyCmd_PutChar()
+        CMD_PORT_ENTER_CRITICAL();
+        dropped = TinyCmd_flow.dropped;
+        overlong = TinyCmd_flow.overlong;
+        stops = TinyCmd_flow.stops;
+        if (clear) {
+            TinyCmd_flow.dropped = 0;
+            TinyCmd_flow.overlong = 0;
+            TinyCmd_flow.stops = 0;
+        }
+        CMD_PORT_EXIT_CRITICAL();
+    }
 
+    if (!clear) {
+        TinyCmd_Report_P(TINYCMD_PSTR("dropped %u overlong %u stops %u\n"), dropped, overlong, stops);
+    }
+    return TINYCMD_SUCCESS;
+}
+
+static TINYCMD_NAME(flow_name, "flow");
+TinyCmd_Command TinyCmd_Flow_Cmd = {.command = flow_name, .callback = &flow_callback};
+#endif //CMD_USE_FLOW
+
+#ifdef CMD_USE_TIMING
+//Phase timing****************************************************************//
+
+//static void timing_start(void)
+//Description:Start timing a line of TinyCmd_Handler().
+static void timing_start(void)
+{
+    TinyCmd_timing.on = 1;
+    TinyCmd_timing.stamp = CMD_CYCLES();
+}
+
+//static void timing_mark(TinyCmd_Timing_Phase phase)
+//Description:Count the time since the end of the last phase in the histogram of phase.
+//            An interrupt taken meanwhile, such as an urgent command, is counted in the phase.
+static void timing_mark(TinyCmd_Timing_Phase phase)
+{
+    unsigned long time;
+    unsigned char n = 0;
+
+    if (!TinyCmd_timing.on) {
+        return;
+    }
+    time = CMD_CYCLES() - TinyCmd_timing.stamp;
+
+    if (time > TinyCmd_timing.max[phase]) {
+        TinyCmd_timing.max[phase] = time;
+    }
+    //Bucket of the highest bit set
+    for (unsigned long t = time >> 1; t != 0 && n < CMD_TIMING_BUCKETS - 1; t >>= 1) {
+        n++;
+    }
+    if (TinyCmd_timing.count[phase][n] != (unsigned int)-1) {
+        TinyCmd_timing.count[phase][n]++;
+    }
+
+    //The counting is not part of the next phase
+    TinyCmd_timing.stamp = CMD_CYCLES();
+}
+
+//Built-in command:
+//  timing        Print the histograms of the phases of TinyCmd_Handler(): a line for each bucket counting any time,
+//                starting at the time of the bucket, then the longest time of each phase.
+//  timing clear  Set the counts to 0.
+static TinyCmd_CallBack_Ret timing_callback(void)
+{
+    const unsigned int (*count)[CMD_TIMING_BUCKETS] = TinyCmd_timing.count;
+    const unsigned long* max = TinyCmd_timing.max;
+
+    if (TinyCmd_buf.arg[0] != NULL) {
+        if (!TinyCmd_Arg_Check("clear", 0)) {
+            return TINYCMD_FAILED;
+        }
+        for (TinyCmd_Counter_Type p = 0; p < TIMING_PHASES; p++) {
+            for (TinyCmd_Counter_Type n = 0; n < CMD_TIMING_BUCKETS; n++) {
+                TinyCmd_timing.count[p][n] = 0;
+            }
+            TinyCmd_timing.max[p] = 0;
+        }
+        return TINYCMD_SUCCESS;
+    }
+
+    TinyCmd_Report_P(TINYCMD_PSTR("    from     trim tokenize   lookup callback    clear\n"));
+    for (TinyCmd_Counter_Type n = 0; n < CMD_TIMING_BUCKETS; n++) {
+        if (count[TIMING_TRIM][n] == 0 && count[TIMING_TOKENIZE][n] == 0 && count[TIMING_LOOKUP][n] == 0 &&
+            count[TIMING_CALLBACK][n] == 0 && count[TIMING_CLEAR][n] == 0) {
+            continue;
+        }
+        TinyCmd_Report_P(TINYCMD_PSTR("%8lu %8u %8u %8u %8u %8u\n"), n > 0 ? 1UL << n : 0UL,
+                         count[TIMING_TRIM][n], count[TIMING_TOKENIZE][n], count[TIMING_LOOKUP][n],
+                         count[TIMING_CALLBACK][n], count[TIMING_CLEAR][n]);
+    }
+    TinyCmd_Report_P(TINYCMD_PSTR("     max %8lu %8lu %8lu %8lu %8lu\n"), max[TIMING_TRIM], max[TIMING_TOKENIZE],
+                     max[TIMING_LOOKUP], max[TIMING_CALLBACK], max[TIMING_CLEAR]);
     return TINYCMD_SUCCESS;
-}
\ No newline at end of file
+}
+
+static TINYCMD_NAME(timing_name, "timing");
+TinyCmd_Command TinyCmd_Timing_Cmd = {.command = timing_name, .callback = &timing_callback};
+#endif //CMD_USE_TIMING
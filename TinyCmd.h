@@ -27,6 +27,14 @@
 #ifndef __TINYCMD_H__
 #define __TINYCMD_H__
 
+//Settings of a project that can't pass -D flags (an Arduino sketch) may be kept in TinyCmd_Settings.h next to
+//this file, it is included first if the compiler knows __has_include (GCC 5, Clang, ARM Compiler 6)
+#if defined(__has_include)
+#if __has_include("TinyCmd_Settings.h")
+#include "TinyCmd_Settings.h"
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -37,6 +45,11 @@ extern "C" {
 //You can redefine this function by you "putchar" function to prevent the warrings.
 #define CMD_SEND_CHAR(c) TinyCmd_SendChar(c)
 
+//This macro is used to send a character of the output of an urgent command (CMD_USE_PRIORITY) and XON/XOFF (CMD_USE_FLOW)
+//If your port queues the output (a TX ring emptied by an interrupt or DMA), put the character ahead of the
+//queued bytes, so the answer doesn't wait behind a long output. Until TinyCmd_SendUrgent is set, CMD_SEND_CHAR(c) is used.
+#define CMD_SEND_URGENT(c) TinyCmd_SendUrgent(c)
+
 // This macro is used to enable USART send by DMA
 // If you want to use TinyCmd_SendString(str), you must enable this macro
 // #define USE_USART_DMA_SEND_STR
@@ -47,24 +60,377 @@ extern "C" {
 //Implementing a function that continuously sends strings is a better choice
 #define CMD_SEND_STRING(str) TinyCmd_SendString(str)
 
+//This macro is used to send a block of bytes to the user
+//Binary output (such as stream frames) may contain '\0', so it can't be sent by CMD_SEND_STRING(str).
+//If you have a function sending a whole buffer at once (DMA, USB CDC...), define this macro to use it.
+//Otherwise TinyCmd sends the bytes one by one by CMD_SEND_CHAR(c).
+// #define CMD_SEND_BYTES(buf, len) TinyCmd_SendBytes(buf, len)
+
+//This macro is used to read a received character for TinyCmd_Poll()
+//TinyCmd_ReadChar returns the character, or -1 when nothing is received (like Serial.read() on Arduino).
+#define CMD_READ_CHAR() TinyCmd_ReadChar()
+
+//This macro is used to read a time in milliseconds, such as millis() on Arduino or the SysTick count.
+//The timeouts of the binary transfer and the age of cached responses use it, they are off while TinyCmd_Millis
+//always returns 0.
+#define CMD_MILLIS() TinyCmd_Millis()
+
+//This macro is used to stop the sender and let it go on again (CMD_USE_FLOW), go is TINYCMD_FAILED to stop it.
+//TinyCmd_FlowControl sends XOFF (0x13) and XON (0x11) by CMD_SEND_URGENT(c) until it is set, set it to drive the
+//RTS line instead if the port has hardware flow control. Like CMD_SEND_URGENT(c), it is called in TinyCmd_PutChar().
+#define CMD_FLOW_CONTROL(go) TinyCmd_FlowControl(go)
+
+//This macro is used to read a free running counter for the phase timing (CMD_USE_TIMING), such as DWT->CYCCNT on
+//Cortex-M, a timer extended to 32 bits on AVR, or clock_gettime() in nanoseconds on a host.
+//Define it as the register read to save the call, e.g. #define CMD_CYCLES() (DWT->CYCCNT)
+#define CMD_CYCLES() TinyCmd_Cycles()
+
+//Port of TinyCmd*******************************************************************************//
+
+//These macros are used to protect data shared with an interrupt (TinyCmd_PutChar, TinyCmd_Stream_Tick)
+//when the main loop reads or writes it in more than one instruction, such as a 16 or 32-bit value on AVR.
+//Define them before including TinyCmd.h for your platform, e.g. on Cortex-M:
+//  #define CMD_PORT_ENTER_CRITICAL() unsigned int cmd_port_primask = __get_PRIMASK(); __disable_irq()
+//  #define CMD_PORT_EXIT_CRITICAL() __set_PRIMASK(cmd_port_primask)
+#ifndef CMD_PORT_ENTER_CRITICAL
+#if defined(__AVR__)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#define CMD_PORT_ENTER_CRITICAL() unsigned char cmd_port_sreg = SREG; cli()
+#define CMD_PORT_EXIT_CRITICAL() SREG = cmd_port_sreg
+#else
+#define CMD_PORT_ENTER_CRITICAL()
+#define CMD_PORT_EXIT_CRITICAL()
+#endif
+#endif
+
+//Native word size of the platform in bytes, it selects the faster variant of some code paths:
+//1 keeps small tables and byte-wise loops for 8-bit parts, 4 or more uses bigger tables for 32-bit parts.
+#ifndef CMD_PORT_WORD
+#if defined(__AVR__)
+#define CMD_PORT_WORD 1
+#elif defined(__SIZEOF_POINTER__)
+#define CMD_PORT_WORD __SIZEOF_POINTER__
+#else
+#define CMD_PORT_WORD 4
+#endif
+#endif
+
 //Constant for configure TinyCmd****************************************************************//
 
-#define CMD_RPT_BUF_SIZE 255
+// This macro is used to print the command and its arguments before running it (debug echo)
+// Define CMD_NO_DEBUG_ECHO on the command line to build without it, as the host tests do.
+#ifndef CMD_NO_DEBUG_ECHO
+#define CMD_DEBUG_ECHO
+#endif
+
+// This macro is used to share one static scratch buffer between the number formatter of TinyCmd_Report,
+// the memory dump and the stream text lines instead of a buffer on the stack of each.
+// The formatter is then not reentrant: don't call TinyCmd_Report from an interrupt while the main loop reports.
+// Urgent commands of CMD_USE_PRIORITY get a second buffer of their own.
+// #define CMD_USE_SHARED_SCRATCH
 
 //Length of the command or arguments name
+#ifndef CMD_NAME_LENGTH
 #define CMD_NAME_LENGTH 8
+#endif
 
 //Total amount of avilable commands in the list
+#ifndef CMD_LIST_SIZE
 #define CMD_LIST_SIZE  6
+#endif
+
+//Number of slots of a keyword table (TinyCmd_Keywords), a power of two up to 256.
+//A table with more keywords than 3/4 of CMD_KEYWORD_SLOTS is searched linearly instead.
+#define CMD_KEYWORD_SLOTS 16
+
+// This macro is used to accept a unique prefix of a command name, ignoring case ("mot" runs "Motor")
+// #define CMD_USE_ABBREV
+
+// This macro is used to enable subcommand tables (TINYCMD_SUB), "Motor speed 3" runs the speed subcommand of Motor.
+// Without it TinyCmd_Command has no sub and sub_count, and the handler does not walk down tables.
+// #define CMD_USE_SUB
 
 //Maximum number of tokens in a command
+#ifndef CMD_MAX_TOKENS
 #define CMD_MAX_TOKENS 4
+#endif
+
+// This macro is used to enable the large buffer mode for scripted batch input and long argument lists
+// TinyCmd_Counter_Type becomes size_t, so lines, tokens and counts don't wrap at 255.
+// The input buffer and the number of tokens are set by CMD_LARGE_BUF_SIZE and CMD_LARGE_MAX_TOKENS.
+// #define CMD_USE_LARGE_BUFFER
+
+#define CMD_LARGE_BUF_SIZE 65536
+#define CMD_LARGE_MAX_TOKENS 256
+
+#ifdef CMD_USE_LARGE_BUFFER
+#undef CMD_MAX_TOKENS
+#define CMD_MAX_TOKENS CMD_LARGE_MAX_TOKENS
+#endif
 
 //Maximum number of parameters in a command
 #define CMD_MAX_PARAMS (CMD_MAX_TOKENS - 1)
 
 //Length of the command buffer string
+#ifdef CMD_USE_LARGE_BUFFER
+#define CMD_BUF_SIZE CMD_LARGE_BUF_SIZE
+#else
 #define CMD_BUF_SIZE (CMD_NAME_LENGTH * CMD_MAX_TOKENS + CMD_MAX_TOKENS - 1)
+#endif
+
+//Maximum number of operations (literal runs and conversions) in a compiled format string
+#define CMD_FMT_MAX_OPS 8
+
+//Maximum number of decimals printed by %f, a bigger precision is cut to it
+#define CMD_FMT_MAX_PRECISION 16
+
+//Flags of a TinyCmd_Report conversion: '-' left align, '0' zero padding
+#define TINYCMD_FMT_LEFT 0x01
+#define TINYCMD_FMT_ZERO 0x02
+
+//Constant for configure TinyCmd command registration*******************************************//
+
+// This macro is used to register commands at link time
+// TINYCMD_REGISTER(name, callback) places a const TinyCmd_Command into the linker section "tinycmd_cmd",
+// TinyCmd_Handler() looks the command up there, so no TinyCmd_Add_Cmd() call and no RAM is needed.
+// Supported by GCC and Clang on ELF targets (Linux host, arm-none-eabi...) and ARM Compiler 6.
+// With --gc-sections and your own linker script, keep the section: KEEP(*(tinycmd_cmd))
+// Call TinyCmd_Section_Init() once at start-up to sort an index of them for a binary search.
+// #define CMD_USE_SECTION
+
+//Maximum number of registered commands in the index sorted by TinyCmd_Section_Init()
+#ifndef CMD_SECTION_SIZE
+#define CMD_SECTION_SIZE 32
+#endif
+
+//Constant for configure TinyCmd flash strings************************************************//
+
+// This macro is used to keep command names and format strings in flash on AVR (Harvard architecture)
+// Names declared by TINYCMD_NAME() and formats of TinyCmd_Report_P(TINYCMD_PSTR("...")) stay in flash
+// and are read by pgm_read_byte(), other parts read them as usual. Keywords and formats compiled by
+// TinyCmd_Fmt_Compile() stay in RAM. Off AVR the same code runs with plain reads.
+// #define CMD_USE_PROGMEM
+
+#if defined(CMD_USE_PROGMEM) && defined(__AVR__)
+#include <avr/pgmspace.h>
+#define TINYCMD_FLASH PROGMEM
+#define TINYCMD_PSTR(str) PSTR(str)
+#define TINYCMD_READ_BYTE(addr) pgm_read_byte(addr)
+#else
+#define TINYCMD_FLASH
+#define TINYCMD_PSTR(str) (str)
+#define TINYCMD_READ_BYTE(addr) (*(const char*)(addr))
+#endif
+
+//TINYCMD_NAME(var, str):
+//description: Declare a command name in flash, e.g.
+//             static TINYCMD_NAME(Led_Name, "led");
+//             TinyCmd_Command Led = {.command = Led_Name, .callback = &Led_Callback};
+#define TINYCMD_NAME(var, str) const char var[] TINYCMD_FLASH = str
+
+//Constant for configure TinyCmd line editor**************************************************//
+
+// This macro is used to enable the line editor in TinyCmd_PutChar()
+// Received characters are echoed and edited in place in TinyCmd_buf.input: backspace, delete, left, right,
+// home and end (VT100 keys or Ctrl-H/D/B/F/A/E), up and down (or Ctrl-P/N) recall the command history.
+// Tab completes commands, subcommands and the keywords set in TinyCmd_Command.keywords.
+// #define CMD_USE_LINE_EDIT
+
+//Bytes of the command history. A line is stored once, repeating it moves it to the newest,
+//and the oldest lines are dropped when it is full.
+#define CMD_EDIT_HISTORY_SIZE 128
+
+//Constant for configure TinyCmd aliases*******************************************************//
+
+// This macro is used to enable aliases and macros defined at run time by the built-in command "alias"
+// "alias on LED ON" makes "on" run "LED ON", "alias go Motor start;LED ON" runs both steps in turn.
+// The words typed after an alias are added to its last step: after "alias led LED", "led OFF" runs "LED OFF".
+// #define CMD_USE_ALIAS
+
+//Bytes of the alias arena, every alias takes its name, its text and two '\0'.
+//The steps are run from a buffer of CMD_ALIAS_LINE_SIZE bytes besides the arena.
+#define CMD_ALIAS_ARENA_SIZE 128
+
+//Bytes of the buffer a step is copied to with the words typed after the alias, a longer step is refused.
+//CMD_BUF_SIZE by default, 1024 with CMD_USE_LARGE_BUFFER so the buffer doesn't take another 64 KB.
+#ifndef CMD_ALIAS_LINE_SIZE
+#ifdef CMD_USE_LARGE_BUFFER
+#define CMD_ALIAS_LINE_SIZE 1024
+#else
+#define CMD_ALIAS_LINE_SIZE CMD_BUF_SIZE
+#endif //CMD_USE_LARGE_BUFFER
+#endif //CMD_ALIAS_LINE_SIZE
+
+//Constant for configure TinyCmd scripts*******************************************************//
+
+// This macro is used to run scripts, lines of commands kept in memory, without sending them to TinyCmd_PutChar()
+// TinyCmd_Script_Run() runs a script in RAM or in a private file mapping (mmap MAP_PRIVATE) and splits the lines
+// in place. TinyCmd_Script_Run_P() runs a read-only script (a flash page, PROGMEM) line by line through a static copy.
+// Empty lines and lines starting with '#' are skipped.
+// tools/TinyCmd_Compile.py compiles a script for TinyCmd_Compiled_Run(), which skips tokenizing, looking commands up
+// and parsing numbers.
+// #define CMD_USE_SCRIPT
+
+//Bytes of the static buffer the lines of a read-only script, and a last line without '\n', are copied to.
+//A script run from a callback copies its lines after the line running it, a line that doesn't fit is refused.
+//CMD_BUF_SIZE by default, 1024 with CMD_USE_LARGE_BUFFER.
+#ifndef CMD_SCRIPT_LINE_SIZE
+#ifdef CMD_USE_LARGE_BUFFER
+#define CMD_SCRIPT_LINE_SIZE 1024
+#else
+#define CMD_SCRIPT_LINE_SIZE CMD_BUF_SIZE
+#endif //CMD_USE_LARGE_BUFFER
+#endif //CMD_SCRIPT_LINE_SIZE
+
+//Constant for configure TinyCmd priority commands*********************************************//
+
+// This macro is used to run urgent commands ("Motor stop"...) at once in TinyCmd_PutChar(), in the receive interrupt
+// A command whose priority in TinyCmd_Command is TINYCMD_PRIORITY_URGENT runs as soon as its line is complete,
+// even while the main loop is still running a long command, and its output is sent by CMD_SEND_URGENT(c).
+// #define CMD_USE_PRIORITY
+
+//Maximum number of words in the line of an urgent command: its name, subcommands and arguments.
+//A longer line is left to the main loop.
+#define CMD_URGENT_TOKENS 3
+
+//Priority of a command
+#define TINYCMD_PRIORITY_NORMAL 0
+#define TINYCMD_PRIORITY_URGENT 1
+
+//Constant for configure TinyCmd flow control**************************************************//
+
+// This macro is used to stop a host sending lines faster than the commands run, by CMD_FLOW_CONTROL(go)
+// The lines received while the main loop runs one are kept after it in TinyCmd_buf.input. The sender is stopped when
+// they fill CMD_FLOW_HIGH bytes, and goes on when the main loop has run them down to CMD_FLOW_LOW bytes.
+// The built-in command "flow" prints the lines dropped for lack of room and the overlong lines.
+// #define CMD_USE_FLOW
+
+//Bytes of TinyCmd_buf.input the sender is stopped at. The bytes above it must hold what the sender still sends after
+//the stop: the FIFO of the UART and the reaction time of the host.
+#define CMD_FLOW_HIGH (CMD_BUF_SIZE * 3 / 4)
+
+//Bytes of TinyCmd_buf.input the sender goes on at
+#define CMD_FLOW_LOW (CMD_BUF_SIZE / 4)
+
+//Line longer than TinyCmd_buf.input (CMD_USE_FLOW, CMD_USE_PRIORITY): TINYCMD_OVERLONG_DISCARD drops it up to the
+//next end of line, TINYCMD_OVERLONG_TRUNCATE runs its first characters.
+#define CMD_OVERLONG_POLICY TINYCMD_OVERLONG_DISCARD
+#define TINYCMD_OVERLONG_DISCARD 0
+#define TINYCMD_OVERLONG_TRUNCATE 1
+
+//Constant for configure TinyCmd phase timing**************************************************//
+
+// This macro is used to time the phases of TinyCmd_Handler() by CMD_CYCLES(): trim, tokenize, lookup, callback and
+// clear. Each time goes into a histogram of the phase, bucket n counts the times from 2^n to 2^(n+1)-1 counts.
+// The built-in command "timing" prints them. Without it the phases are not timed at all.
+// #define CMD_USE_TIMING
+
+//Number of buckets of a histogram, the last one counts all the longer times
+#define CMD_TIMING_BUCKETS 16
+
+//Constant for configure TinyCmd response cache************************************************//
+
+// This macro is used to replay the responses of read-only queries ("version", "config get"...) without running them
+// A command with cache_ms set in its TinyCmd_Command keeps what its callback sent in a cache slot. The same command
+// with the same arguments sends these bytes again, until cache_ms milliseconds (CMD_MILLIS) have passed or
+// TinyCmd_Cache_Clear() drops them. The built-in command "cache" prints the hits and misses.
+// #define CMD_USE_CACHE
+
+//Number of cache slots, the least recently used one is replaced
+#define CMD_CACHE_SLOTS 4
+
+//Bytes of a cache slot: the arguments, each with a '\0', and the response. A bigger response is not kept.
+#define CMD_CACHE_SLOT_SIZE 64
+
+//Value of cache_ms keeping a response until TinyCmd_Cache_Clear() drops it
+#define TINYCMD_CACHE_KEEP 0xFFFFFFFFUL
+
+//Constant for configure TinyCmd stream********************************************************//
+
+// This macro is used to enable the variable stream
+// Variables registered by TinyCmd_Var_Add() can be sampled at a fixed rate by TinyCmd_Stream_Tick()
+// and sent as binary frames or delta encoded text by TinyCmd_Stream_Flush().
+// Samples are kept as long: scaled FLOAT/DOUBLE values and 64-bit variables saturate at the range of long.
+// Binary frames keep only the low 32 bits of each sample, text deltas wrap around modulo the width of long.
+// #define CMD_USE_STREAM
+
+//Total amount of variables that can be registered for streaming (32 at most)
+#define CMD_VAR_LIST_SIZE 8
+
+//Size of the stream ring buffer in samples, one sample is one value of one variable.
+//It must be a power of two.
+#define CMD_STREAM_RING_SIZE 64
+
+//In text mode a full row is sent once every CMD_STREAM_KEYFRAME rows, so the host can resync.
+#define CMD_STREAM_KEYFRAME 32
+
+//Constant for configure TinyCmd memory dump*************************************************//
+
+// This macro is used to enable the memory dump
+// TinyCmd_Dump() and the built-in command "md addr len" send memory as hexdump lines or base64.
+// #define CMD_USE_DUMP
+
+//Number of bytes in one hexdump line
+#define CMD_DUMP_LINE 16
+
+//Constant for configure TinyCmd binary transfer***********************************************//
+
+// This macro is used to enable the binary transfer
+// The built-in commands "rx len" and "tx addr len" switch TinyCmd_PutChar() into chunked binary mode.
+// Chunk: 0x5A, seq, len, len bytes, CRC-16/CCITT of seq..data little endian.
+// The receiver answers ACK (0x06, seq) for every chunk in order and NAK (0x15, expected seq) on errors,
+// the sender may have CMD_XFER_WINDOW chunks not acknowledged yet and goes back to the NAKed chunk.
+// Two CAN bytes (0x18 0x18) abort.
+// #define CMD_USE_XFER
+
+//Maximum payload of one chunk, it must not be bigger than 255
+#define CMD_XFER_CHUNK 64
+
+//Number of chunks the sender may send before it waits for an ACK
+#define CMD_XFER_WINDOW 4
+
+//Time in milliseconds without any byte after which the receiver NAKs the expected chunk again (CMD_MILLIS)
+#define CMD_XFER_TIMEOUT 500
+
+//Constant for configure TinyCmd deferred report***********************************************//
+
+// This macro is used to enable deferred report
+// TinyCmd_Report_Id(id, ...) sends the index of the format string in the format table and the raw
+// arguments instead of the formatted text, the host rebuilds the text by tools/TinyCmd_Decode.py.
+// The format table is declared by the user with TINYCMD_FMT_ENUM() and TINYCMD_FMT_TABLE(), e.g.
+//     #define MY_FORMATS(X) X(FMT_HELLO, "Hello TinyCmd %d %f\n") X(FMT_SPEED, "at speed %d\n")
+//     TINYCMD_FMT_ENUM(MY_FORMATS);       //in a header
+//     TINYCMD_FMT_TABLE(MY_FORMATS);      //in exactly one .c file
+//     TinyCmd_Report_Id(FMT_SPEED, 10);
+// #define CMD_USE_DEFER_REPORT
+
+#define TINYCMD_FMT_ID(id, str) id,
+#define TINYCMD_FMT_STR(id, str) str,
+#define TINYCMD_FMT_ENUM(table) enum { table(TINYCMD_FMT_ID) }
+#define TINYCMD_FMT_TABLE(table) \
+	const char* const TinyCmd_Fmt_Table[] = { table(TINYCMD_FMT_STR) }; \
+	const TinyCmd_Counter_Type TinyCmd_Fmt_Count = sizeof(TinyCmd_Fmt_Table) / sizeof(TinyCmd_Fmt_Table[0])
+
+//Configuration profiles**********************************************************************//
+
+// This macro is used to select the minimum footprint profile for parts with little RAM (AVR with 2 KB...)
+// It turns off the debug echo, shares one scratch buffer and makes the format limits smaller.
+// Run tools/TinyCmd_Footprint.py to print the RAM, flash and stack usage of each profile.
+// #define CMD_PROFILE_MIN
+
+#ifdef CMD_PROFILE_MIN
+#undef CMD_DEBUG_ECHO
+#ifndef CMD_USE_SHARED_SCRATCH
+#define CMD_USE_SHARED_SCRATCH
+#endif
+#undef CMD_FMT_MAX_OPS
+#define CMD_FMT_MAX_OPS 4
+#undef CMD_FMT_MAX_PRECISION
+#define CMD_FMT_MAX_PRECISION 6
+#undef CMD_KEYWORD_SLOTS
+#define CMD_KEYWORD_SLOTS 8
+#endif //CMD_PROFILE_MIN
 
 //Global typedef****************************************************************************//
 
@@ -72,8 +438,16 @@ extern "C" {
 typedef unsigned char TinyCmd_CallBack_Ret;
 
 //Counter type for TinyCmd(Such as i in for loop)
-//When your Input buffer ecexceeds 255, you need to make this shit bigger.
+//When your Input buffer ecexceeds 255, you need to make this shit bigger: define CMD_USE_LARGE_BUFFER.
+#ifdef CMD_USE_LARGE_BUFFER
+#include <stddef.h>
+typedef size_t TinyCmd_Counter_Type;
+#else
 typedef unsigned char TinyCmd_Counter_Type;
+#if CMD_BUF_SIZE > 256 || CMD_MAX_TOKENS > 255
+#error "CMD_BUF_SIZE or CMD_MAX_TOKENS doesn't fit in an unsigned char, define CMD_USE_LARGE_BUFFER"
+#endif
+#endif
 
 //SendCharFunc type for TinyCmd
 //description: This function is used to send a character to the user,=
@@ -83,6 +457,18 @@ typedef void (*SendCharFunc)(char c);
 // description: This function is used to send string to the user,
 typedef void (*SendStringFunc)(const char *str);
 
+//ReadCharFunc type for TinyCmd
+//description: This function is used to read a received character, -1 if there is none
+typedef int (*ReadCharFunc)(void);
+
+//MillisFunc type for TinyCmd
+//description: This function is used to read the time in milliseconds
+typedef unsigned long (*MillisFunc)(void);
+
+//CyclesFunc type for TinyCmd
+//description: This function is used to read a free running counter, it may wrap around at ULONG_MAX
+typedef unsigned long (*CyclesFunc)(void);
+
 //Global structs****************************************************************************//
 
 //TinyCmd input buffer struct:
@@ -99,18 +485,139 @@ typedef struct TinyCmd_inuput{
 //TinyCmd Command struct:
 //description: When you are going to add a new command, you need to define a struct like this:
 //command: The command name
-//callback: The callback function pointer
+//callback: The callback function pointer, it may be NULL for a command having only subcommands
+//sub: Subcommands (CMD_USE_SUB), the first argument selects one of them and its callback gets the arguments after it.
+//     If no subcommand matches, the callback of this command is called with all arguments.
+//sub_count: Number of subcommands, set both by TINYCMD_SUB(table)
+//keywords: Keywords Tab completes for the arguments (CMD_USE_LINE_EDIT), may be NULL
+//cache_ms: Milliseconds the response is replayed for (CMD_USE_CACHE), 0 runs the callback every time,
+//          TINYCMD_CACHE_KEEP keeps it until TinyCmd_Cache_Clear()
+//priority: TINYCMD_PRIORITY_URGENT runs the command in TinyCmd_PutChar() (CMD_USE_PRIORITY)
 typedef struct TinyCmd_Command{
 	const char* command;
 	TinyCmd_CallBack_Ret (*callback)(void);
+#ifdef CMD_USE_SUB
+	struct TinyCmd_Command** sub;
+	TinyCmd_Counter_Type sub_count;
+#endif //CMD_USE_SUB
+#ifdef CMD_USE_LINE_EDIT
+	const struct TinyCmd_Keywords* keywords;
+#endif //CMD_USE_LINE_EDIT
+#ifdef CMD_USE_CACHE
+	unsigned long cache_ms;
+#endif //CMD_USE_CACHE
+#ifdef CMD_USE_PRIORITY
+	unsigned char priority;
+#endif //CMD_USE_PRIORITY
 }TinyCmd_Command;
 
+//TinyCmd keyword table struct:
+//description: A set of keywords an argument is matched against by TinyCmd_Arg_Keyword(), declare it by TINYCMD_KEYWORDS()
+//             and build its slots by TinyCmd_Keywords_Init() at start-up. A const table is not built, it can stay in flash
+//             off AVR and its keywords are compared one by one.
+//words: The keywords, the index of a keyword in this array is returned
+//count: Number of keywords
+//nocase: Match ignoring case if not 0
+//built: Set by TinyCmd_Keywords_Init(), the keywords are compared one by one until then
+//slot: Keyword index + 1 at the slot of its length, first and last characters, 0 for an empty slot
+typedef struct TinyCmd_Keywords{
+	const char* const* words;
+	TinyCmd_Counter_Type count;
+	unsigned char nocase;
+	unsigned char built;
+	unsigned char slot[CMD_KEYWORD_SLOTS];
+}TinyCmd_Keywords;
+
+//TINYCMD_KEYWORDS(words, nocase):
+//description: Initializer of a TinyCmd_Keywords for an array of keyword strings, e.g.
+//             static const char* const LED_Words[] = {"ON", "OFF", "Blink"};
+//             static TinyCmd_Keywords LED_Keys = TINYCMD_KEYWORDS(LED_Words, 1);
+//             TinyCmd_Keywords_Init(&LED_Keys);
+#define TINYCMD_KEYWORDS(words, nocase) {(words), sizeof(words) / sizeof((words)[0]), (nocase), 0, {0}}
+
+#ifdef CMD_USE_SUB
+//TINYCMD_SUB(table):
+//description: Set the subcommands of a command to an array of TinyCmd_Command pointers, e.g.
+//             TinyCmd_Command* Motor_Sub[] = {&Motor_CW, &Motor_CCW};
+//             TinyCmd_Command Motor = {.command = "Motor", TINYCMD_SUB(Motor_Sub)};
+//             TinyCmd_Add_Cmd() and TinyCmd_Section_Init() sort the array, so it stays in RAM.
+#define TINYCMD_SUB(table) .sub = (table), .sub_count = sizeof(table) / sizeof((table)[0])
+#endif //CMD_USE_SUB
+
+#ifdef CMD_USE_SECTION
+#if defined(__GNUC__) || defined(__clang__) || defined(__ARMCC_VERSION)
+//TINYCMD_REGISTER(name, callback, ...):
+//description: Register a command at link time, use it at file scope. The other fields may follow as
+//             designated initializers, e.g.
+//             TINYCMD_REGISTER("led", Led_Callback);
+//             TINYCMD_REGISTER("Motor", Motor_Callback, TINYCMD_SUB(Motor_Sub), .priority = TINYCMD_PRIORITY_URGENT);
+//             The entries are aligned to the struct only, the compiler would align a big one more and leave
+//             gaps in the section, which is walked as an array.
+#define TINYCMD_REGISTER(name, fn, ...) \
+	static TINYCMD_NAME(TinyCmd_Reg_Name_##fn, name); \
+	__attribute__((used, section("tinycmd_cmd"), aligned(__alignof__(TinyCmd_Command)))) \
+	const TinyCmd_Command TinyCmd_Reg_##fn = {.command = TinyCmd_Reg_Name_##fn, .callback = &fn, __VA_ARGS__}
+#else
+#error "CMD_USE_SECTION needs GCC, Clang or ARM Compiler 6"
+#endif
+#endif //CMD_USE_SECTION
+
+//TinyCmd compiled format operation:
+//description: One literal run or one conversion of a format string compiled by TinyCmd_Fmt_Compile()
+//literal: Start of the literal run, NULL for a conversion
+//len: Length of the literal run
+//conv: Conversion character ('d','u','x','X','o','c','s','f','%'), 0 for a literal run
+//flags: TINYCMD_FMT_LEFT and/or TINYCMD_FMT_ZERO
+//width: Minimum field width
+//precision: Number of decimals of a 'f' conversion
+//length: 0 for int, 1 for long ("l"), 2 for long long ("ll")
+typedef struct TinyCmd_Fmt_Op{
+	const char* literal;
+	unsigned char len;
+	char conv;
+	unsigned char flags;
+	unsigned char width;
+	unsigned char precision;
+	unsigned char length;
+}TinyCmd_Fmt_Op;
+
+//TinyCmd compiled format struct:
+//description: A format string compiled once and reported by TinyCmd_Report_Fmt() many times.
+//The literal runs point into the format string, so it must stay valid.
+typedef struct TinyCmd_Fmt{
+	TinyCmd_Fmt_Op op[CMD_FMT_MAX_OPS];
+	TinyCmd_Counter_Type count;
+}TinyCmd_Fmt;
+
 //Global enums****************************************************************************//
 typedef enum{
 	TINYCMD_FAILED = 0,
 	TINYCMD_SUCCESS = 1,
 }TinyCmd_Status;
 
+//Output format of the variable stream
+typedef enum{
+	TINYCMD_STREAM_BIN = 0,
+	TINYCMD_STREAM_TEXT = 1,
+}TinyCmd_StreamMode;
+
+//Output format of the memory dump
+typedef enum{
+	TINYCMD_DUMP_HEX = 0,
+	TINYCMD_DUMP_BASE64 = 1,
+}TinyCmd_DumpMode;
+
+//Sink of the binary transfer, called with each chunk received in order.
+//It is called by TinyCmd_PutChar(), so it runs in the receive interrupt: keep it short, store or
+//queue the data and return. data is the chunk copied into TinyCmd_xfer.chunk, which the next
+//chunk overwrites, so it is only valid during the call.
+//Return TINYCMD_FAILED to abort the transfer.
+typedef TinyCmd_Status (*TinyCmd_Xfer_Sink)(unsigned long offset, const unsigned char* data, TinyCmd_Counter_Type len);
+
+//FlowFunc type for TinyCmd
+//description: This function is used to stop the sender (go is TINYCMD_FAILED) and to let it go on (TINYCMD_SUCCESS)
+typedef void (*FlowFunc)(TinyCmd_Status go);
+
 typedef enum {
     TINYCMD_UINT8,
     TINYCMD_INT8,
@@ -126,24 +633,242 @@ typedef enum {
     TINYCMD_DOUBLE
 } TinyCmd_NumType;
 
+//TinyCmd stream variable struct:
+//description: When you are going to stream a variable, you need to define a struct like this:
+//name: The variable name used by the "stream" command
+//ptr: Pointer to the variable
+//type: Type of the variable
+//scale: Counts per unit. FLOAT and DOUBLE variables are sampled as value * scale,
+//       integer variables are sampled as they are. The host gets the unit value by sample / scale.
+typedef struct TinyCmd_Var{
+	const char* name;
+	const volatile void* ptr;
+	TinyCmd_NumType type;
+	float scale;
+}TinyCmd_Var;
+
+//TinyCmd compiled script struct:
+//description: A script compiled by tools/TinyCmd_Compile.py, set by TinyCmd_Compiled_Load() (CMD_USE_SCRIPT)
+//lines: First line in the image
+//end: End of the image
+//cmds: The commands of the script, looked up by the loader
+typedef struct TinyCmd_Compiled{
+	const unsigned char* lines;
+	const unsigned char* end;
+	const TinyCmd_Command** cmds;
+}TinyCmd_Compiled;
+
 //Global variables
 extern TinyCmd_Buffer TinyCmd_buf;
 //This function provied a way to send a character used by TinyCmd_Report.
 //If you want to use TinyCmd_Report function, evaluate this function in before call TinyCmd_Report is mandatory.
+//Until it is set, the output is dropped.
 extern SendCharFunc TinyCmd_SendChar;
+//Read a received character for TinyCmd_Poll(), it returns -1 until it is set.
+extern ReadCharFunc TinyCmd_ReadChar;
+//Time in milliseconds for the timeouts, it returns 0 until it is set.
+extern MillisFunc TinyCmd_Millis;
+#if defined(CMD_USE_PRIORITY) || defined(CMD_USE_FLOW)
+//Send a character of the output of an urgent command ahead of the queued output, CMD_SEND_CHAR until it is set.
+extern SendCharFunc TinyCmd_SendUrgent;
+#endif //CMD_USE_PRIORITY || CMD_USE_FLOW
+#ifdef CMD_USE_FLOW
+//Stop the sender and let it go on, it sends XOFF and XON until it is set.
+extern FlowFunc TinyCmd_FlowControl;
+#endif //CMD_USE_FLOW
+#ifdef CMD_USE_TIMING
+//Read the counter timing the phases of TinyCmd_Handler(), it returns 0 until it is set.
+extern CyclesFunc TinyCmd_Cycles;
+#endif //CMD_USE_TIMING
 
 
 //Global functions
 char* TinyCmd_strcpy(char* dest, const char* src);
 TinyCmd_Status TinyCmd_Handler(void);
+TinyCmd_Status TinyCmd_PutChar(char c);
+TinyCmd_Status TinyCmd_Poll(void);
 TinyCmd_Status TinyCmd_Add_Cmd(TinyCmd_Command* newCmd);
+#ifdef CMD_USE_SECTION
+TinyCmd_Status TinyCmd_Section_Init(void);
+#endif //CMD_USE_SECTION
 TinyCmd_Status TinyCmd_Arg_Check(const char* arg1,TinyCmd_Counter_Type p_arg2);
+TinyCmd_Status TinyCmd_Keywords_Init(TinyCmd_Keywords* keywords);
+int TinyCmd_Arg_Keyword(const TinyCmd_Keywords* keywords, TinyCmd_Counter_Type p_arg);
 TinyCmd_Counter_Type TinyCmd_Arg_Get_Len(TinyCmd_Counter_Type p_arg);
 TinyCmd_Status TinyCmd_Arg_To_Num(TinyCmd_Counter_Type p_arg, void* out_val, TinyCmd_NumType type);
 TinyCmd_Status TinyCmd_Report(const char* format, ...);
+#ifdef CMD_USE_PROGMEM
+TinyCmd_Status TinyCmd_Report_P(const char* format, ...);
+#else
+#define TinyCmd_Report_P TinyCmd_Report
+#endif
+TinyCmd_Status TinyCmd_Fmt_Compile(TinyCmd_Fmt* fmt, const char* format);
+TinyCmd_Status TinyCmd_Report_Fmt(const TinyCmd_Fmt* fmt, ...);
+
+#ifdef CMD_USE_STREAM
+//Built-in command "stream", add it by TinyCmd_Add_Cmd(&TinyCmd_Stream_Cmd)
+extern TinyCmd_Command TinyCmd_Stream_Cmd;
+
+TinyCmd_Status TinyCmd_Var_Add(TinyCmd_Var* newVar);
+TinyCmd_Status TinyCmd_Stream_Select(const char* name, TinyCmd_Status on);
+TinyCmd_Status TinyCmd_Stream_Start(TinyCmd_Counter_Type decimation, TinyCmd_StreamMode mode);
+void TinyCmd_Stream_Stop(void);
+void TinyCmd_Stream_Tick(void);
+void TinyCmd_Stream_Flush(void);
+#endif //CMD_USE_STREAM
+
+#ifdef CMD_USE_DUMP
+//Built-in command "md", add it by TinyCmd_Add_Cmd(&TinyCmd_Dump_Cmd)
+extern TinyCmd_Command TinyCmd_Dump_Cmd;
+
+TinyCmd_Status TinyCmd_Dump(const void* addr, unsigned long len, TinyCmd_DumpMode mode);
+#endif //CMD_USE_DUMP
+
+#ifdef CMD_USE_XFER
+//Built-in commands "rx" and "tx", add them by TinyCmd_Add_Cmd()
+extern TinyCmd_Command TinyCmd_Rx_Cmd;
+extern TinyCmd_Command TinyCmd_Tx_Cmd;
+//Sink used by the "rx" command
+extern TinyCmd_Xfer_Sink TinyCmd_XferSink;
+
+TinyCmd_Status TinyCmd_Xfer_Recv(TinyCmd_Xfer_Sink sink, unsigned long len);
+TinyCmd_Status TinyCmd_Xfer_Send(const void* data, unsigned long len);
+TinyCmd_Status TinyCmd_Xfer_Poll(void);
+void TinyCmd_Xfer_Abort(void);
+#endif //CMD_USE_XFER
+
+#ifdef CMD_USE_ALIAS
+//Built-in command "alias", add it by TinyCmd_Add_Cmd(&TinyCmd_Alias_Cmd)
+extern TinyCmd_Command TinyCmd_Alias_Cmd;
+#endif //CMD_USE_ALIAS
+
+#ifdef CMD_USE_SCRIPT
+TinyCmd_Status TinyCmd_Script_Run(char* script, unsigned long len, TinyCmd_Status stop);
+TinyCmd_Status TinyCmd_Script_Run_P(const char* script, unsigned long len, TinyCmd_Status stop);
+TinyCmd_Status TinyCmd_Compiled_Load(TinyCmd_Compiled* script, const void* image, unsigned long len,
+                                     const TinyCmd_Command** cmds, TinyCmd_Counter_Type size);
+TinyCmd_Status TinyCmd_Compiled_Run(const TinyCmd_Compiled* script, TinyCmd_Status stop);
+#endif //CMD_USE_SCRIPT
+
+#ifdef CMD_USE_CACHE
+//Built-in command "cache", add it by TinyCmd_Add_Cmd(&TinyCmd_Cache_Cmd)
+extern TinyCmd_Command TinyCmd_Cache_Cmd;
+
+void TinyCmd_Cache_Clear(const TinyCmd_Command* cmd);
+#endif //CMD_USE_CACHE
+
+#ifdef CMD_USE_FLOW
+//Built-in command "flow", add it by TinyCmd_Add_Cmd(&TinyCmd_Flow_Cmd)
+extern TinyCmd_Command TinyCmd_Flow_Cmd;
+#endif //CMD_USE_FLOW
+
+#ifdef CMD_USE_TIMING
+//Built-in command "timing", add it by TinyCmd_Add_Cmd(&TinyCmd_Timing_Cmd)
+extern TinyCmd_Command TinyCmd_Timing_Cmd;
+#endif //CMD_USE_TIMING
+
+#ifdef CMD_USE_DEFER_REPORT
+//Format table defined by TINYCMD_FMT_TABLE()
+extern const char* const TinyCmd_Fmt_Table[];
+extern const TinyCmd_Counter_Type TinyCmd_Fmt_Count;
+
+TinyCmd_Status TinyCmd_Report_Id(unsigned int id, ...);
+#endif //CMD_USE_DEFER_REPORT
 
 #ifdef __cplusplus
 }
 #endif
 
+#if defined(__cplusplus) && __cplusplus >= 201402L
+//C++ only: compile a format string at compile time, e.g.
+//    constexpr TinyCmd_Fmt speed_fmt = TinyCmd_Fmt_Make("at speed %d\n");
+//    TinyCmd_Report_Fmt(&speed_fmt, speed);
+//It gives the same ops as TinyCmd_Fmt_Compile(). A format string needing more than
+//CMD_FMT_MAX_OPS ops calls TinyCmd_Fmt_Error(), which breaks the constant evaluation.
+inline void TinyCmd_Fmt_Error(const char*) {}
+
+//Same as fmt_parse() in TinyCmd.c, returns NULL if format is not a conversion.
+constexpr const char* TinyCmd_Fmt_Parse(const char* format, TinyCmd_Fmt_Op& op)
+{
+	bool has_precision = false;
+	unsigned int value = 0;
+
+	op = TinyCmd_Fmt_Op{};
+	op.precision = 6;
+	for (;; format++) {
+		if (*format == '-') {
+			op.flags |= TINYCMD_FMT_LEFT;
+		} else if (*format == '0') {
+			op.flags |= TINYCMD_FMT_ZERO;
+		} else {
+			break;
+		}
+	}
+	for (; *format >= '0' && *format <= '9'; format++) {
+		value = value * 10 + (*format - '0');
+		op.width = value > 255 ? 255 : value;
+	}
+	if (*format == '.') {
+		has_precision = true;
+		format++;
+		for (value = 0; *format >= '0' && *format <= '9'; format++) {
+			value = value * 10 + (*format - '0');
+		}
+		op.precision = value > CMD_FMT_MAX_PRECISION ? CMD_FMT_MAX_PRECISION : value;
+	}
+	while (*format == 'l' && op.length < 2) {
+		op.length++;
+		format++;
+	}
+	switch (*format) {
+		case 'i':
+			op.conv = 'd';
+			return format + 1;
+		case 'd': case 'u': case 'x': case 'X': case 'o': case 'c': case 's': case 'f': case '%':
+			op.conv = *format;
+			return format + 1;
+		default:
+			if (has_precision && op.length == 0) {
+				op.conv = 'f';
+				return *format ? format + 1 : format;
+			}
+			return nullptr;
+	}
+}
+
+constexpr TinyCmd_Fmt TinyCmd_Fmt_Make(const char* format)
+{
+	TinyCmd_Fmt fmt{};
+	while (*format) {
+		if (fmt.count >= CMD_FMT_MAX_OPS) {
+			TinyCmd_Fmt_Error("too many ops in format string");
+			break;
+		}
+		TinyCmd_Fmt_Op& op = fmt.op[fmt.count++];
+		const char* next = (*format == '%') ? TinyCmd_Fmt_Parse(format + 1, op) : nullptr;
+		if (next != nullptr) {
+			format = next;
+			continue;
+		}
+		op = TinyCmd_Fmt_Op{};
+		op.literal = format;
+		while (*format && op.len < 254) {
+			if (*format == '%') {
+				TinyCmd_Fmt_Op conv{};
+				if (op.len && TinyCmd_Fmt_Parse(format + 1, conv) != nullptr) {
+					break;
+				}
+				if (format[1]) {
+					format++;
+					op.len++;
+				}
+			}
+			format++;
+			op.len++;
+		}
+	}
+	return fmt;
+}
+#endif //__cplusplus >= 201402L
+
 #endif // __TINYCMD_H__
\ No newline at end of file
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd.hpp
+ * Author: Civic_Crab
+ * Version: 1.2.0
+ * Created on: 2024-10-24
+ *
+ * Description:
+ * Header-only C++17 front end of TinyCmd.
+ * Commands are a constexpr table of names and functions with typed parameters,
+ * the argument conversion is generated for every parameter type at compile time
+ * and the command name is dispatched by its FNV-1a hash.
+ *
+ * Example:
+ *     void led(std::string_view mode, uint8_t n);
+ *     bool pid(float kp, float ki);            //false makes the command fail
+ *
+ *     inline constexpr auto commands = tinycmd::table(
+ *         tinycmd::cmd<&led>("led"),
+ *         tinycmd::cmd<&pid>("pid"));
+ *
+ *     tinycmd::execute<commands>("led blink 3");
+ */
+
+#ifndef __TINYCMD_HPP__
+#define __TINYCMD_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "TinyCmd.h"
+
+#if __cplusplus < 201703L
+#error "TinyCmd.hpp needs C++17 or later, use TinyCmd.h in C++14 and before"
+#endif
+
+namespace tinycmd {
+
+//Hash of command names*******************************************************//
+
+//FNV-1a, 32 bits
+constexpr std::uint32_t hash(std::string_view name)
+{
+	std::uint32_t h = 2166136261u;
+	for (char c : name) {
+		h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+	}
+	return h;
+}
+
+//Argument conversion*********************************************************//
+
+//parse(text, out):
+//Description: Convert one argument to the type of the parameter, one overload set per type family.
+//Returns:
+//        true: Conversion successful.
+//        false: Not a number, or out of the range of the type.
+inline bool parse(std::string_view text, std::string_view& out)
+{
+	out = text;
+	return true;
+}
+
+inline bool parse(std::string_view text, bool& out)
+{
+	if (text == "1" || text == "on" || text == "true") {
+		out = true;
+		return true;
+	}
+	if (text == "0" || text == "off" || text == "false") {
+		out = false;
+		return true;
+	}
+	return false;
+}
+
+//Same rules as TinyCmd_Arg_To_Num: optional sign, decimal or 0x hexadecimal
+template <typename T>
+std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, bool>
+parse(std::string_view text, T& out)
+{
+	using U = std::make_unsigned_t<T>;
+	bool negative = false;
+	unsigned base = 10;
+	U value = 0;
+
+	if (!text.empty() && (text[0] == '-' || text[0] == '+')) {
+		negative = (text[0] == '-');
+		text.remove_prefix(1);
+	}
+	if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+		base = 16;
+		text.remove_prefix(2);
+	}
+	if (text.empty() || (negative && !std::is_signed_v<T>)) {
+		return false;
+	}
+
+	//Largest magnitude allowed, one more for the negative side of a signed type
+	const U limit = std::is_signed_v<T>
+		? static_cast<U>(static_cast<U>(std::numeric_limits<T>::max()) + (negative ? 1u : 0u))
+		: std::numeric_limits<U>::max();
+
+	for (char c : text) {
+		unsigned digit;
+		if (c >= '0' && c <= '9') {
+			digit = c - '0';
+		} else if (base == 16 && c >= 'a' && c <= 'f') {
+			digit = c - 'a' + 10;
+		} else if (base == 16 && c >= 'A' && c <= 'F') {
+			digit = c - 'A' + 10;
+		} else {
+			return false;
+		}
+		if (value > (limit - digit) / base) {
+			return false;
+		}
+		value = static_cast<U>(value * base + digit);
+	}
+
+	out = negative ? static_cast<T>(static_cast<U>(0u - value)) : static_cast<T>(value);
+	return true;
+}
+
+//Same rules as TinyCmd_Arg_To_Num: optional sign, digits, optional '.' and decimals
+template <typename T>
+std::enable_if_t<std::is_floating_point_v<T>, bool>
+parse(std::string_view text, T& out)
+{
+	bool negative = false;
+	bool digits = false;
+	T value = 0;
+	T scale = 1;
+
+	if (!text.empty() && (text[0] == '-' || text[0] == '+')) {
+		negative = (text[0] == '-');
+		text.remove_prefix(1);
+	}
+
+	std::size_t i = 0;
+	for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++) {
+		value = value * 10 + (text[i] - '0');
+		digits = true;
+	}
+	if (i < text.size() && text[i] == '.') {
+		for (i++; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++) {
+			scale /= 10;
+			value += (text[i] - '0') * scale;
+			digits = true;
+		}
+	}
+	if (!digits || i != text.size()) {
+		return false;
+	}
+
+	out = negative ? -value : value;
+	return true;
+}
+
+//Command table***************************************************************//
+
+//Converted handler of one command: gets the arguments after the command name
+using Thunk = TinyCmd_CallBack_Ret (*)(const std::string_view* args, std::size_t count);
+
+//One row of the command table
+struct Command {
+	std::string_view name;
+	std::uint32_t hash;
+	Thunk thunk;
+};
+
+namespace detail {
+
+template <typename F>
+struct signature;
+
+template <typename R, typename... Args>
+struct signature<R (*)(Args...)> {
+	using ret = R;
+	using args = std::tuple<std::remove_cv_t<std::remove_reference_t<Args>>...>;
+	static constexpr std::size_t arity = sizeof...(Args);
+};
+
+//The result tells success or failure, a value such as the sum of two floats would be taken as a status
+template <typename R>
+inline constexpr bool is_status_v = std::is_void_v<R> || std::is_same_v<R, bool> || std::is_same_v<R, TinyCmd_CallBack_Ret>;
+
+template <auto F, std::size_t... I>
+TinyCmd_CallBack_Ret call(const std::string_view* args, std::index_sequence<I...>)
+{
+	using Sig = signature<decltype(F)>;
+	static_assert(is_status_v<typename Sig::ret>, "a command function returns void, bool or TinyCmd_CallBack_Ret");
+	typename Sig::args values{};
+
+	if (!(parse(args[I], std::get<I>(values)) && ...)) {
+		return TINYCMD_FAILED;
+	}
+	if constexpr (std::is_void_v<typename Sig::ret>) {
+		F(std::get<I>(values)...);
+		return TINYCMD_SUCCESS;
+	} else {
+		return F(std::get<I>(values)...) ? TINYCMD_SUCCESS : TINYCMD_FAILED;
+	}
+}
+
+template <auto F>
+TinyCmd_CallBack_Ret thunk(const std::string_view* args, std::size_t count)
+{
+	using Sig = signature<decltype(F)>;
+	if (count != Sig::arity) {
+		return TINYCMD_FAILED;
+	}
+	return call<F>(args, std::make_index_sequence<Sig::arity>{});
+}
+
+} //namespace detail
+
+//cmd<&function>("name"):
+//Description: Make a row of the command table. The function may return void, bool or TinyCmd_CallBack_Ret,
+//             its parameters may be std::string_view, bool, any integer type, float or double.
+template <auto F>
+constexpr Command cmd(std::string_view name)
+{
+	static_assert(detail::signature<decltype(F)>::arity <= CMD_MAX_PARAMS,
+		"a command takes at most CMD_MAX_PARAMS arguments");
+	return Command{name, hash(name), &detail::thunk<F>};
+}
+
+template <typename... C>
+constexpr std::array<Command, sizeof...(C)> table(C... commands)
+{
+	return {commands...};
+}
+
+template <std::size_t N>
+constexpr bool unique_hashes(const std::array<Command, N>& commands)
+{
+	for (std::size_t i = 0; i < N; i++) {
+		for (std::size_t j = i + 1; j < N; j++) {
+			if (commands[i].hash == commands[j].hash) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//Dispatch********************************************************************//
+
+namespace detail {
+
+template <const auto& Table, std::size_t... I>
+TinyCmd_Status dispatch(std::uint32_t h, std::string_view name,
+                        const std::string_view* args, std::size_t count, std::index_sequence<I...>)
+{
+	TinyCmd_Status ret = TINYCMD_FAILED;
+	//The hashes are constants, so the compiler turns this into a switch on h
+	((h == Table[I].hash && name == Table[I].name && (ret = static_cast<TinyCmd_Status>(Table[I].thunk(args, count)), true)) || ...);
+	return ret;
+}
+
+} //namespace detail
+
+//execute<table>(line):
+//Description: Split line at spaces and run the command, like TinyCmd_Handler does for TinyCmd_buf.
+//             The line is not modified and TinyCmd_buf is not used.
+//Returns:
+//        TINYCMD_SUCCESS: The command is found and its function succeeded.
+//        TINYCMD_FAILED: Unknown command, wrong number of arguments, a conversion failed or the function failed.
+template <const auto& Table>
+TinyCmd_Status execute(std::string_view line)
+{
+	static_assert(unique_hashes(Table), "two command names have the same hash");
+
+	std::string_view tokens[CMD_MAX_TOKENS];
+	std::size_t count = 0;
+
+	while (!line.empty()) {
+		std::size_t start = line.find_first_not_of(" \t\r\n");
+		if (start == std::string_view::npos) {
+			break;
+		}
+		line.remove_prefix(start);
+		std::size_t end = line.find_first_of(" \t\r\n");
+		if (count >= CMD_MAX_TOKENS) {
+			return TINYCMD_FAILED;
+		}
+		tokens[count++] = line.substr(0, end);
+		line.remove_prefix(end == std::string_view::npos ? line.size() : end);
+	}
+	if (count == 0) {
+		return TINYCMD_FAILED;
+	}
+
+	return detail::dispatch<Table>(hash(tokens[0]), tokens[0], tokens + 1, count - 1,
+		std::make_index_sequence<std::tuple_size_v<std::remove_cv_t<std::remove_reference_t<decltype(Table)>>>>{});
+}
+
+} //namespace tinycmd
+
+#endif // __TINYCMD_HPP__
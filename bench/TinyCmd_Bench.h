@@ -0,0 +1,79 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench.h
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Helpers of the host benchmarks in bench/: a clock, an output sink counting the bytes and a timing loop.
+ * Each benchmark is one file built by "make bench", its configuration is in its "// flags:" line.
+ */
+
+#ifndef __TINYCMD_BENCH_H__
+#define __TINYCMD_BENCH_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "TinyCmd.h"
+
+//Times a loop is run, the fastest run is reported
+#define BENCH_REPEAT 5
+
+//Output of TinyCmd: counted and summed, so the compiler can't drop it
+static volatile unsigned long bench_sum;
+static unsigned long bench_bytes;
+
+static inline void bench_send(char c)
+{
+    bench_sum += (unsigned char)c;
+    bench_bytes++;
+}
+
+static inline uint64_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+//Prints the time of one iteration and the iterations per second
+static inline void bench_print(const char* label, unsigned long iterations, uint64_t ns)
+{
+    double per = (double)ns / (double)iterations;
+    printf("%-44s %10.1f ns %14.0f /s\n", label, per, per > 0 ? 1e9 / per : 0.0);
+}
+
+//BENCH(label, iterations, statement):
+//description: Run statement iterations times, BENCH_REPEAT times over, and print the fastest run per iteration.
+//             bench_i is the index of the iteration.
+#define BENCH(label, iterations, statement) do { \
+    uint64_t bench_best = UINT64_MAX; \
+    for (int bench_r = 0; bench_r < BENCH_REPEAT; bench_r++) { \
+        uint64_t bench_t = bench_now(); \
+        for (unsigned long bench_i = 0; bench_i < (unsigned long)(iterations); bench_i++) { \
+            statement; \
+        } \
+        bench_t = bench_now() - bench_t; \
+        if (bench_t < bench_best) { \
+            bench_best = bench_t; \
+        } \
+    } \
+    bench_print((label), (unsigned long)(iterations), bench_best); \
+} while (0)
+
+#endif // __TINYCMD_BENCH_H__
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Defer.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Time and bytes sent per message by TinyCmd_Report_Id, which sends the format index and the raw arguments,
+ * next to TinyCmd_Report formatting the same message on the device.
+ */
+
+// flags: -DCMD_USE_DEFER_REPORT -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Bench.h"
+
+#define CALLS 200000
+
+#define BENCH_FORMATS(X) \
+    X(FMT_SPEED, "at speed %d\n") \
+    X(FMT_HELLO, "Hello TinyCmd %d %f\n") \
+    X(FMT_MOTOR, "motor pos %ld spd %ld i %d u %d\n") \
+    X(FMT_STATE, "state %s after %lu ms\n")
+
+TINYCMD_FMT_ENUM(BENCH_FORMATS);
+TINYCMD_FMT_TABLE(BENCH_FORMATS);
+
+static void report(unsigned long i, int deferred)
+{
+    switch (i & 3) {
+    case 0:
+        if (deferred) {
+            TinyCmd_Report_Id(FMT_SPEED, (int)(i % 3000));
+        } else {
+            TinyCmd_Report("at speed %d\n", (int)(i % 3000));
+        }
+        break;
+    case 1:
+        if (deferred) {
+            TinyCmd_Report_Id(FMT_HELLO, (int)i, (double)i * 0.25);
+        } else {
+            TinyCmd_Report("Hello TinyCmd %d %f\n", (int)i, (double)i * 0.25);
+        }
+        break;
+    case 2:
+        if (deferred) {
+            TinyCmd_Report_Id(FMT_MOTOR, (long)i * 3, (long)(i % 50), (int)(i % 200) - 100, 2400);
+        } else {
+            TinyCmd_Report("motor pos %ld spd %ld i %d u %d\n", (long)i * 3, (long)(i % 50),
+                           (int)(i % 200) - 100, 2400);
+        }
+        break;
+    default:
+        if (deferred) {
+            TinyCmd_Report_Id(FMT_STATE, "running", (unsigned long)i);
+        } else {
+            TinyCmd_Report("state %s after %lu ms\n", "running", (unsigned long)i);
+        }
+        break;
+    }
+}
+
+static void bytes_per_call(const char* label, int deferred)
+{
+    bench_bytes = 0;
+    for (unsigned long i = 0; i < CALLS; i++) {
+        report(i, deferred);
+    }
+    printf("%-44s %10.1f bytes per message\n", label, (double)bench_bytes / CALLS);
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = bench_send;
+
+    printf("one message per iteration, the %u formats in turn\n", (unsigned int)TinyCmd_Fmt_Count);
+    BENCH("TinyCmd_Report_Id", CALLS, report(bench_i, 1));
+    bytes_per_call("TinyCmd_Report_Id", 1);
+    BENCH("TinyCmd_Report", CALLS, report(bench_i, 0));
+    bytes_per_call("TinyCmd_Report", 0);
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Dump.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Bytes of memory dumped per second by TinyCmd_Dump() as hexdump lines and as base64, next to a hexdump
+ * built byte by byte with TinyCmd_Report("%02X "), and the bytes sent per byte dumped.
+ */
+
+// flags: -DCMD_USE_DUMP -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Bench.h"
+
+#define BLOCK 4096
+#define BLOCKS 200
+
+static unsigned char memory[BLOCK];
+
+//The hexdump a user would write without TinyCmd_Dump, without the ASCII column
+static void report_dump(const unsigned char* addr, unsigned long len)
+{
+    for (unsigned long i = 0; i < len; i++) {
+        if (i % CMD_DUMP_LINE == 0) {
+            TinyCmd_Report("%08lX  ", (unsigned long)i);
+        }
+        TinyCmd_Report("%02X ", addr[i]);
+        if (i % CMD_DUMP_LINE == CMD_DUMP_LINE - 1) {
+            TinyCmd_Report("\n");
+        }
+    }
+}
+
+static void dump(int mode)
+{
+    if (mode < 0) {
+        report_dump(memory, BLOCK);
+    } else {
+        TinyCmd_Dump(memory, BLOCK, (TinyCmd_DumpMode)mode);
+    }
+}
+
+//Fastest of BENCH_REPEAT runs of BLOCKS blocks, printed as bytes dumped per second
+static void bench_dump(const char* label, int mode)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        uint64_t t = bench_now();
+        for (int i = 0; i < BLOCKS; i++) {
+            dump(mode);
+        }
+        t = bench_now() - t;
+        if (t < best) {
+            best = t;
+        }
+    }
+    bench_bytes = 0;
+    dump(mode);
+    printf("%-44s %10.1f MB/s %8.2f bytes sent per byte\n", label,
+           (double)BLOCK * BLOCKS / ((double)best * 1e-9) / 1e6, (double)bench_bytes / BLOCK);
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = bench_send;
+    for (unsigned int i = 0; i < BLOCK; i++) {
+        memory[i] = (unsigned char)(i * 37 + (i >> 8));
+    }
+
+    printf("%d bytes dumped per call\n", BLOCK);
+    bench_dump("TinyCmd_Dump hex", TINYCMD_DUMP_HEX);
+    bench_dump("TinyCmd_Dump base64", TINYCMD_DUMP_BASE64);
+    bench_dump("TinyCmd_Report(\"%02X \") per byte", -1);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Fmt.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Time of TinyCmd_Report_Fmt() with format strings compiled once by TinyCmd_Fmt_Compile(), next to
+ * TinyCmd_Report() parsing the same format strings on every call, and the time of one compilation.
+ */
+
+// flags: -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Bench.h"
+
+#define CALLS 200000
+
+#define FMT_SPEED "at speed %d\n"
+#define FMT_MOTOR "motor pos %ld spd %ld i %d u %d\n"
+#define FMT_TEMP "temperature of the driver stage: %d.%02u C, limit %d C\n"
+
+static TinyCmd_Fmt speed_fmt;
+static TinyCmd_Fmt motor_fmt;
+static TinyCmd_Fmt temp_fmt;
+
+static void speed(unsigned long i, int compiled)
+{
+    if (compiled) {
+        TinyCmd_Report_Fmt(&speed_fmt, (int)(i % 3000));
+    } else {
+        TinyCmd_Report(FMT_SPEED, (int)(i % 3000));
+    }
+}
+
+static void motor(unsigned long i, int compiled)
+{
+    if (compiled) {
+        TinyCmd_Report_Fmt(&motor_fmt, (long)i * 3, (long)(i % 50), (int)(i % 200) - 100, 2400);
+    } else {
+        TinyCmd_Report(FMT_MOTOR, (long)i * 3, (long)(i % 50), (int)(i % 200) - 100, 2400);
+    }
+}
+
+static void temp(unsigned long i, int compiled)
+{
+    if (compiled) {
+        TinyCmd_Report_Fmt(&temp_fmt, (int)(i % 90), (unsigned int)(i % 100), 85);
+    } else {
+        TinyCmd_Report(FMT_TEMP, (int)(i % 90), (unsigned int)(i % 100), 85);
+    }
+}
+
+int main(void)
+{
+    TinyCmd_Fmt fmt;
+
+    TinyCmd_SendChar = bench_send;
+    TinyCmd_Fmt_Compile(&speed_fmt, FMT_SPEED);
+    TinyCmd_Fmt_Compile(&motor_fmt, FMT_MOTOR);
+    TinyCmd_Fmt_Compile(&temp_fmt, FMT_TEMP);
+
+    printf("one message per iteration\n");
+    BENCH("Report_Fmt    \"at speed %d\"", CALLS, speed(bench_i, 1));
+    BENCH("Report        \"at speed %d\"", CALLS, speed(bench_i, 0));
+    BENCH("Report_Fmt    \"motor pos %ld ...\"", CALLS, motor(bench_i, 1));
+    BENCH("Report        \"motor pos %ld ...\"", CALLS, motor(bench_i, 0));
+    BENCH("Report_Fmt    \"temperature of ...\"", CALLS, temp(bench_i, 1));
+    BENCH("Report        \"temperature of ...\"", CALLS, temp(bench_i, 0));
+    BENCH("Fmt_Compile   \"motor pos %ld ...\"", CALLS, TinyCmd_Fmt_Compile(&fmt, FMT_MOTOR));
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Hpp.cpp
+ * Author: Civic_Crab
+ *
+ * Description:
+ * The commands of demo.c run by the C table (TinyCmd_Add_Cmd, TinyCmd_Handler) and by the C++ front end
+ * (tinycmd::execute). Both receive the line one character at a time, as from a serial port, then run it.
+ * The command functions store their arguments instead of reporting them, so the time is the one of the parsing.
+ */
+
+// flags: -DCMD_NO_DEBUG_ECHO
+
+#include <cstring>
+#include "TinyCmd_Bench.h"
+#include "TinyCmd.hpp"
+
+#define LINES 200000
+
+static volatile unsigned int seen_key;
+static volatile unsigned int seen_int;
+static volatile float seen_float;
+
+//C table: the callbacks of demo.c
+static TinyCmd_CallBack_Ret c_cmd1(void)
+{
+    unsigned char arg_int = 0;
+    float arg_float = 0;
+
+    if (TinyCmd_Arg_Check("check", 0) == TINYCMD_SUCCESS) {
+        seen_key = 1;
+    } else if (TinyCmd_Arg_Check("check2", 0) == TINYCMD_SUCCESS) {
+        seen_key = 2;
+    }
+    if (TinyCmd_Arg_To_Num(1, &arg_int, TINYCMD_UINT8)) {
+        seen_int = arg_int;
+    }
+    if (TinyCmd_Arg_To_Num(2, &arg_float, TINYCMD_FLOAT)) {
+        seen_float = arg_float;
+    }
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_CallBack_Ret c_cmd2(void)
+{
+    seen_key = 0;
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Cmd1 = {.command = "cmd1", .callback = &c_cmd1};
+static TinyCmd_Command Cmd2 = {.command = "cmd2", .callback = &c_cmd2};
+
+//C++ front end: the same commands with typed parameters
+static bool cpp_cmd1(std::string_view key, std::uint8_t n, float f)
+{
+    if (key == "check") {
+        seen_key = 1;
+    } else if (key == "check2") {
+        seen_key = 2;
+    }
+    seen_int = n;
+    seen_float = f;
+    return true;
+}
+
+static void cpp_cmd2()
+{
+    seen_key = 0;
+}
+
+inline constexpr auto commands = tinycmd::table(
+    tinycmd::cmd<&cpp_cmd1>("cmd1"),
+    tinycmd::cmd<&cpp_cmd2>("cmd2"));
+
+static const char* const lines[] = {"cmd1 check 200 3.25\n", "cmd2\n", "cmd1 check2 7 -0.5\n"};
+#define LINE_COUNT (sizeof(lines) / sizeof(lines[0]))
+
+static void c_run(const char* line)
+{
+    for (; *line; line++) {
+        if (TinyCmd_PutChar(*line)) {
+            TinyCmd_Handler();
+        }
+    }
+}
+
+static void cpp_run(const char* line)
+{
+    static char buf[CMD_BUF_SIZE];
+    std::size_t len = 0;
+
+    for (; *line; line++) {
+        if (*line == '\n') {
+            tinycmd::execute<commands>(std::string_view(buf, len));
+            len = 0;
+        } else if (len < sizeof(buf)) {
+            buf[len++] = *line;
+        }
+    }
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = bench_send;
+    TinyCmd_Add_Cmd(&Cmd1);
+    TinyCmd_Add_Cmd(&Cmd2);
+
+    printf("demo.c commands, one line per iteration\n");
+    BENCH("C table", LINES, c_run(lines[bench_i % LINE_COUNT]));
+    BENCH("C++ tinycmd::execute", LINES, cpp_run(lines[bench_i % LINE_COUNT]));
+    return 0;
+}
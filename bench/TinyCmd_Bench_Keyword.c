@@ -0,0 +1,96 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Keyword.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Time of matching one argument against 5 and 10 keywords with TinyCmd_Arg_Keyword(), with and without case,
+ * next to the chain of TinyCmd_Arg_Check() calls a callback would write and a const table, which is not built
+ * and is compared one by one. The argument is each keyword in turn and a word matching none.
+ */
+
+// flags: -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Bench.h"
+
+#define CALLS 1000000
+
+static const char* const Words5[] = {"ON", "OFF", "Blink", "CW", "CCW"};
+static const char* const Words10[] = {"ON", "OFF", "Blink", "CW", "CCW", "Stop", "Home", "Speed", "Status", "Reset"};
+
+static TinyCmd_Keywords Keys5 = TINYCMD_KEYWORDS(Words5, 0);
+static TinyCmd_Keywords Keys5_Nocase = TINYCMD_KEYWORDS(Words5, 1);
+static TinyCmd_Keywords Keys10 = TINYCMD_KEYWORDS(Words10, 0);
+static TinyCmd_Keywords Keys10_Nocase = TINYCMD_KEYWORDS(Words10, 1);
+static const TinyCmd_Keywords Keys10_Const = TINYCMD_KEYWORDS(Words10, 1);
+
+//The arguments matched: each keyword, then one matching none
+static char args[11][8];
+
+static volatile int matched;
+
+static void set_arg(unsigned long i, TinyCmd_Counter_Type count)
+{
+    unsigned long k = i % (count + 1u);
+
+    TinyCmd_buf.arg[0] = args[k == count ? 10 : k];
+}
+
+static void keyword(unsigned long i, const TinyCmd_Keywords* keys)
+{
+    set_arg(i, keys->count);
+    matched = TinyCmd_Arg_Keyword(keys, 0);
+}
+
+//What the callbacks of main.c do: one TinyCmd_Arg_Check per keyword until one matches
+static void chain(unsigned long i, const char* const* words, TinyCmd_Counter_Type count)
+{
+    int found = -1;
+
+    set_arg(i, count);
+    for (TinyCmd_Counter_Type k = 0; k < count; k++) {
+        if (TinyCmd_Arg_Check(words[k], 0)) {
+            found = k;
+            break;
+        }
+    }
+    matched = found;
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = bench_send;
+    for (unsigned int i = 0; i < 10; i++) {
+        snprintf(args[i], sizeof(args[i]), "%s", Words10[i]);
+    }
+    snprintf(args[10], sizeof(args[10]), "Left");
+    TinyCmd_Keywords_Init(&Keys5);
+    TinyCmd_Keywords_Init(&Keys5_Nocase);
+    TinyCmd_Keywords_Init(&Keys10);
+    TinyCmd_Keywords_Init(&Keys10_Nocase);
+
+    printf("one argument matched per iteration\n");
+    BENCH(" 5 keywords: TinyCmd_Arg_Keyword", CALLS, keyword(bench_i, &Keys5));
+    BENCH(" 5 keywords: TinyCmd_Arg_Keyword, no case", CALLS, keyword(bench_i, &Keys5_Nocase));
+    BENCH(" 5 keywords: TinyCmd_Arg_Check chain", CALLS, chain(bench_i, Words5, 5));
+    BENCH("10 keywords: TinyCmd_Arg_Keyword", CALLS, keyword(bench_i, &Keys10));
+    BENCH("10 keywords: TinyCmd_Arg_Keyword, no case", CALLS, keyword(bench_i, &Keys10_Nocase));
+    BENCH("10 keywords: TinyCmd_Arg_Check chain", CALLS, chain(bench_i, Words10, 10));
+    BENCH("10 keywords: const table, no case", CALLS, keyword(bench_i, &Keys10_Const));
+    return 0;
+}
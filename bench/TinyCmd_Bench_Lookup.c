@@ -0,0 +1,120 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Lookup.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Time of one command line run by TinyCmd_Handler() from 16 to 256 commands, where the sorted list is binary
+ * searched, next to the time of a linear scan of the same names, which the sorted list replaces.
+ * The commands are added in a random order and looked up in another.
+ */
+
+// flags: -DCMD_USE_LARGE_BUFFER -DCMD_LIST_SIZE=256 -DCMD_NO_DEBUG_ECHO
+
+#include <string.h>
+#include "TinyCmd_Bench.h"
+
+#define COMMANDS 256
+#define LOOKUPS 100000
+//Lines looked up, in a random order
+#define TARGETS 1024
+
+static char names[COMMANDS][CMD_NAME_LENGTH + 1];
+static TinyCmd_Command commands[COMMANDS];
+static unsigned int added;
+static unsigned int targets[TARGETS];
+static uint32_t seed = 12345;
+
+static unsigned int rng(unsigned int range)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 8) % range;
+}
+
+static TinyCmd_CallBack_Ret run_callback(void)
+{
+    return TINYCMD_SUCCESS;
+}
+
+//Add the next commands up to count, in the random order of commands[], and pick the lines to look up
+static void add_up_to(unsigned int count)
+{
+    for (; added < count; added++) {
+        TinyCmd_Add_Cmd(&commands[added]);
+    }
+    for (unsigned int i = 0; i < TARGETS; i++) {
+        targets[i] = rng(count);
+    }
+}
+
+static void run_line(unsigned long i)
+{
+    const char* name = names[targets[i % TARGETS]];
+
+    while (*name != '\0') {
+        TinyCmd_PutChar(*name++);
+    }
+    TinyCmd_PutChar('\n');
+    TinyCmd_Handler();
+}
+
+static volatile unsigned int scan_found;
+
+//The lookup of an unsorted list: every name compared until the command is found
+static void linear_scan(unsigned long i)
+{
+    const char* name = names[targets[i % TARGETS]];
+    unsigned int j = 0;
+
+    while (j < added && strcmp(commands[j].command, name) != 0) {
+        j++;
+    }
+    scan_found = j;
+}
+
+int main(void)
+{
+    char label[64];
+    unsigned int order[COMMANDS];
+
+    TinyCmd_SendChar = bench_send;
+    for (unsigned int i = 0; i < COMMANDS; i++) {
+        order[i] = i;
+    }
+    for (unsigned int i = COMMANDS - 1; i > 0; i--) {
+        unsigned int j = rng(i + 1);
+        unsigned int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    for (unsigned int i = 0; i < COMMANDS; i++) {
+        snprintf(names[i], sizeof(names[0]), "cmd%03u", order[i]);
+        commands[i].command = names[i];
+        commands[i].callback = &run_callback;
+    }
+
+    printf("one command line per iteration\n");
+    for (unsigned int count = 16; count <= COMMANDS; count *= 2) {
+        add_up_to(count);
+        snprintf(label, sizeof(label), "%3u commands: TinyCmd_Handler", count);
+        BENCH(label, LOOKUPS, run_line(bench_i));
+        snprintf(label, sizeof(label), "%3u commands: linear scan alone", count);
+        BENCH(label, LOOKUPS, linear_scan(bench_i));
+    }
+    return 0;
+}
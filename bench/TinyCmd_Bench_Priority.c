@@ -0,0 +1,266 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Priority.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Worst case latency of "Motor stop" under a saturated output stream, in simulated time. A 115200 baud UART
+ * with a 256 byte TX ring sends "md" of 16 KB while the host sends "Motor stop" at 1000 points of it. The main
+ * loop blocks in the send while the ring is full, the bytes received meanwhile go to TinyCmd_PutChar() as the
+ * receive interrupt would. The output of urgent commands goes to a small second buffer the TX interrupt empties
+ * first. Printed: the worst and the median time from the '\n' of "Motor stop" to its callback and to the first byte
+ * of its answer on the wire, as an urgent and as a normal command. The time to the urgent callback is the host time
+ * of the receive interrupt up to it, so its worst case includes the preemptions of the host.
+ */
+
+// flags: -DCMD_USE_SUB -DCMD_USE_PRIORITY -DCMD_USE_DUMP -DCMD_NAME_LENGTH=16 -DCMD_NO_DEBUG_ECHO
+
+#include <stdlib.h>
+#include <string.h>
+#include "TinyCmd_Bench.h"
+
+//Time of one byte at 115200 baud 8N1, in ns
+#define BYTE_NS 86806ULL
+#define TX_RING 256
+#define DUMP_SIZE 16384
+#define POINTS 1000
+
+static const char stop_line[] = "Motor stop\n";
+static unsigned char memory[DUMP_SIZE];
+
+//UART************************************************************************//
+
+static unsigned long long now_ns;
+
+//Bytes queued by the main loop and by urgent commands, counted from the start; the wire sends urgent ones first
+static struct {
+    unsigned long long pushed;
+    unsigned long long sent;
+    unsigned int urgent;
+    //End of the byte on the wire, 0 while the wire is idle
+    unsigned long long busy_until;
+    //First byte of the answer: its number among the bulk bytes, its start on the wire
+    unsigned long long answer_seq;
+    unsigned long long answer_start;
+    int answer_urgent;
+} tx;
+
+//The host sending stop_line, byte k arrives at rx_start + (k + 1) * BYTE_NS
+static struct {
+    unsigned long long start;
+    unsigned int pos;
+    unsigned long long newline;
+    //Host time the receive interrupt of the '\n' started
+    uint64_t isr_start;
+} rx;
+
+//Simulated time of the callback, plus the host time from the start of the receive interrupt for an urgent one
+static unsigned long long callback_at;
+static unsigned int pending;
+
+static void wire_next(void)
+{
+    unsigned long long start = tx.busy_until > now_ns ? tx.busy_until : now_ns;
+
+    if (tx.urgent > 0) {
+        if (tx.answer_urgent && tx.answer_start == 0) {
+            tx.answer_start = start;
+        }
+        tx.urgent--;
+    } else if (tx.sent < tx.pushed) {
+        if (!tx.answer_urgent && tx.answer_start == 0 && tx.sent == tx.answer_seq && callback_at != 0) {
+            tx.answer_start = start;
+        }
+        tx.sent++;
+    } else {
+        tx.busy_until = 0;
+        return;
+    }
+    tx.busy_until = start + BYTE_NS;
+}
+
+static unsigned long long rx_next(void)
+{
+    return rx.pos < sizeof(stop_line) - 1 ? rx.start + (rx.pos + 1) * BYTE_NS : ~0ULL;
+}
+
+//Run the TX and receive interrupts up to time until
+static void advance_to(unsigned long long until)
+{
+    for (;;) {
+        unsigned long long tx_at = tx.busy_until != 0 ? tx.busy_until : ~0ULL;
+        unsigned long long rx_at = rx_next();
+
+        if (tx.busy_until != 0 && tx_at <= rx_at && tx_at <= until) {
+            now_ns = tx_at;
+            wire_next();
+        } else if (rx_at != ~0ULL && rx_at <= until) {
+            char c = stop_line[rx.pos++];
+
+            now_ns = rx_at;
+            if (c == '\n') {
+                rx.newline = now_ns;
+            }
+            rx.isr_start = bench_now();
+            if (TinyCmd_PutChar(c)) {
+                pending++;
+            }
+        } else {
+            break;
+        }
+    }
+    if (until != ~0ULL && until > now_ns) {
+        now_ns = until;
+    }
+}
+
+//The wire starts at once if it is idle
+static void tx_start(void)
+{
+    if (tx.busy_until == 0) {
+        wire_next();
+    }
+}
+
+//Output of the main loop: waits while the ring is full
+static void tx_put(char c)
+{
+    (void)c;
+    while (tx.pushed - tx.sent >= TX_RING) {
+        unsigned long long tx_at = tx.busy_until;
+        unsigned long long rx_at = rx_next();
+        advance_to(tx_at < rx_at ? tx_at : rx_at);
+    }
+    tx.pushed++;
+    tx_start();
+}
+
+//Output of urgent commands, from the receive interrupt
+static void urgent_put(char c)
+{
+    (void)c;
+    tx.urgent++;
+    tx_start();
+}
+
+//Commands********************************************************************//
+
+static TinyCmd_CallBack_Ret stop_callback(void)
+{
+    callback_at = now_ns;
+    if (tx.answer_urgent) {
+        callback_at += bench_now() - rx.isr_start;
+    }
+    tx.answer_seq = tx.pushed;
+    TinyCmd_Report("stopped\n");
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Stop = {.command = "stop", .callback = &stop_callback};
+static TinyCmd_Command* Motor_Sub[] = {&Stop};
+static TinyCmd_Command Motor = {.command = "Motor", TINYCMD_SUB(Motor_Sub)};
+
+//One run: "md" of DUMP_SIZE bytes, "Motor stop" starting at start
+static void run(unsigned long long start)
+{
+    char md[48];
+
+    memset(&tx, 0, sizeof(tx));
+    memset(&rx, 0, sizeof(rx));
+    tx.answer_urgent = Stop.priority == TINYCMD_PRIORITY_URGENT;
+    now_ns = 0;
+    callback_at = 0;
+    pending = 0;
+    rx.start = start;
+
+    snprintf(md, sizeof(md), "md 0x%lx %u\n", (unsigned long)(uintptr_t)memory, DUMP_SIZE);
+    for (const char* c = md; *c != '\0'; c++) {
+        TinyCmd_PutChar(*c);
+    }
+    TinyCmd_Handler();
+    while (pending > 0 || rx_next() != ~0ULL) {
+        if (pending > 0) {
+            pending--;
+            TinyCmd_Handler();
+        } else {
+            advance_to(rx_next());
+        }
+    }
+    advance_to(~0ULL);
+}
+
+//Length of the output of "md" on the wire, "Motor stop" comes long after it
+static unsigned long long md_time(void)
+{
+    run(~0ULL / 4);
+    return (tx.sent - (sizeof("stopped\n") - 1)) * BYTE_NS;
+}
+
+static int compare(const void* a, const void* b)
+{
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+static void print_delays(const char* label, const char* what, unsigned long long* delays)
+{
+    qsort(delays, POINTS, sizeof(delays[0]), compare);
+    printf("%-24s %-20s worst %12.3f ms, median %12.3f ms\n", label, what,
+           (double)delays[POINTS - 1] * 1e-6, (double)delays[POINTS / 2] * 1e-6);
+}
+
+static void measure(const char* label, unsigned long long span)
+{
+    static unsigned long long callback_delays[POINTS];
+    static unsigned long long answer_delays[POINTS];
+
+    for (unsigned int i = 0; i < POINTS; i++) {
+        run(span * i / POINTS);
+        if (callback_at == 0 || tx.answer_start == 0) {
+            printf("%s: \"Motor stop\" at point %u didn't run\n", label, i);
+            exit(1);
+        }
+        callback_delays[i] = callback_at - rx.newline;
+        answer_delays[i] = tx.answer_start - rx.newline;
+    }
+    print_delays(label, "callback", callback_delays);
+    print_delays(label, "answer on the wire", answer_delays);
+}
+
+int main(void)
+{
+    unsigned long long span;
+
+    TinyCmd_SendChar = tx_put;
+    TinyCmd_SendUrgent = urgent_put;
+    TinyCmd_Add_Cmd(&Motor);
+    TinyCmd_Add_Cmd(&TinyCmd_Dump_Cmd);
+    for (unsigned int i = 0; i < DUMP_SIZE; i++) {
+        memory[i] = (unsigned char)(i * 7);
+    }
+
+    span = md_time();
+    printf("md of %d bytes: %.2f s on the wire, \"Motor stop\" at %d points, time after its '\\n':\n",
+           DUMP_SIZE, (double)span * 1e-9, POINTS);
+    Stop.priority = TINYCMD_PRIORITY_URGENT;
+    measure("urgent \"Motor stop\"", span);
+    Stop.priority = TINYCMD_PRIORITY_NORMAL;
+    measure("normal \"Motor stop\"", span);
+    return 0;
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Script.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Lines per second run from a 1 MB bring-up script in a file mapped with mmap: by TinyCmd_Script_Run() from a
+ * private writable mapping, by TinyCmd_Script_Run_P() from a read-only one, and line by line through
+ * TinyCmd_PutChar() and TinyCmd_Handler() as the serial port would feed them (without the time on the wire).
+ * Then the same script compiled by tools/TinyCmd_Compile.py and run by TinyCmd_Compiled_Run(), which skips
+ * tokenizing, looking commands up and parsing numbers. It is run from the top of the tree, as "make bench" does.
+ */
+
+// flags: -DCMD_USE_SCRIPT -DCMD_NO_DEBUG_ECHO
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "TinyCmd_Bench.h"
+
+#define SCRIPT_SIZE (1UL << 20)
+
+static char script[SCRIPT_SIZE];
+static unsigned long script_len;
+static unsigned long script_lines;
+
+static unsigned long runs;
+static volatile long sink;
+
+static TinyCmd_CallBack_Ret set_callback(void)
+{
+    int32_t id = 0;
+    int32_t value = 0;
+
+    runs++;
+    if (!TinyCmd_Arg_To_Num(0, &id, TINYCMD_INT32) || !TinyCmd_Arg_To_Num(1, &value, TINYCMD_INT32)) {
+        return TINYCMD_FAILED;
+    }
+    sink += id + value;
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_CallBack_Ret gain_callback(void)
+{
+    float kp = 0;
+    float ki = 0;
+
+    runs++;
+    if (!TinyCmd_Arg_To_Num(0, &kp, TINYCMD_FLOAT) || !TinyCmd_Arg_To_Num(1, &ki, TINYCMD_FLOAT)) {
+        return TINYCMD_FAILED;
+    }
+    sink += (long)(kp * 1000 + ki);
+    return TINYCMD_SUCCESS;
+}
+
+static const char* const Led_Words[] = {"on", "off", "blink"};
+static TinyCmd_Keywords Led_Keys = TINYCMD_KEYWORDS(Led_Words, 1);
+
+static TinyCmd_CallBack_Ret led_callback(void)
+{
+    int word = TinyCmd_Arg_Keyword(&Led_Keys, 0);
+
+    runs++;
+    sink += word;
+    return word >= 0 ? TINYCMD_SUCCESS : TINYCMD_FAILED;
+}
+
+static TinyCmd_CallBack_Ret wr_callback(void)
+{
+    uint32_t addr = 0;
+    uint32_t value = 0;
+
+    runs++;
+    if (!TinyCmd_Arg_To_Num(0, &addr, TINYCMD_UINT32) || !TinyCmd_Arg_To_Num(1, &value, TINYCMD_UINT32)) {
+        return TINYCMD_FAILED;
+    }
+    sink += (long)(addr ^ value);
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Set = {.command = "set", .callback = &set_callback};
+static TinyCmd_Command Gain = {.command = "gain", .callback = &gain_callback};
+static TinyCmd_Command Led = {.command = "led", .callback = &led_callback};
+static TinyCmd_Command Wr = {.command = "wr", .callback = &wr_callback};
+
+//Lines of a bring-up sequence up to SCRIPT_SIZE, a comment now and then
+static void make_script(void)
+{
+    char line[64];
+    unsigned long i = 0;
+
+    for (;;) {
+        int n;
+        switch (i % 4) {
+        case 0:
+            n = snprintf(line, sizeof(line), "set %lu %ld\n", i % 64, (long)(i % 5000) - 2500);
+            break;
+        case 1:
+            n = snprintf(line, sizeof(line), "gain %.3f -%.2f\n", (double)(i % 1000) * 0.001, (double)(i % 7));
+            break;
+        case 2:
+            n = snprintf(line, sizeof(line), "led %s\n", Led_Words[i % 3]);
+            break;
+        default:
+            n = snprintf(line, sizeof(line), "wr 0x%04lX %lu\n", (i * 4) & 0xFFFF, i % 256);
+            break;
+        }
+        if (i % 50 == 49) {
+            n = snprintf(line, sizeof(line), "# step %lu\n", i);
+        }
+        if (script_len + n > SCRIPT_SIZE) {
+            break;
+        }
+        if (line[0] != '#') {
+            script_lines++;
+        }
+        memcpy(script + script_len, line, n);
+        script_len += n;
+        i++;
+    }
+}
+
+//The script written to a temporary file and mapped, read-only or private and writable
+static char* map_script(int writable)
+{
+    char path[] = "/tmp/TinyCmd_Bench_ScriptXXXXXX";
+    int fd = mkstemp(path);
+    char* map;
+
+    if (fd < 0 || write(fd, script, script_len) != (ssize_t)script_len) {
+        perror("script file");
+        exit(1);
+    }
+    map = mmap(NULL, script_len, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    unlink(path);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    return map;
+}
+
+//The script compiled by tools/TinyCmd_Compile.py and mapped read-only, NULL if python3 can't run it
+static const unsigned char* map_compiled(unsigned long* len)
+{
+    char text[] = "/tmp/TinyCmd_Bench_ScriptXXXXXX";
+    char image[sizeof(text) + 4];
+    char command[192];
+    int fd = mkstemp(text);
+    const unsigned char* map = NULL;
+    off_t size;
+
+    if (fd < 0 || write(fd, script, script_len) != (ssize_t)script_len) {
+        perror("script file");
+        exit(1);
+    }
+    close(fd);
+    snprintf(image, sizeof(image), "%s.tcs", text);
+    snprintf(command, sizeof(command), "python3 tools/TinyCmd_Compile.py %s -o %s --max-params %d",
+             text, image, CMD_MAX_PARAMS);
+    if (system(command) == 0 && (fd = open(image, O_RDONLY)) >= 0) {
+        size = lseek(fd, 0, SEEK_END);
+        map = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            map = NULL;
+        }
+        *len = (unsigned long)size;
+    }
+    unlink(text);
+    unlink(image);
+    return map;
+}
+
+static void feed_lines(const char* text, unsigned long len)
+{
+    for (unsigned long i = 0; i < len; i++) {
+        if (TinyCmd_PutChar(text[i])) {
+            TinyCmd_Handler();
+        }
+    }
+}
+
+//Fastest of BENCH_REPEAT runs of the whole script, every line must run
+#define BENCH_SCRIPT(label, statement) do { \
+    uint64_t best = UINT64_MAX; \
+    for (int r = 0; r < BENCH_REPEAT; r++) { \
+        uint64_t t; \
+        runs = 0; \
+        t = bench_now(); \
+        statement; \
+        t = bench_now() - t; \
+        if (runs != script_lines) { \
+            printf("%s: %lu lines run, %lu expected\n", (label), runs, script_lines); \
+            exit(1); \
+        } \
+        if (t < best) { \
+            best = t; \
+        } \
+    } \
+    bench_print((label), script_lines, best); \
+} while (0)
+
+int main(void)
+{
+    char* writable;
+    char* read_only;
+    const unsigned char* image;
+    unsigned long image_len = 0;
+    const TinyCmd_Command* cmds[8];
+    TinyCmd_Compiled compiled;
+
+    TinyCmd_SendChar = bench_send;
+    TinyCmd_Keywords_Init(&Led_Keys);
+    TinyCmd_Add_Cmd(&Set);
+    TinyCmd_Add_Cmd(&Gain);
+    TinyCmd_Add_Cmd(&Led);
+    TinyCmd_Add_Cmd(&Wr);
+    make_script();
+    writable = map_script(1);
+    read_only = map_script(0);
+
+    printf("%lu byte script, %lu command lines, time per line\n", script_len, script_lines);
+    BENCH_SCRIPT("TinyCmd_Script_Run, private mapping", TinyCmd_Script_Run(writable, script_len, TINYCMD_SUCCESS));
+    BENCH_SCRIPT("TinyCmd_Script_Run_P, read-only mapping",
+                 TinyCmd_Script_Run_P(read_only, script_len, TINYCMD_SUCCESS));
+    BENCH_SCRIPT("TinyCmd_PutChar and TinyCmd_Handler", feed_lines(read_only, script_len));
+
+    image = map_compiled(&image_len);
+    if (image == NULL) {
+        printf("TinyCmd_Compiled_Run: skipped, python3 tools/TinyCmd_Compile.py failed\n");
+    } else if (!TinyCmd_Compiled_Load(&compiled, image, image_len, cmds, sizeof(cmds) / sizeof(cmds[0]))) {
+        printf("TinyCmd_Compiled_Load failed\n");
+        return 1;
+    } else {
+        printf("%lu byte compiled script\n", image_len);
+        BENCH_SCRIPT("TinyCmd_Compiled_Run, read-only mapping", TinyCmd_Compiled_Run(&compiled, TINYCMD_SUCCESS));
+        munmap((void*)image, image_len);
+    }
+
+    munmap(writable, script_len);
+    munmap(read_only, script_len);
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Stream.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Sustained rate of the variable stream: one row of 8 variables sampled by TinyCmd_Stream_Tick() and sent by
+ * TinyCmd_Stream_Flush(), as binary frames and as delta text, next to the same row sent by TinyCmd_Report.
+ */
+
+// flags: -DCMD_USE_STREAM -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Bench.h"
+
+#define ROWS 200000
+#define VARS 8
+
+static volatile int16_t current;
+static volatile int16_t voltage;
+static volatile int32_t position;
+static volatile int32_t speed;
+static volatile uint8_t state;
+static volatile uint16_t adc;
+static volatile float temperature;
+static volatile float duty;
+
+static TinyCmd_Var Vars[VARS] = {
+    {.name = "i", .ptr = &current, .type = TINYCMD_INT16, .scale = 1},
+    {.name = "u", .ptr = &voltage, .type = TINYCMD_INT16, .scale = 1},
+    {.name = "pos", .ptr = &position, .type = TINYCMD_INT32, .scale = 1},
+    {.name = "spd", .ptr = &speed, .type = TINYCMD_INT32, .scale = 1},
+    {.name = "st", .ptr = &state, .type = TINYCMD_UINT8, .scale = 1},
+    {.name = "adc", .ptr = &adc, .type = TINYCMD_UINT16, .scale = 1},
+    {.name = "temp", .ptr = &temperature, .type = TINYCMD_FLOAT, .scale = 100},
+    {.name = "duty", .ptr = &duty, .type = TINYCMD_FLOAT, .scale = 1000},
+};
+
+//The variables move a little every sample, as a control loop would
+static void step(unsigned long i)
+{
+    current = (int16_t)(i % 200 - 100);
+    voltage = (int16_t)(2400 + i % 7);
+    position += 3;
+    speed = (int32_t)(i % 50);
+    state = (uint8_t)(i >> 10);
+    adc = (uint16_t)(i * 13);
+    temperature = 25.0f + (float)(i % 100) * 0.01f;
+    duty = 0.5f;
+}
+
+//One row sampled, the ring buffer flushed every 16 rows
+static void stream_row(unsigned long i)
+{
+    step(i);
+    TinyCmd_Stream_Tick();
+    if ((i & 15) == 15) {
+        TinyCmd_Stream_Flush();
+    }
+}
+
+static void report_row(unsigned long i)
+{
+    step(i);
+    TinyCmd_Report("%d %d %ld %ld %u %u %ld %ld\n", current, voltage, (long)position, (long)speed,
+                   state, adc, (long)(temperature * 100), (long)(duty * 1000));
+}
+
+static void bytes_per_row(const char* label, void (*row)(unsigned long))
+{
+    bench_bytes = 0;
+    for (unsigned long i = 0; i < ROWS; i++) {
+        row(i);
+    }
+    printf("%-44s %10.1f bytes per row\n", label, (double)bench_bytes / ROWS);
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = bench_send;
+    for (int i = 0; i < VARS; i++) {
+        TinyCmd_Var_Add(&Vars[i]);
+        TinyCmd_Stream_Select(Vars[i].name, TINYCMD_SUCCESS);
+    }
+
+    printf("one row of %d variables (%d samples) per iteration\n", VARS, VARS);
+    TinyCmd_Stream_Start(1, TINYCMD_STREAM_BIN);
+    BENCH("stream binary", ROWS, stream_row(bench_i));
+    bytes_per_row("stream binary", stream_row);
+    TinyCmd_Stream_Start(1, TINYCMD_STREAM_TEXT);
+    BENCH("stream delta text", ROWS, stream_row(bench_i));
+    bytes_per_row("stream delta text", stream_row);
+    TinyCmd_Stream_Stop();
+    BENCH("TinyCmd_Report", ROWS, report_row(bench_i));
+    bytes_per_row("TinyCmd_Report", report_row);
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Sub.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Time of one command line walking a subcommand tree, 1 to 3 levels deep with 8 to 64 siblings on each level,
+ * next to the same line dispatched by hand in one callback with chains of TinyCmd_Arg_Check().
+ * The siblings of a level share one table, so the tree stays small.
+ */
+
+// flags: -DCMD_USE_SUB -DCMD_MAX_TOKENS=8 -DCMD_LIST_SIZE=32 -DCMD_NO_DEBUG_ECHO
+
+#include <stdlib.h>
+#include <string.h>
+#include "TinyCmd_Bench.h"
+
+#define MAX_DEPTH 3
+#define MAX_SIBLINGS 64
+#define LINES 100000
+//Lines run, paths picked at random
+#define PATHS 1024
+
+static char sibling_names[MAX_SIBLINGS][4];
+static uint32_t seed = 12345;
+
+static unsigned int rng(unsigned int range)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 8) % range;
+}
+
+static volatile unsigned long leaf_runs;
+
+static TinyCmd_CallBack_Ret leaf_callback(void)
+{
+    leaf_runs++;
+    return TINYCMD_SUCCESS;
+}
+
+//Depth and siblings of the tree the hand dispatch walks
+static unsigned int hand_depth;
+static unsigned int hand_siblings;
+
+//What a callback does without subcommands: each level a chain of string compares
+static TinyCmd_CallBack_Ret hand_callback(void)
+{
+    for (unsigned int level = 0; level < hand_depth; level++) {
+        unsigned int i = 0;
+        while (i < hand_siblings && !TinyCmd_Arg_Check(sibling_names[i], (TinyCmd_Counter_Type)level)) {
+            i++;
+        }
+        if (i == hand_siblings) {
+            return TINYCMD_FAILED;
+        }
+    }
+    leaf_runs++;
+    return TINYCMD_SUCCESS;
+}
+
+//A tree of depth levels below root, the siblings listed in reverse order for TinyCmd_Add_Cmd() to sort
+static void build_tree(TinyCmd_Command* root, unsigned int depth, unsigned int siblings)
+{
+    TinyCmd_Command** below = NULL;
+
+    for (unsigned int level = depth; level > 0; level--) {
+        TinyCmd_Command* nodes = calloc(siblings, sizeof(TinyCmd_Command));
+        TinyCmd_Command** table = calloc(siblings, sizeof(TinyCmd_Command*));
+        for (unsigned int i = 0; i < siblings; i++) {
+            nodes[i].command = sibling_names[siblings - 1 - i];
+            if (below != NULL) {
+                nodes[i].sub = below;
+                nodes[i].sub_count = (TinyCmd_Counter_Type)siblings;
+            } else {
+                nodes[i].callback = &leaf_callback;
+            }
+            table[i] = &nodes[i];
+        }
+        below = table;
+    }
+    root->sub = below;
+    root->sub_count = (TinyCmd_Counter_Type)siblings;
+}
+
+static char lines[PATHS][64];
+
+static void make_lines(const char* root, unsigned int depth, unsigned int siblings)
+{
+    for (unsigned int p = 0; p < PATHS; p++) {
+        int n = snprintf(lines[p], sizeof(lines[p]), "%s", root);
+        for (unsigned int level = 0; level < depth; level++) {
+            n += snprintf(lines[p] + n, sizeof(lines[p]) - n, " %s", sibling_names[rng(siblings)]);
+        }
+        snprintf(lines[p] + n, sizeof(lines[p]) - n, " 5\n");
+    }
+}
+
+//Every line must reach a leaf, or the bench measures an error path
+static void check_runs(unsigned long before)
+{
+    if (leaf_runs - before != (unsigned long)LINES * BENCH_REPEAT) {
+        printf("lines not reaching a leaf: %lu\n", (unsigned long)LINES * BENCH_REPEAT - (leaf_runs - before));
+        exit(1);
+    }
+}
+
+static void run_line(unsigned long i)
+{
+    const char* c = lines[i % PATHS];
+
+    while (*c != '\0') {
+        TinyCmd_PutChar(*c++);
+    }
+    TinyCmd_Handler();
+}
+
+int main(void)
+{
+    static const unsigned int sibling_counts[] = {8, 32, 64};
+    static char root_names[MAX_DEPTH * 3][8];
+    static TinyCmd_Command roots[MAX_DEPTH * 3];
+    static TinyCmd_Command hand = {.command = "hand", .callback = &hand_callback};
+    unsigned int r = 0;
+    unsigned long runs;
+    char label[64];
+
+    TinyCmd_SendChar = bench_send;
+    for (unsigned int i = 0; i < MAX_SIBLINGS; i++) {
+        snprintf(sibling_names[i], sizeof(sibling_names[i]), "s%02u", i);
+    }
+    TinyCmd_Add_Cmd(&hand);
+
+    printf("one command line per iteration\n");
+    for (unsigned int depth = 1; depth <= MAX_DEPTH; depth++) {
+        for (unsigned int s = 0; s < sizeof(sibling_counts) / sizeof(sibling_counts[0]); s++, r++) {
+            unsigned int siblings = sibling_counts[s];
+
+            snprintf(root_names[r], sizeof(root_names[r]), "d%us%u", depth, siblings);
+            roots[r].command = root_names[r];
+            build_tree(&roots[r], depth, siblings);
+            TinyCmd_Add_Cmd(&roots[r]);
+
+            make_lines(root_names[r], depth, siblings);
+            snprintf(label, sizeof(label), "depth %u, %2u siblings: subcommand tree", depth, siblings);
+            runs = leaf_runs;
+            BENCH(label, LINES, run_line(bench_i));
+            check_runs(runs);
+
+            //The same paths under "hand"
+            for (unsigned int p = 0; p < PATHS; p++) {
+                char* rest = strchr(lines[p], ' ');
+                char copy[64];
+                snprintf(copy, sizeof(copy), "hand%s", rest);
+                memcpy(lines[p], copy, sizeof(copy));
+            }
+            hand_depth = depth;
+            hand_siblings = siblings;
+            snprintf(label, sizeof(label), "depth %u, %2u siblings: Arg_Check chains", depth, siblings);
+            runs = leaf_runs;
+            BENCH(label, LINES, run_line(bench_i));
+            check_runs(runs);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Bench_Tokenize.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Throughput of the large buffer mode: one line from 256 bytes to 64 KB, received by TinyCmd_PutChar() and
+ * tokenized by TinyCmd_Handler() into as many as CMD_MAX_PARAMS arguments. The bytes per second stay flat
+ * when the cost is linear in the length of the line.
+ */
+
+// flags: -DCMD_USE_LARGE_BUFFER -DCMD_NO_DEBUG_ECHO
+
+#include <stdlib.h>
+#include <string.h>
+#include "TinyCmd_Bench.h"
+
+//Bytes run per size, so every size takes about as long
+#define TOTAL_BYTES (16UL << 20)
+
+static char line[CMD_BUF_SIZE];
+static size_t line_len;
+static size_t expected_args;
+
+static volatile size_t arg_bytes;
+
+static TinyCmd_CallBack_Ret sum_callback(void)
+{
+    size_t args = 0;
+    size_t bytes = 0;
+
+    while (args < CMD_MAX_PARAMS && TinyCmd_buf.arg[args] != NULL) {
+        bytes += TinyCmd_Arg_Get_Len((TinyCmd_Counter_Type)args);
+        args++;
+    }
+    if (args != expected_args) {
+        printf("%lu arguments, %lu expected\n", (unsigned long)args, (unsigned long)expected_args);
+        exit(1);
+    }
+    arg_bytes = bytes;
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Sum = {.command = "sum", .callback = &sum_callback};
+
+//"sum" and the most arguments of 8 bytes or more the line holds, the last one padded to the size
+static void make_line(size_t size)
+{
+    size_t args = (size - 5) / 9;
+    size_t pos;
+
+    if (args > CMD_MAX_PARAMS) {
+        args = CMD_MAX_PARAMS;
+    }
+    pos = (size_t)snprintf(line, sizeof(line), "sum");
+    for (size_t a = 0; a < args; a++) {
+        size_t width = (size - 1 - pos) / (args - a) - 1;
+        line[pos++] = ' ';
+        for (size_t c = 0; c < width; c++) {
+            line[pos++] = (char)('0' + (a + c) % 10);
+        }
+    }
+    line[pos++] = '\n';
+    line_len = pos;
+    expected_args = args;
+}
+
+static void run_line(void)
+{
+    for (size_t i = 0; i < line_len; i++) {
+        TinyCmd_PutChar(line[i]);
+    }
+    TinyCmd_Handler();
+}
+
+int main(void)
+{
+    static const size_t sizes[] = {256, 1024, 4096, 16384, CMD_BUF_SIZE - 1};
+    char label[64];
+
+    TinyCmd_SendChar = bench_send;
+    TinyCmd_Add_Cmd(&Sum);
+
+    printf("one line per iteration\n");
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        unsigned long lines = TOTAL_BYTES / sizes[s];
+        uint64_t best = UINT64_MAX;
+
+        make_line(sizes[s]);
+        for (int r = 0; r < BENCH_REPEAT; r++) {
+            uint64_t t = bench_now();
+            for (unsigned long i = 0; i < lines; i++) {
+                run_line();
+            }
+            t = bench_now() - t;
+            if (t < best) {
+                best = t;
+            }
+        }
+        snprintf(label, sizeof(label), "%5lu bytes, %3lu arguments", (unsigned long)line_len,
+                 (unsigned long)expected_args);
+        printf("%-44s %10.1f ns %10.1f MB/s\n", label, (double)best / lines,
+               (double)line_len * lines / ((double)best * 1e-9) / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Size_C.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * The commands of demo.c on the C table, read from stdin. "make size" builds it next to TinyCmd_Size_Hpp.cpp,
+ * the same program on the C++ front end, and prints the flash (text, data) and RAM (data, bss) of both.
+ */
+
+#include <stdio.h>
+#include "TinyCmd.h"
+
+static volatile unsigned int seen_key;
+static volatile unsigned int seen_int;
+static volatile float seen_float;
+
+static TinyCmd_CallBack_Ret Cmd1_Callback(void)
+{
+    unsigned char arg_int = 0;
+    float arg_float = 0;
+
+    if (TinyCmd_Arg_Check("check", 0) == TINYCMD_SUCCESS) {
+        seen_key = 1;
+    } else if (TinyCmd_Arg_Check("check2", 0) == TINYCMD_SUCCESS) {
+        seen_key = 2;
+    }
+    if (TinyCmd_Arg_To_Num(1, &arg_int, TINYCMD_UINT8)) {
+        seen_int = arg_int;
+    }
+    if (TinyCmd_Arg_To_Num(2, &arg_float, TINYCMD_FLOAT)) {
+        seen_float = arg_float;
+    }
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_CallBack_Ret Cmd2_Callback(void)
+{
+    seen_key = 0;
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Cmd1 = {.command = "cmd1", .callback = &Cmd1_Callback};
+static TinyCmd_Command Cmd2 = {.command = "cmd2", .callback = &Cmd2_Callback};
+
+int main(void)
+{
+    int c;
+
+    TinyCmd_Add_Cmd(&Cmd1);
+    TinyCmd_Add_Cmd(&Cmd2);
+    while ((c = getchar()) != EOF) {
+        if (TinyCmd_PutChar((char)c)) {
+            TinyCmd_Handler();
+        }
+    }
+    return (int)seen_key;
+}
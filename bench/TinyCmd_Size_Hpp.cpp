@@ -0,0 +1,68 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Size_Hpp.cpp
+ * Author: Civic_Crab
+ *
+ * Description:
+ * The commands of demo.c on the C++ front end, read from stdin. See TinyCmd_Size_C.c.
+ */
+
+#include <cstdio>
+#include "TinyCmd.hpp"
+
+static volatile unsigned int seen_key;
+static volatile unsigned int seen_int;
+static volatile float seen_float;
+
+static bool cmd1(std::string_view key, std::uint8_t n, float f)
+{
+    if (key == "check") {
+        seen_key = 1;
+    } else if (key == "check2") {
+        seen_key = 2;
+    }
+    seen_int = n;
+    seen_float = f;
+    return true;
+}
+
+static void cmd2()
+{
+    seen_key = 0;
+}
+
+inline constexpr auto commands = tinycmd::table(
+    tinycmd::cmd<&cmd1>("cmd1"),
+    tinycmd::cmd<&cmd2>("cmd2"));
+
+int main()
+{
+    static char line[CMD_BUF_SIZE];
+    std::size_t len = 0;
+    int c;
+
+    while ((c = std::getchar()) != EOF) {
+        if (c == '\n' || c == '\r') {
+            tinycmd::execute<commands>(std::string_view(line, len));
+            len = 0;
+        } else if (len < sizeof(line)) {
+            line[len++] = static_cast<char>(c);
+        }
+    }
+    return static_cast<int>(seen_key);
+}
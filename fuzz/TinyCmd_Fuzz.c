@@ -0,0 +1,261 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Fuzz.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Fuzz target of the parsing pipeline: the input bytes are received by TinyCmd_PutChar() as from a serial port,
+ * and the complete lines are run by TinyCmd_Handler() as the main loop would.
+ * The first byte of the input sets how many bytes arrive between two runs of the main loop, so lines also
+ * queue up behind a running one (CMD_USE_PRIORITY, CMD_USE_FLOW).
+ *
+ *   make fuzz          libFuzzer build (clang), runs on a copy of fuzz/corpus
+ *   make fuzz-replay   GCC build with AddressSanitizer and UndefinedBehaviorSanitizer, replays fuzz/corpus and
+ *                      random mutations of it in every configuration of the Makefile
+ *
+ * Built with TINYCMD_FUZZ_MAIN the file has its own main():
+ *   TinyCmd_Fuzz [-r runs] file...   runs each file, then runs random mutations of the files
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "TinyCmd.h"
+
+static unsigned long fuzz_output;
+
+static void fuzz_send(char c)
+{
+    fuzz_output += (unsigned char)c;
+}
+
+//Reads every argument as every number type and reports them, as a command would
+static TinyCmd_CallBack_Ret fuzz_num(void)
+{
+    unsigned char value[16];
+
+    for (TinyCmd_Counter_Type p = 0; p < CMD_MAX_PARAMS; p++) {
+        for (int t = 0; t <= TINYCMD_DOUBLE; t++) {
+            TinyCmd_Arg_To_Num(p, value, (TinyCmd_NumType)t);
+        }
+        TinyCmd_Arg_Check("on", p);
+        TinyCmd_Arg_Get_Len(p);
+    }
+    TinyCmd_Report("%s %-5s|%8s|%d\n", TinyCmd_buf.arg[0], TinyCmd_buf.arg[1], TinyCmd_buf.arg[CMD_MAX_PARAMS - 1],
+                   (int)TinyCmd_Arg_Get_Len(0));
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_CallBack_Ret fuzz_ok(void)
+{
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Fuzz_Num = {.command = "n", .callback = &fuzz_num};
+#ifdef CMD_USE_SUB
+static TinyCmd_CallBack_Ret fuzz_fail(void)
+{
+    return TINYCMD_FAILED;
+}
+
+static TinyCmd_Command Fuzz_On = {.command = "on", .callback = &fuzz_num};
+static TinyCmd_Command Fuzz_Off = {.command = "off", .callback = &fuzz_fail};
+static TinyCmd_Command* Fuzz_Led_Sub[] = {&Fuzz_On, &Fuzz_Off};
+static TinyCmd_Command Fuzz_Led = {.command = "LED", .callback = &fuzz_ok, TINYCMD_SUB(Fuzz_Led_Sub)};
+#else
+static TinyCmd_Command Fuzz_Led = {.command = "LED", .callback = &fuzz_ok};
+#endif //CMD_USE_SUB
+#ifdef CMD_USE_PRIORITY
+static TinyCmd_Command Fuzz_Stop = {.command = "stop", .callback = &fuzz_num, .priority = TINYCMD_PRIORITY_URGENT};
+#endif //CMD_USE_PRIORITY
+#ifdef CMD_USE_SCRIPT
+//A script run from a command, so a script runs while the line calling it and the queued lines wait
+static const char Fuzz_Script[] = "n 1 -2\nLED on 3\n# comment\n\nLED off\nn 1.5e3";
+
+static TinyCmd_CallBack_Ret fuzz_script(void)
+{
+    TinyCmd_Script_Run_P(Fuzz_Script, sizeof(Fuzz_Script) - 1, TINYCMD_FAILED);
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Fuzz_Run = {.command = "run", .callback = &fuzz_script};
+#endif //CMD_USE_SCRIPT
+
+static void fuzz_init(void)
+{
+    TinyCmd_SendChar = fuzz_send;
+    TinyCmd_Add_Cmd(&Fuzz_Num);
+    TinyCmd_Add_Cmd(&Fuzz_Led);
+#ifdef CMD_USE_PRIORITY
+    TinyCmd_SendUrgent = fuzz_send;
+    TinyCmd_Add_Cmd(&Fuzz_Stop);
+#endif //CMD_USE_PRIORITY
+#ifdef CMD_USE_SCRIPT
+    TinyCmd_Add_Cmd(&Fuzz_Run);
+#endif //CMD_USE_SCRIPT
+#ifdef CMD_USE_ALIAS
+    TinyCmd_Add_Cmd(&TinyCmd_Alias_Cmd);
+#endif //CMD_USE_ALIAS
+#ifdef CMD_USE_CACHE
+    TinyCmd_Add_Cmd(&TinyCmd_Cache_Cmd);
+#endif //CMD_USE_CACHE
+#ifdef CMD_USE_FLOW
+    TinyCmd_Add_Cmd(&TinyCmd_Flow_Cmd);
+#endif //CMD_USE_FLOW
+#ifdef CMD_USE_TIMING
+    TinyCmd_Add_Cmd(&TinyCmd_Timing_Cmd);
+#endif //CMD_USE_TIMING
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    static int ready;
+    size_t every;
+    size_t pending = 0;
+
+    if (!ready) {
+        fuzz_init();
+        ready = 1;
+    }
+    if (size == 0) {
+        return 0;
+    }
+    every = (data[0] & 0x0F) + 1;
+
+    for (size_t i = 1; i < size; i++) {
+        if (TinyCmd_PutChar((char)data[i])) {
+            pending++;
+        }
+        //The main loop gets to run
+        if (i % every == 0) {
+            for (; pending > 0; pending--) {
+                TinyCmd_Handler();
+            }
+        }
+    }
+
+    //End the last line and run what is left, the next input starts on an empty buffer
+    if (TinyCmd_PutChar('\n')) {
+        pending++;
+    }
+    for (; pending > 0; pending--) {
+        TinyCmd_Handler();
+    }
+    return 0;
+}
+
+#ifdef TINYCMD_FUZZ_MAIN
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FUZZ_MAX_INPUT 4096
+
+static uint64_t fuzz_seed = 88172645463325252ull;
+
+static unsigned int fuzz_random(void)
+{
+    fuzz_seed ^= fuzz_seed << 13;
+    fuzz_seed ^= fuzz_seed >> 7;
+    fuzz_seed ^= fuzz_seed << 17;
+    return (unsigned int)fuzz_seed;
+}
+
+//Flip, insert, delete or repeat a few bytes, or splice in a line ending
+static size_t fuzz_mutate(uint8_t* data, size_t size)
+{
+    static const char special[] = "\r\n \x1b[~;#-.eE0123456789\x7f\x08\t";
+    unsigned int count = fuzz_random() % 8 + 1;
+
+    while (count--) {
+        size_t pos = size ? fuzz_random() % size : 0;
+        switch (fuzz_random() % 5) {
+            case 0:
+                if (size) {
+                    data[pos] ^= (uint8_t)(1u << (fuzz_random() % 8));
+                }
+                break;
+            case 1:
+                if (size < FUZZ_MAX_INPUT) {
+                    memmove(data + pos + 1, data + pos, size - pos);
+                    data[pos] = (uint8_t)special[fuzz_random() % (sizeof(special) - 1)];
+                    size++;
+                }
+                break;
+            case 2:
+                if (size) {
+                    memmove(data + pos, data + pos + 1, size - pos - 1);
+                    size--;
+                }
+                break;
+            case 3:
+                if (size) {
+                    data[pos] = (uint8_t)fuzz_random();
+                }
+                break;
+            default: {
+                size_t len = fuzz_random() % 16;
+                if (pos + len <= size && size + len <= FUZZ_MAX_INPUT) {
+                    memmove(data + pos + len, data + pos, size - pos);
+                    size += len;
+                }
+                break;
+            }
+        }
+    }
+    return size;
+}
+
+int main(int argc, char** argv)
+{
+    static uint8_t inputs[64][FUZZ_MAX_INPUT];
+    static size_t sizes[64];
+    static uint8_t work[FUZZ_MAX_INPUT];
+    unsigned long runs = 0;
+    int count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        FILE* f;
+        if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            runs = strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+        f = fopen(argv[i], "rb");
+        if (f == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+        if (count < 64) {
+            sizes[count] = fread(inputs[count], 1, FUZZ_MAX_INPUT, f);
+            LLVMFuzzerTestOneInput(inputs[count], sizes[count]);
+            count++;
+        }
+        fclose(f);
+    }
+
+    for (unsigned long r = 0; r < runs && count > 0; r++) {
+        int pick = (int)(fuzz_random() % (unsigned int)count);
+        size_t size = sizes[pick];
+        memcpy(work, inputs[pick], size);
+        size = fuzz_mutate(work, size);
+        LLVMFuzzerTestOneInput(work, size);
+    }
+
+    printf("%d inputs, %lu mutations, output checksum %lu\n", count, runs, fuzz_output);
+    return 0;
+}
+#endif //TINYCMD_FUZZ_MAIN
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test.h
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Helpers of the host tests in tests/: checks that count the failures and keep going, and a capture of
+ * everything TinyCmd sends. Each test is one file built by "make test", its configuration is in its "// flags:" line.
+ */
+
+#ifndef __TINYCMD_TEST_H__
+#define __TINYCMD_TEST_H__
+
+#include <stdio.h>
+#include <string.h>
+#include "TinyCmd.h"
+
+#define TEST_OUT_SIZE 8192
+
+static int test_failed;
+static int test_checked;
+
+//Everything sent by TinyCmd_SendChar since the last test_clear(), as a string
+static char test_out[TEST_OUT_SIZE];
+static unsigned long test_out_len;
+
+static inline void test_send(char c)
+{
+    if (test_out_len < TEST_OUT_SIZE - 1) {
+        test_out[test_out_len] = c;
+    }
+    test_out_len++;
+    test_out[test_out_len < TEST_OUT_SIZE ? test_out_len : TEST_OUT_SIZE - 1] = '\0';
+}
+
+static inline void test_clear(void)
+{
+    test_out_len = 0;
+    test_out[0] = '\0';
+}
+
+//Feed a text to TinyCmd_PutChar as the receive interrupt would, running each complete line right away
+static inline void test_line(const char* text)
+{
+    for (; *text; text++) {
+        if (TinyCmd_PutChar(*text)) {
+            TinyCmd_Handler();
+        }
+    }
+}
+
+//CHECK(condition): count a failure and print where, the test goes on
+#define CHECK(cond) do { \
+    test_checked++; \
+    if (!(cond)) { \
+        test_failed++; \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+//CHECK_STR(got, expected): like CHECK for two strings, prints both
+#define CHECK_STR(got, expected) do { \
+    const char* test_got = (got); \
+    const char* test_exp = (expected); \
+    test_checked++; \
+    if (strcmp(test_got, test_exp) != 0) { \
+        test_failed++; \
+        printf("%s:%d: got \"%s\", expected \"%s\"\n", __FILE__, __LINE__, test_got, test_exp); \
+    } \
+} while (0)
+
+//Print the result, return it from main()
+static inline int test_end(void)
+{
+    printf("%d checks, %d failed\n", test_checked, test_failed);
+    return test_failed ? 1 : 0;
+}
+
+#endif // __TINYCMD_TEST_H__
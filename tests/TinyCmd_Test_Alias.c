@@ -0,0 +1,229 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Alias.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Aliases and macros: the words typed after an alias added to its last step, a definition longer than
+ * the tokens, aliases naming themselves or each other (a step is never expanded, so they stop at once),
+ * names that are refused, changes while a macro runs, and the arena filled to the last byte.
+ */
+
+// flags: -DCMD_USE_ALIAS -DCMD_NO_DEBUG_ECHO
+
+#include <stdlib.h>
+#include "TinyCmd_Test.h"
+
+//The commands run since the last run(), "name(arg|arg)" each
+static char ran[256];
+
+static void log_run(const char* name)
+{
+    snprintf(ran + strlen(ran), sizeof(ran) - strlen(ran), "%s(", name);
+    for (TinyCmd_Counter_Type i = 0; i < CMD_MAX_PARAMS && TinyCmd_buf.arg[i] != NULL; i++) {
+        snprintf(ran + strlen(ran), sizeof(ran) - strlen(ran), "%s%s", i ? "|" : "", TinyCmd_buf.arg[i]);
+    }
+    snprintf(ran + strlen(ran), sizeof(ran) - strlen(ran), ")");
+}
+
+static TinyCmd_CallBack_Ret Led_Callback(void)
+{
+    log_run("LED");
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_CallBack_Ret Motor_Callback(void)
+{
+    log_run("Motor");
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Led = {.command = "LED", .callback = &Led_Callback};
+static TinyCmd_Command Motor = {.command = "Motor", .callback = &Motor_Callback};
+
+//Run one line, return what TinyCmd_Handler() returned
+static TinyCmd_Status run(const char* line)
+{
+    TinyCmd_Status ret = TINYCMD_FAILED;
+
+    ran[0] = '\0';
+    test_clear();
+    for (; *line != '\0'; line++) {
+        if (TinyCmd_PutChar(*line)) {
+            ret = TinyCmd_Handler();
+        }
+    }
+    return ret;
+}
+
+//Bytes of the arena in use, from the listing
+static unsigned int arena_used(void)
+{
+    const char* p;
+
+    run("alias\n");
+    p = strstr(test_out, "arena ");
+    return p != NULL ? (unsigned int)strtoul(p + 6, NULL, 10) : ~0u;
+}
+
+static void check_append(void)
+{
+    CHECK(run("alias led LED\n") == TINYCMD_SUCCESS);
+    CHECK(run("led OFF\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED(OFF)");
+    CHECK(run("led\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED()");
+    CHECK(run("  led   on  2\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED(on|2)");
+
+    //Only the last step gets the words typed after the alias
+    CHECK(run("alias go Motor start;LED ON\n") == TINYCMD_SUCCESS);
+    CHECK(run("go 5\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "Motor(start)LED(ON|5)");
+    CHECK(run("go\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "Motor(start)LED(ON)");
+
+    //The words after the tokens are kept in the text, the steps are tokenized when they run
+    CHECK(run("alias m Motor a b c d\n") == TINYCMD_SUCCESS);
+    run("alias\n");
+    CHECK(strstr(test_out, "m: Motor a b c d\n") != NULL);
+    CHECK(run("m\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "Motor(a|b|c)");
+
+    //A step and the rest of the line must fit into the step buffer
+    CHECK(run("alias long LED abcdefghijklmnop\n") == TINYCMD_SUCCESS);
+    CHECK(run("long abcdefghijklm\n") == TINYCMD_FAILED);
+    CHECK_STR(test_out, "alias: line too long\n");
+    CHECK_STR(ran, "");
+    CHECK(run("long abcdefghijkl\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED(abcdefghijklmnop|abcdefghijkl)");
+
+    CHECK(run("alias led\n") == TINYCMD_SUCCESS);
+    CHECK(run("alias go\n") == TINYCMD_SUCCESS);
+    CHECK(run("alias m\n") == TINYCMD_SUCCESS);
+    CHECK(run("alias long\n") == TINYCMD_SUCCESS);
+    CHECK(run("led OFF\n") == TINYCMD_FAILED);
+    CHECK_STR(ran, "");
+    CHECK(arena_used() == 0);
+}
+
+static void check_recursion(void)
+{
+    //A step is run as a command, an alias naming itself is not found as one
+    CHECK(run("alias loop loop\n") == TINYCMD_SUCCESS);
+    CHECK(run("loop 1\n") == TINYCMD_FAILED);
+    CHECK_STR(ran, "");
+    CHECK(run("alias loop LED 1;loop;LED 2\n") == TINYCMD_SUCCESS);
+    CHECK(run("loop\n") == TINYCMD_FAILED);
+    CHECK_STR(ran, "LED(1)");
+
+    //Two aliases naming each other stop at the first step
+    CHECK(run("alias a b\n") == TINYCMD_SUCCESS);
+    CHECK(run("alias b a;LED x\n") == TINYCMD_SUCCESS);
+    CHECK(run("a\n") == TINYCMD_FAILED);
+    CHECK_STR(ran, "");
+    CHECK(run("b\n") == TINYCMD_FAILED);
+    CHECK_STR(ran, "");
+
+    //A macro can't change the aliases while it runs, the arena holds its steps.
+    //A command whose callback refuses the arguments is still found, the handler returns TINYCMD_SUCCESS.
+    CHECK(run("alias mk LED 1;alias b LED;LED 2\n") == TINYCMD_SUCCESS);
+    CHECK(run("mk\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED(1)LED(2)");
+    CHECK_STR(test_out, "alias: busy\n");
+    CHECK(run("b\n") == TINYCMD_FAILED);
+
+    //An alias never hides a command and its name has no ';'
+    run("alias LED Motor\n");
+    CHECK_STR(test_out, "alias: bad name\n");
+    run("alias x;y LED\n");
+    CHECK_STR(test_out, "alias: bad name\n");
+    CHECK(run("x;y\n") == TINYCMD_FAILED);
+    CHECK(run("LED 1\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED(1)");
+
+    CHECK(run("alias loop\n") == TINYCMD_SUCCESS);
+    CHECK(run("alias a\n") == TINYCMD_SUCCESS);
+    CHECK(run("alias b\n") == TINYCMD_SUCCESS);
+    CHECK(run("alias mk\n") == TINYCMD_SUCCESS);
+    CHECK(arena_used() == 0);
+}
+
+static void check_arena(void)
+{
+    char line[CMD_BUF_SIZE + 8];
+    unsigned int used = 0;
+    unsigned int n = 0;
+
+    //"aN LED xxxxxxxxxxxxxxxxxxxx" takes 2 + 24 + 2 bytes
+    for (;;) {
+        snprintf(line, sizeof(line), "alias a%u LED xxxxxxxxxxxxxxxxxxxx\n", n % 10);
+        run(line);
+        if (test_out_len > 0) {
+            break;
+        }
+        used += 28;
+        n++;
+    }
+    CHECK(n == CMD_ALIAS_ARENA_SIZE / 28);
+    CHECK_STR(test_out, "alias: arena full\n");
+    CHECK(arena_used() == used);
+
+    //An alias filling the free bytes exactly fits, one byte more doesn't
+    CHECK(CMD_ALIAS_ARENA_SIZE - used == 16);
+    run("alias zz LED yyyyyyyyy\n");
+    CHECK_STR(test_out, "alias: arena full\n");
+    run("alias zz LED yyyyyyyy\n");
+    CHECK_STR(test_out, "");
+    CHECK(arena_used() == CMD_ALIAS_ARENA_SIZE);
+    run("alias z LED\n");
+    CHECK_STR(test_out, "alias: arena full\n");
+
+    //Redefining counts the bytes of the old entry as free
+    run("alias zz LED yyyyyyyyy\n");
+    CHECK_STR(test_out, "alias: arena full\n");
+    run("alias zz LED 0\n");
+    CHECK_STR(test_out, "");
+    CHECK(arena_used() == CMD_ALIAS_ARENA_SIZE - 16 + 9);
+
+    //Deleting moves the later aliases down, they still run
+    run("alias a1\n");
+    CHECK(arena_used() == CMD_ALIAS_ARENA_SIZE - 16 + 9 - 28);
+    CHECK(run("a0\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED(xxxxxxxxxxxxxxxxxxxx)");
+    CHECK(run("a2 2\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED(xxxxxxxxxxxxxxxxxxxx|2)");
+    CHECK(run("zz\n") == TINYCMD_SUCCESS);
+    CHECK_STR(ran, "LED(0)");
+    CHECK(run("a1\n") == TINYCMD_FAILED);
+    CHECK_STR(ran, "");
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+    CHECK(TinyCmd_Add_Cmd(&Led) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&Motor) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&TinyCmd_Alias_Cmd) == TINYCMD_SUCCESS);
+
+    check_append();
+    check_recursion();
+    check_arena();
+
+    return test_end();
+}
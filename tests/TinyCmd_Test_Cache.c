@@ -0,0 +1,296 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Cache.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * The response cache: a response replayed for the same arguments until cache_ms has passed, the least recently
+ * used slot replaced, a response that doesn't fit its slot sent but not kept, failed callbacks never kept,
+ * and TinyCmd_Cache_Clear() called by the callback while its own response is being kept.
+ */
+
+// flags: -DCMD_USE_CACHE -DCMD_NO_DEBUG_ECHO -DCMD_LIST_SIZE=8
+
+#include <stdlib.h>
+#include "TinyCmd_Test.h"
+
+static unsigned long millis_now;
+
+static unsigned long test_millis(void)
+{
+    return millis_now;
+}
+
+//Times each callback ran
+static unsigned int ver_runs;
+static unsigned int big_runs;
+static unsigned int get_runs;
+static unsigned int peek_runs;
+static unsigned int fail_runs;
+static int value = 1;
+
+static TinyCmd_CallBack_Ret Ver_Callback(void)
+{
+    ver_runs++;
+    TinyCmd_Report("ver");
+    for (TinyCmd_Counter_Type i = 0; i < CMD_MAX_PARAMS && TinyCmd_buf.arg[i] != NULL; i++) {
+        TinyCmd_Report(" %s", TinyCmd_buf.arg[i]);
+    }
+    TinyCmd_Report("\n");
+    return TINYCMD_SUCCESS;
+}
+
+//"big n": n characters
+static TinyCmd_CallBack_Ret Big_Callback(void)
+{
+    int n = atoi(TinyCmd_buf.arg[0]);
+
+    big_runs++;
+    while (n-- > 0) {
+        TinyCmd_Report("x");
+    }
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_CallBack_Ret Get_Callback(void)
+{
+    get_runs++;
+    TinyCmd_Report("value %d\n", value);
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Get;
+
+static TinyCmd_CallBack_Ret Set_Callback(void)
+{
+    value = atoi(TinyCmd_buf.arg[0]);
+    TinyCmd_Cache_Clear(&Get);
+    return TINYCMD_SUCCESS;
+}
+
+//Reads a value that changes while it reports
+static TinyCmd_CallBack_Ret Peek_Callback(void)
+{
+    peek_runs++;
+    TinyCmd_Report("before %d\n", value);
+    value++;
+    TinyCmd_Cache_Clear(NULL);
+    TinyCmd_Report("after %d\n", value);
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_CallBack_Ret Fail_Callback(void)
+{
+    fail_runs++;
+    TinyCmd_Report("no\n");
+    return TINYCMD_FAILED;
+}
+
+static TinyCmd_Command Ver = {.command = "ver", .callback = &Ver_Callback, .cache_ms = 100};
+static TinyCmd_Command Big = {.command = "big", .callback = &Big_Callback, .cache_ms = TINYCMD_CACHE_KEEP};
+static TinyCmd_Command Get = {.command = "get", .callback = &Get_Callback, .cache_ms = TINYCMD_CACHE_KEEP};
+static TinyCmd_Command Set = {.command = "set", .callback = &Set_Callback};
+static TinyCmd_Command Peek = {.command = "peek", .callback = &Peek_Callback, .cache_ms = TINYCMD_CACHE_KEEP};
+static TinyCmd_Command Fail = {.command = "fail", .callback = &Fail_Callback, .cache_ms = TINYCMD_CACHE_KEEP};
+
+//Run one line and return what it sent
+static const char* run(const char* line)
+{
+    test_clear();
+    test_line(line);
+    return test_out;
+}
+
+static void check_expiry(void)
+{
+    millis_now = 1000;
+    CHECK_STR(run("ver a\n"), "ver a\n");
+    CHECK(ver_runs == 1);
+
+    //Replayed until cache_ms has passed
+    millis_now = 1099;
+    CHECK_STR(run("ver a\n"), "ver a\n");
+    CHECK(ver_runs == 1);
+    millis_now = 1100;
+    CHECK_STR(run("ver a\n"), "ver a\n");
+    CHECK(ver_runs == 2);
+
+    //The time counts from the run, not from the replay
+    millis_now = 1199;
+    CHECK_STR(run("ver a\n"), "ver a\n");
+    CHECK(ver_runs == 2);
+
+    //Other arguments are another response
+    CHECK_STR(run("ver ab\n"), "ver ab\n");
+    CHECK_STR(run("ver a b\n"), "ver a b\n");
+    CHECK_STR(run("ver\n"), "ver\n");
+    CHECK(ver_runs == 5);
+    CHECK_STR(run("ver  a   b\n"), "ver a b\n");
+    CHECK(ver_runs == 5);
+
+    //CMD_MILLIS() wrapping around doesn't keep a response forever
+    TinyCmd_Cache_Clear(NULL);
+    millis_now = 0UL - 0x10;
+    run("ver w\n");
+    millis_now = 0x10;
+    run("ver w\n");
+    CHECK(ver_runs == 6);
+    millis_now = 0x30;
+    run("ver w\n");
+    CHECK(ver_runs == 6);
+    millis_now = 0x60;
+    run("ver w\n");
+    CHECK(ver_runs == 7);
+}
+
+static void check_lru(void)
+{
+    TinyCmd_Cache_Clear(NULL);
+    ver_runs = 0;
+
+    //Fill the 4 slots, then use "ver 1" again so "ver 2" is the least recently used
+    run("ver 1\n");
+    run("ver 2\n");
+    run("ver 3\n");
+    run("ver 4\n");
+    CHECK(ver_runs == CMD_CACHE_SLOTS);
+    run("ver 1\n");
+    CHECK(ver_runs == 4);
+    run("ver 5\n");
+    CHECK(ver_runs == 5);
+
+    run("ver 1\n");
+    run("ver 3\n");
+    run("ver 4\n");
+    CHECK_STR(run("ver 5\n"), "ver 5\n");
+    CHECK(ver_runs == 5);
+    CHECK_STR(run("ver 2\n"), "ver 2\n");
+    CHECK(ver_runs == 6);
+
+    //"ver 2" replaced "ver 1", the oldest in use since
+    run("ver 3\n");
+    run("ver 4\n");
+    run("ver 5\n");
+    run("ver 2\n");
+    CHECK(ver_runs == 6);
+    run("ver 1\n");
+    CHECK(ver_runs == 7);
+
+    //Commands without cache_ms take no slot
+    run("set 1\n");
+    run("ver 2\n");
+    CHECK(ver_runs == 7);
+}
+
+//The count of responses too big to keep, from "cache"
+static unsigned int too_big(void)
+{
+    const char* p = strstr(run("cache\n"), "big ");
+
+    return p != NULL ? (unsigned int)strtoul(p + 4, NULL, 10) : ~0u;
+}
+
+static void check_size(void)
+{
+    char expected[CMD_CACHE_SLOT_SIZE + 2];
+    unsigned int big = too_big();
+
+    TinyCmd_Cache_Clear(NULL);
+    memset(expected, 'x', sizeof(expected));
+
+    //"61\0" and 61 characters fill the slot exactly
+    expected[61] = '\0';
+    CHECK_STR(run("big 61\n"), expected);
+    CHECK_STR(run("big 61\n"), expected);
+    CHECK(big_runs == 1);
+
+    //One more doesn't fit, it is sent every time and never kept
+    expected[61] = 'x';
+    expected[62] = '\0';
+    CHECK_STR(run("big 62\n"), expected);
+    CHECK_STR(run("big 62\n"), expected);
+    CHECK(big_runs == 3);
+    CHECK_STR(run("big 61\n"), "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx");
+    CHECK(big_runs == 3);
+
+    //A response far bigger than the slot
+    memset(expected, 'x', sizeof(expected));
+    expected[sizeof(expected) - 1] = '\0';
+    CHECK_STR(run("big 65\n"), expected);
+    CHECK(big_runs == 4);
+
+    //A failed callback is run again
+    CHECK_STR(run("fail\n"), "no\n");
+    CHECK_STR(run("fail\n"), "no\n");
+    CHECK(fail_runs == 2);
+
+    CHECK(too_big() == big + 3);
+    CHECK(strstr(test_out, " slots 1/4\n") != NULL);
+}
+
+static void check_clear(void)
+{
+    TinyCmd_Cache_Clear(NULL);
+    value = 1;
+
+    CHECK_STR(run("get\n"), "value 1\n");
+    CHECK_STR(run("get\n"), "value 1\n");
+    CHECK(get_runs == 1);
+
+    //"set" drops the response of "get"
+    run("set 2\n");
+    CHECK_STR(run("get\n"), "value 2\n");
+    CHECK(get_runs == 2);
+    CHECK_STR(run("get\n"), "value 2\n");
+    CHECK(get_runs == 2);
+
+    //Clearing while the response is kept: the part sent before is older than the change, it is not kept
+    CHECK_STR(run("peek\n"), "before 2\nafter 3\n");
+    CHECK_STR(run("peek\n"), "before 3\nafter 4\n");
+    CHECK(peek_runs == 2);
+
+    //The clear from "peek" dropped "get", the next lines are kept again
+    CHECK_STR(run("get\n"), "value 4\n");
+    CHECK(get_runs == 3);
+    CHECK_STR(run("get\n"), "value 4\n");
+    CHECK(get_runs == 3);
+
+    run("cache clear\n");
+    CHECK_STR(run("get\n"), "value 4\n");
+    CHECK(get_runs == 4);
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+    TinyCmd_Millis = test_millis;
+    CHECK(TinyCmd_Add_Cmd(&Ver) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&Big) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&Get) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&Set) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&Peek) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&Fail) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&TinyCmd_Cache_Cmd) == TINYCMD_SUCCESS);
+
+    check_expiry();
+    check_lru();
+    check_size();
+    check_clear();
+
+    return test_end();
+}
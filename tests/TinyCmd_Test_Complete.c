@@ -0,0 +1,296 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Complete.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Tab completion of the line editor over 500 commands added in random order: unique and common prefixes,
+ * case, listing, subcommands, keywords and no candidate. Then the latency of one Tab is measured and printed
+ * next to a linear scan of the same names, which the sorted command list replaces.
+ * CMD_USE_SECTION is on with no command registered, so the empty section is searched too.
+ */
+
+// flags: -DCMD_USE_LINE_EDIT -DCMD_USE_SUB -DCMD_USE_SECTION -DCMD_USE_LARGE_BUFFER -DCMD_LIST_SIZE=512 -DCMD_NO_DEBUG_ECHO
+
+#include <stdint.h>
+#include <strings.h>
+#include <time.h>
+#include "TinyCmd_Test.h"
+
+#define COMMANDS 500
+#define CMD_NUMBERED 400
+#define NET_NUMBERED 94
+
+static char names[COMMANDS][CMD_NAME_LENGTH + 1];
+static TinyCmd_Command commands[COMMANDS];
+static unsigned int command_count;
+static int run_count;
+
+static TinyCmd_CallBack_Ret run_callback(void)
+{
+    run_count++;
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Speed = {.command = "speed", .callback = &run_callback};
+static TinyCmd_Command Spin = {.command = "spin", .callback = &run_callback};
+static TinyCmd_Command Stop = {.command = "stop", .callback = &run_callback};
+static TinyCmd_Command Start = {.command = "start", .callback = &run_callback};
+static TinyCmd_Command* Motor_Sub[] = {&Stop, &Speed, &Start, &Spin};
+
+static const char* const Led_Words[] = {"on", "off", "blink"};
+static TinyCmd_Keywords Led_Keys = TINYCMD_KEYWORDS(Led_Words, 1);
+
+static void add_command(const char* name)
+{
+    TinyCmd_Command* cmd = &commands[command_count];
+
+    snprintf(names[command_count], sizeof(names[0]), "%s", name);
+    cmd->command = names[command_count];
+    cmd->callback = &run_callback;
+    if (!strcmp(name, "motor")) {
+        cmd->sub = Motor_Sub;
+        cmd->sub_count = sizeof(Motor_Sub) / sizeof(Motor_Sub[0]);
+    } else if (!strcmp(name, "led")) {
+        cmd->keywords = &Led_Keys;
+    }
+    command_count++;
+}
+
+//Add the commands in a random order, TinyCmd_Add_Cmd keeps the list sorted
+static void add_all(void)
+{
+    static const char* const others[] = {"motor", "zeta_one", "Alpha", "alphabet", "led", "ledstrip"};
+    unsigned int order[COMMANDS];
+    uint32_t seed = 12345;
+    char name[CMD_NAME_LENGTH + 1];
+
+    for (unsigned int i = 0; i < CMD_NUMBERED; i++) {
+        snprintf(name, sizeof(name), "cmd%03u", i);
+        add_command(name);
+    }
+    for (unsigned int i = 0; i < NET_NUMBERED; i++) {
+        snprintf(name, sizeof(name), "net%02u", i);
+        add_command(name);
+    }
+    for (unsigned int i = 0; i < sizeof(others) / sizeof(others[0]); i++) {
+        add_command(others[i]);
+    }
+    CHECK(command_count == COMMANDS);
+
+    for (unsigned int i = 0; i < COMMANDS; i++) {
+        order[i] = i;
+    }
+    for (unsigned int i = COMMANDS - 1; i > 0; i--) {
+        unsigned int j;
+        unsigned int t;
+        seed = seed * 1103515245u + 12345u;
+        j = (seed >> 8) % (i + 1);
+        t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    for (unsigned int i = 0; i < COMMANDS; i++) {
+        CHECK(TinyCmd_Add_Cmd(&commands[order[i]]) == TINYCMD_SUCCESS);
+    }
+}
+
+//End the line, so the next check starts on an empty one
+static void enter(void)
+{
+    test_line("\n");
+}
+
+//The line being edited
+static const char* line(void)
+{
+    static char copy[128];
+    unsigned long len = TinyCmd_buf.length < sizeof(copy) - 1 ? TinyCmd_buf.length : sizeof(copy) - 1;
+    memcpy(copy, TinyCmd_buf.input, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+//Names listed by the last Tab: the words between the first "\r\n" and the next one
+static unsigned int listed(const char* expected_first, const char* expected_last)
+{
+    char* start = strstr(test_out, "\r\n");
+    char* end;
+    char* word;
+    char* last = NULL;
+    unsigned int count = 0;
+
+    if (start == NULL || (end = strstr(start + 2, "\r\n")) == NULL) {
+        return 0;
+    }
+    *end = '\0';
+    for (word = strtok(start + 2, " "); word != NULL; word = strtok(NULL, " ")) {
+        if (count == 0) {
+            CHECK_STR(word, expected_first);
+        }
+        last = word;
+        count++;
+    }
+    if (last != NULL) {
+        CHECK_STR(last, expected_last);
+    }
+    return count;
+}
+
+static void check_completion(void)
+{
+    //Unique prefix: completed with a space, in the case of the name
+    test_line("zeta\t");
+    CHECK_STR(line(), "zeta_one ");
+    enter();
+    CHECK(run_count == 1);
+    test_line("ZET\t");
+    CHECK_STR(line(), "zeta_one ");
+    enter();
+
+    //Common prefix: completed as far as the candidates agree, the next Tab lists them
+    test_line("ne\t");
+    CHECK_STR(line(), "net");
+    test_clear();
+    test_line("\t");
+    CHECK(listed("net00", "net93") == NET_NUMBERED);
+    CHECK_STR(line(), "net");
+    enter();
+
+    test_line("alp\t");
+    CHECK(strcasecmp(line(), "alpha") == 0);
+    test_clear();
+    test_line("\t");
+    CHECK(listed("Alpha", "alphabet") == 2);
+    enter();
+
+    //Nothing more to complete: listed at once
+    test_clear();
+    test_line("cmd1\t");
+    CHECK(listed("cmd100", "cmd199") == 100);
+    CHECK_STR(line(), "cmd1");
+    enter();
+    test_clear();
+    test_line("cmd12\t");
+    CHECK(listed("cmd120", "cmd129") == 10);
+    enter();
+    test_clear();
+    test_line("cmd399\t");
+    CHECK_STR(line(), "cmd399 ");
+    enter();
+
+    //First and last names of the sorted list
+    test_line("Alphab\t");
+    CHECK_STR(line(), "alphabet ");
+    enter();
+    test_line("zeta_o\t");
+    CHECK_STR(line(), "zeta_one ");
+    enter();
+
+    //No candidate rings the bell and leaves the line alone
+    test_clear();
+    test_line("xyz\t");
+    CHECK(strchr(test_out, '\a') != NULL);
+    CHECK_STR(line(), "xyz");
+    enter();
+
+    //Subcommands and keywords
+    test_line("motor sto\t");
+    CHECK_STR(line(), "motor stop ");
+    enter();
+    test_clear();
+    test_line("motor sp\t");
+    CHECK(listed("speed", "spin") == 2);
+    enter();
+    test_line("led b\t");
+    CHECK_STR(line(), "led blink ");
+    enter();
+    test_line("led o\t");
+    CHECK_STR(line(), "led o");
+    enter();
+    test_line("ledst\t");
+    CHECK_STR(line(), "ledstrip ");
+    enter();
+}
+
+//Latency*********************************************************************//
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+//Time of the Tab key alone after the word is typed, per Tab
+static double tab_time(const char* word, unsigned int rounds)
+{
+    double total = 0;
+
+    for (unsigned int i = 0; i < rounds; i++) {
+        double t;
+        test_line(word);
+        test_clear();
+        t = seconds();
+        TinyCmd_PutChar('\t');
+        total += seconds() - t;
+        enter();
+    }
+    return total / rounds * 1e9;
+}
+
+//What the sorted list saves: every name compared with the word
+static volatile unsigned int scan_found;
+
+static double scan_time(const char* word, unsigned int rounds)
+{
+    size_t len = strlen(word);
+    double t = seconds();
+
+    for (unsigned int r = 0; r < rounds; r++) {
+        unsigned int found = 0;
+        for (unsigned int i = 0; i < command_count; i++) {
+            found += strncasecmp(names[i], word, len) == 0;
+        }
+        scan_found = found;
+    }
+    return (seconds() - t) / rounds * 1e9;
+}
+
+static void latency(void)
+{
+    static const char* const words[] = {"zeta", "cmd12", "ne", "cmd"};
+    const unsigned int rounds = 2000;
+
+    printf("%u commands, one Tab (\"cmd\" lists 400 names):\n", command_count);
+    for (unsigned int i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        printf("  %-6s %9.0f ns   linear scan of the names %9.0f ns\n", words[i],
+               tab_time(words[i], rounds), scan_time(words[i], rounds));
+    }
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+    CHECK(TinyCmd_Section_Init() == TINYCMD_SUCCESS);
+    add_all();
+
+    check_completion();
+    latency();
+    return test_end();
+}
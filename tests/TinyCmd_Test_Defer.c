@@ -0,0 +1,95 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Defer.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Frames of TinyCmd_Report_Id: the width of each integer length, %ld and %lu in the width of long,
+ * the bits of %f, %s with its '\0' and the ids that are refused.
+ */
+
+// flags: -DCMD_USE_DEFER_REPORT -DCMD_NO_DEBUG_ECHO
+
+#include <limits.h>
+#include "TinyCmd_Test.h"
+
+#define TEST_FORMATS(X) \
+    X(FMT_INT, "%d %u\n") \
+    X(FMT_LONG, "%ld %lu\n") \
+    X(FMT_LLONG, "%lld\n") \
+    X(FMT_FLOAT, "%.2f\n") \
+    X(FMT_TEXT, "%c%s\n")
+
+TINYCMD_FMT_ENUM(TEST_FORMATS);
+TINYCMD_FMT_TABLE(TEST_FORMATS);
+
+//Read n bytes of the frame at pos little endian
+static unsigned long long frame_get(unsigned long pos, unsigned long n)
+{
+    unsigned long long value = 0;
+
+    while (n--) {
+        value = (value << 8) | (unsigned char)test_out[pos + n];
+    }
+    return value;
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+
+    test_clear();
+    CHECK(TinyCmd_Report_Id(FMT_INT, -2, 3u) == TINYCMD_SUCCESS);
+    CHECK(test_out_len == 2 + 4 + 4);
+    CHECK((unsigned char)test_out[0] == 0xA6 && test_out[1] == FMT_INT);
+    CHECK(frame_get(2, 4) == 0xFFFFFFFEu);
+    CHECK(frame_get(6, 4) == 3);
+
+    //long is sent whole, 8 bytes on an LP64 host
+    test_clear();
+    CHECK(TinyCmd_Report_Id(FMT_LONG, LONG_MIN, ULONG_MAX) == TINYCMD_SUCCESS);
+    CHECK(test_out_len == 2 + 2 * sizeof(long));
+    CHECK((long)frame_get(2, sizeof(long)) == LONG_MIN);
+    CHECK((unsigned long)frame_get(2 + sizeof(long), sizeof(long)) == ULONG_MAX);
+
+    test_clear();
+    CHECK(TinyCmd_Report_Id(FMT_LLONG, LLONG_MIN) == TINYCMD_SUCCESS);
+    CHECK(test_out_len == 2 + 8);
+    CHECK((long long)frame_get(2, 8) == LLONG_MIN);
+
+    //1.5f is 0x3FC00000, -0.0f only has the sign bit
+    test_clear();
+    CHECK(TinyCmd_Report_Id(FMT_FLOAT, 1.5) == TINYCMD_SUCCESS);
+    CHECK(test_out_len == 2 + 4);
+    CHECK(frame_get(2, 4) == 0x3FC00000u);
+    test_clear();
+    CHECK(TinyCmd_Report_Id(FMT_FLOAT, -0.0) == TINYCMD_SUCCESS);
+    CHECK(frame_get(2, 4) == 0x80000000u);
+
+    test_clear();
+    CHECK(TinyCmd_Report_Id(FMT_TEXT, 'x', "ok") == TINYCMD_SUCCESS);
+    CHECK(test_out_len == 2 + 1 + 3);
+    CHECK(memcmp(test_out + 2, "xok", 4) == 0);
+
+    test_clear();
+    CHECK(TinyCmd_Report_Id(TinyCmd_Fmt_Count) == TINYCMD_FAILED);
+    CHECK(TinyCmd_Report_Id(256) == TINYCMD_FAILED);
+    CHECK(test_out_len == 0);
+
+    return test_end();
+}
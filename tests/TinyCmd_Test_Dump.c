@@ -0,0 +1,123 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Dump.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Output of TinyCmd_Dump and the md command: the layout of full and short hexdump lines,
+ * base64 padding and line length, and the 0x prefix of the numbers, which needs a digit after it.
+ */
+
+// flags: -DCMD_USE_DUMP -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Test.h"
+
+static const unsigned char data[64] = "Hello, TinyCmd!\n\x01\x7f\xff" "0123456789";
+
+//Address column of a hexdump line, sizeof(void*) * 2 hex digits
+static const char* addr_of(const void* p)
+{
+    static char text[32];
+    snprintf(text, sizeof(text), "%0*lx", (int)(sizeof(void*) * 2), (unsigned long)p);
+    return text;
+}
+
+static void check_hex(void)
+{
+    char expected[256];
+
+    //A full line has a second space after 8 bytes, a short line is padded up to the ASCII column
+    test_clear();
+    CHECK(TinyCmd_Dump(data, 29, TINYCMD_DUMP_HEX) == TINYCMD_SUCCESS);
+    snprintf(expected, sizeof(expected),
+             "%s  48 65 6c 6c 6f 2c 20 54  69 6e 79 43 6d 64 21 0a  |Hello, TinyCmd!.|\n",
+             addr_of(data));
+    snprintf(expected + strlen(expected), sizeof(expected) - strlen(expected),
+             "%s  01 7f ff 30 31 32 33 34  35 36 37 38 39           |...0123456789|\n",
+             addr_of(data + 16));
+    CHECK_STR(test_out, expected);
+
+    //A line of 8 bytes or less has no second space
+    test_clear();
+    CHECK(TinyCmd_Dump(data + 16, 3, TINYCMD_DUMP_HEX) == TINYCMD_SUCCESS);
+    snprintf(expected, sizeof(expected), "%s  01 7f ff %*s |...|\n", addr_of(data + 16), 13 * 3 + 1, "");
+    CHECK_STR(test_out, expected);
+
+    test_clear();
+    CHECK(TinyCmd_Dump(data, 0, TINYCMD_DUMP_HEX) == TINYCMD_SUCCESS);
+    CHECK_STR(test_out, "");
+}
+
+static void check_base64(void)
+{
+    //Padding of 1, 2 and 3 bytes
+    test_clear();
+    CHECK(TinyCmd_Dump(data, 1, TINYCMD_DUMP_BASE64) == TINYCMD_SUCCESS);
+    CHECK_STR(test_out, "SA==\n");
+    test_clear();
+    CHECK(TinyCmd_Dump(data, 2, TINYCMD_DUMP_BASE64) == TINYCMD_SUCCESS);
+    CHECK_STR(test_out, "SGU=\n");
+    test_clear();
+    CHECK(TinyCmd_Dump(data, 3, TINYCMD_DUMP_BASE64) == TINYCMD_SUCCESS);
+    CHECK_STR(test_out, "SGVs\n");
+
+    //The bytes above 0x7F and the last characters of the alphabet
+    test_clear();
+    CHECK(TinyCmd_Dump("\xfb\xff\xbf", 3, TINYCMD_DUMP_BASE64) == TINYCMD_SUCCESS);
+    CHECK_STR(test_out, "+/+/\n");
+
+    //48 bytes fill a line of 64 characters, the 49th starts a padded line
+    test_clear();
+    CHECK(TinyCmd_Dump(data, 49, TINYCMD_DUMP_BASE64) == TINYCMD_SUCCESS);
+    CHECK(test_out_len == 65 + 5);
+    CHECK(test_out[64] == '\n');
+    CHECK_STR(test_out + 65, "AA==\n");
+}
+
+static void check_md(void)
+{
+    char line[64];
+
+    TinyCmd_Add_Cmd(&TinyCmd_Dump_Cmd);
+
+    test_clear();
+    snprintf(line, sizeof(line), "md 0x%lx 0x3 b64\n", (unsigned long)data);
+    test_line(line);
+    CHECK_STR(test_out, "SGVs\n");
+
+    //A 0x prefix without a digit is not a number, each line fails with the usage
+    test_clear();
+    test_line("md 0x 4 b64\n");
+    test_line("md 0xZZ 4 b64\n");
+    test_line("md -0x 4 b64\n");
+    snprintf(line, sizeof(line), "md %lu 0x b64\n", (unsigned long)data);
+    test_line(line);
+    CHECK_STR(test_out, "md: md <addr> <len> [b64]\nmd: md <addr> <len> [b64]\n"
+                        "md: md <addr> <len> [b64]\nmd: md <addr> <len> [b64]\n");
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+
+    check_hex();
+    check_base64();
+    check_md();
+
+    return test_end();
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Edit.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * The line editor: decoding of the control keys and escape sequences with the echo of each edit,
+ * sequences that are no key, Enter and the keys dropped while a line waits, and the history:
+ * a line stored once, moved to the newest when repeated, and the oldest lines dropped when it is full.
+ */
+
+// flags: -DCMD_USE_LINE_EDIT -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Test.h"
+
+//Arguments of the last "say", separated by '|'
+static char said[64];
+
+static TinyCmd_CallBack_Ret Say_Callback(void)
+{
+    said[0] = '\0';
+    for (TinyCmd_Counter_Type i = 0; i < CMD_MAX_PARAMS && TinyCmd_buf.arg[i] != NULL; i++) {
+        snprintf(said + strlen(said), sizeof(said) - strlen(said), "%s%s", i ? "|" : "", TinyCmd_buf.arg[i]);
+    }
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Say = {.command = "say", .callback = &Say_Callback};
+
+//The line being edited
+static const char* line(void)
+{
+    static char copy[CMD_BUF_SIZE + 1];
+    memcpy(copy, TinyCmd_buf.input, TinyCmd_buf.length);
+    copy[TinyCmd_buf.length] = '\0';
+    return copy;
+}
+
+//Type keys and return what the editor echoed
+static const char* keys(const char* text)
+{
+    test_clear();
+    test_line(text);
+    return test_out;
+}
+
+static void check_keys(void)
+{
+    CHECK_STR(keys("say ab"), "say ab");
+
+    //Left by CSI, SS3 and Ctrl-B, then typing in the middle redraws the rest
+    CHECK_STR(keys("\x1b[D"), "\b");
+    CHECK_STR(keys("X"), "Xb\b");
+    CHECK_STR(keys("\x1bOD\x02"), "\b\b");
+    CHECK_STR(line(), "say aXb");
+
+    //Right by CSI and Ctrl-F sends the characters passed over
+    CHECK_STR(keys("\x1b[C\x06"), "aX");
+
+    //Delete by "ESC [3~" and Ctrl-D, the rest moves left and the last column is blanked
+    CHECK_STR(keys("\x1b[3~"), " \b");
+    CHECK_STR(line(), "say aX");
+    CHECK_STR(keys("\x02\x04"), "\b \b");
+    CHECK_STR(line(), "say a");
+
+    //Home and End: "ESC [H", "ESC [1~", "ESC [7~", Ctrl-A, "ESC [F", "ESC [4~", "ESC [8~", Ctrl-E
+    CHECK_STR(keys("\x1b[H"), "\b\b\b\b\b");
+    CHECK_STR(keys("\x1b[F"), "say a");
+    CHECK_STR(keys("\x1b[1~"), "\b\b\b\b\b");
+    CHECK_STR(keys("\x1b[4~"), "say a");
+    CHECK_STR(keys("\x1b[7~\x1b[8~"), "\b\b\b\b\bsay a");
+    CHECK_STR(keys("\x01\x05"), "\b\b\b\b\bsay a");
+
+    //Backspace by 0x7F and Ctrl-H
+    CHECK_STR(keys("\x7f"), "\b \b");
+    CHECK_STR(keys("b\x08"), "b\b \b");
+    CHECK_STR(line(), "say ");
+
+    //Sequences that are no key are swallowed, the character after them is typed
+    CHECK_STR(keys("\x1b[Z" "\x1b[11~" "\x1b[5~" "\x1b[a" "\x1bx" "\x1b[9~"), "");
+    CHECK_STR(keys("\x1b[2~1"), "1");
+    CHECK_STR(line(), "say 1");
+    CHECK(TinyCmd_buf.length == 5);
+
+    //Left at the start and Right at the end do nothing
+    CHECK_STR(keys("\x05\x1b[C"), "");
+    CHECK_STR(keys("\x01\x1b[D\x7f"), "\b\b\b\b\b");
+    CHECK_STR(keys("\x05"), "say 1");
+
+    said[0] = '\0';
+    CHECK_STR(keys("\r"), "\r\n");
+    CHECK_STR(said, "1");
+    CHECK_STR(line(), "");
+}
+
+static void check_enter(void)
+{
+    //"\r\n" is one Enter, '\n' alone is another
+    said[0] = '\0';
+    CHECK_STR(keys("say 2\r\n"), "say 2\r\n");
+    CHECK_STR(said, "2");
+    CHECK_STR(keys("\n"), "\r\n");
+
+    //An empty line runs nothing and is not stored
+    said[0] = '\0';
+    CHECK_STR(keys("\r"), "\r\n");
+    CHECK_STR(said, "");
+
+    //Keys typed while the line waits for the handler ring the bell and are dropped, the '\n' of "\r\n" is silent
+    test_clear();
+    for (const char* c = "say 3\r\nx\x1b[A"; *c != '\0'; c++) {
+        TinyCmd_PutChar(*c);
+    }
+    CHECK_STR(test_out, "say 3\r\n\a\a\a\a");
+    TinyCmd_Handler();
+    CHECK_STR(said, "3");
+    CHECK_STR(keys("y"), "y");
+    CHECK_STR(keys("\x7f"), "\b \b");
+}
+
+//Lines of the history from the newest, by Up until it stops, then back down to the empty line
+static const char* history(void)
+{
+    static char text[256];
+    unsigned int ups = 0;
+
+    text[0] = '\0';
+    for (;;) {
+        char shown[CMD_BUF_SIZE + 1];
+        snprintf(shown, sizeof(shown), "%s", line());
+        test_line("\x1b[A");
+        if (ups > 0 && !strcmp(shown, line())) {
+            break;
+        }
+        snprintf(text + strlen(text), sizeof(text) - strlen(text), "%s%s", ups ? "," : "", line());
+        ups++;
+    }
+    while (ups--) {
+        test_line("\x1b[B");
+    }
+    CHECK_STR(line(), "");
+    return text;
+}
+
+static void check_history(void)
+{
+    test_clear();
+    CHECK_STR(history(), "say 3,say 2,say 1");
+
+    //Repeating a line moves it to the newest, it is stored once
+    test_line("say 1\r");
+    test_line("say 2\r");
+    CHECK_STR(history(), "say 2,say 1,say 3");
+
+    //Ctrl-P and Ctrl-N, past the newest comes the empty line
+    test_line("\x10\x10\x0e");
+    CHECK_STR(line(), "say 2");
+    test_line("\x0e\x0e");
+    CHECK_STR(line(), "");
+
+    //A line taken from the history and edited is stored as a new line
+    test_line("\x10\x7f" "9\r");
+    CHECK_STR(said, "9");
+    CHECK_STR(history(), "say 9,say 2,say 1,say 3");
+
+    //Up replaces a longer line and blanks the rest of it
+    test_line("say 12345678");
+    test_clear();
+    test_line("\x1b[A");
+    CHECK_STR(test_out, "\b\b\b\b\b\b\b\b\b\b\b\bsay 9       \b\b\b\b\b\b\b");
+    test_line("\x0e\x0e");
+
+    //Lines of 30 characters take 31 bytes, 4 fit in CMD_EDIT_HISTORY_SIZE
+    test_line("say aaaaaaaaaaaaaaaaaaaaaaaaaa\r");
+    test_line("say bbbbbbbbbbbbbbbbbbbbbbbbbb\r");
+    test_line("say cccccccccccccccccccccccccc\r");
+    test_line("say dddddddddddddddddddddddddd\r");
+    CHECK_STR(history(), "say dddddddddddddddddddddddddd,say cccccccccccccccccccccccccc,"
+                         "say bbbbbbbbbbbbbbbbbbbbbbbbbb,say aaaaaaaaaaaaaaaaaaaaaaaaaa");
+    test_line("say eeeeeeeeeeeeeeeeeeeeeeeeee\r");
+    CHECK_STR(history(), "say eeeeeeeeeeeeeeeeeeeeeeeeee,say dddddddddddddddddddddddddd,"
+                         "say cccccccccccccccccccccccccc,say bbbbbbbbbbbbbbbbbbbbbbbbbb");
+
+    //Repeating the oldest moves it, so nothing has to be dropped
+    test_line("say bbbbbbbbbbbbbbbbbbbbbbbbbb\r");
+    CHECK_STR(history(), "say bbbbbbbbbbbbbbbbbbbbbbbbbb,say eeeeeeeeeeeeeeeeeeeeeeeeee,"
+                         "say dddddddddddddddddddddddddd,say cccccccccccccccccccccccccc");
+
+    //A short line drops only as many old lines as it needs
+    test_line("say f\r");
+    CHECK_STR(history(), "say f,say bbbbbbbbbbbbbbbbbbbbbbbbbb,say eeeeeeeeeeeeeeeeeeeeeeeeee,"
+                         "say dddddddddddddddddddddddddd");
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+    CHECK(TinyCmd_Add_Cmd(&Say) == TINYCMD_SUCCESS);
+
+    check_keys();
+    check_enter();
+    check_history();
+
+    return test_end();
+}
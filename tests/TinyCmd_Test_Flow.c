@@ -0,0 +1,246 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Flow.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Stress test of the flow control, in simulated time. A host sends lines at 115200 baud without pause, faster than
+ * the callbacks run (0.1 to 3.1 ms each). The bytes arriving while a callback runs are received from inside it,
+ * as the receive interrupt would. The host stops a few bytes after the stop and goes on when told to.
+ *
+ * Checked: every line runs once, whole and in order, while the host keeps within the room above CMD_FLOW_HIGH;
+ * the stops come at CMD_FLOW_HIGH and the restarts at CMD_FLOW_LOW, alternating; a host overrunning the room loses
+ * lines, each one counted by "flow"; an overlong line is dropped up to its end and its tail never runs.
+ */
+
+// flags: -DCMD_USE_FLOW -DCMD_NAME_LENGTH=16 -DCMD_NO_DEBUG_ECHO
+
+#include <stdint.h>
+#include "TinyCmd_Test.h"
+
+#define LINES 20000
+//Time of one byte at 115200 baud 8N1, in ns
+#define BYTE_NS 86806ULL
+#define OVERLONG_EVERY 97
+//Number of a line no host sends: the tail of the overlong lines
+#define TAIL_SEQ 99999
+
+static unsigned long long now_ns;
+static unsigned long long next_byte_ns;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static unsigned int rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned int)rng_state;
+}
+
+//Host************************************************************************//
+
+static struct {
+    char line[128];
+    unsigned int len;
+    unsigned int pos;
+    unsigned int seq;
+    unsigned int sent;
+    unsigned int overlong_sent;
+    //Bytes it still sends after a stop, -1 while it may send
+    int lag;
+    unsigned int lag_after_stop;
+} host;
+
+static unsigned int pending;
+
+static void host_next_line(void)
+{
+    if (host.sent > 0 && host.sent % OVERLONG_EVERY == 0 && host.overlong_sent < host.sent / OVERLONG_EVERY) {
+        //Longer than TinyCmd_buf.input, ends like a command line
+        memset(host.line, 'j', 100);
+        snprintf(host.line + 100, sizeof(host.line) - 100, " set %u\n", TAIL_SEQ);
+        host.overlong_sent++;
+    } else {
+        unsigned int pad = host.seq % 17;
+        int n = snprintf(host.line, sizeof(host.line), "set %u ", host.seq);
+        memset(host.line + n, 'x', pad);
+        host.line[n + pad] = '\n';
+        host.line[n + pad + 1] = '\0';
+        host.seq++;
+        host.sent++;
+    }
+    host.len = (unsigned int)strlen(host.line);
+    host.pos = 0;
+}
+
+//The receive interrupt: the bytes the host sends up to time until
+static void receive_until(unsigned long long until)
+{
+    while (next_byte_ns <= until) {
+        if (host.lag == 0 || (host.pos == host.len && host.seq >= LINES)) {
+            //Stopped, or nothing left to send: the line is idle
+            next_byte_ns = until + 1;
+            break;
+        }
+        if (host.pos == host.len) {
+            host_next_line();
+        }
+        if (host.lag > 0) {
+            host.lag--;
+        }
+        if (TinyCmd_PutChar(host.line[host.pos++])) {
+            pending++;
+        }
+        next_byte_ns += BYTE_NS;
+    }
+    now_ns = until;
+}
+
+//Flow control hook***********************************************************//
+
+static unsigned int stops;
+static unsigned int goes;
+
+static void test_flow(TinyCmd_Status go)
+{
+    if (go) {
+        //Down to CMD_FLOW_LOW, or only a partial line left which the main loop can't run down
+        CHECK(goes + 1 == stops);
+        CHECK(TinyCmd_buf.length <= CMD_FLOW_LOW || memchr(TinyCmd_buf.input, '\n', TinyCmd_buf.length) == NULL);
+        goes++;
+        host.lag = -1;
+        if (next_byte_ns < now_ns) {
+            next_byte_ns = now_ns;
+        }
+    } else {
+        CHECK(goes == stops);
+        CHECK(TinyCmd_buf.length >= CMD_FLOW_HIGH);
+        stops++;
+        host.lag = (int)host.lag_after_stop;
+    }
+}
+
+//Device**********************************************************************//
+
+static unsigned int runs;
+static long last_seq;
+static unsigned int out_of_order;
+
+static TinyCmd_CallBack_Ret set_callback(void)
+{
+    int32_t seq = 0;
+    unsigned long long busy = 100000ULL + (rng() % 3000000ULL);
+
+    CHECK(TinyCmd_Arg_To_Num(0, &seq, TINYCMD_INT32) == TINYCMD_SUCCESS);
+    CHECK(seq != TAIL_SEQ);
+    if (seq <= last_seq) {
+        out_of_order++;
+    }
+    //The padding tells the line is whole
+    CHECK(TinyCmd_Arg_Get_Len(1) == (TinyCmd_Counter_Type)(seq % 17));
+    last_seq = seq;
+    runs++;
+
+    //The callback runs for a while, the bytes keep coming in
+    receive_until(now_ns + busy);
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Set = {.command = "set", .callback = &set_callback};
+
+//The main loop until the host has sent everything and every line has run
+static void main_loop(void)
+{
+    while (pending > 0 || next_byte_ns <= now_ns || host.seq < LINES || host.pos < host.len) {
+        if (pending > 0) {
+            pending--;
+            TinyCmd_Handler();
+        } else if (host.lag == 0) {
+            //Stopped with nothing to run: never ends
+            CHECK(host.lag != 0);
+            break;
+        } else {
+            receive_until(next_byte_ns);
+        }
+    }
+}
+
+//Reads "dropped D overlong O stops S" from the flow command, and sets the counts to 0
+static void flow_counts(unsigned int* dropped, unsigned int* overlong, unsigned int* flow_stops)
+{
+    test_clear();
+    test_line("flow\n");
+    CHECK(sscanf(test_out, "dropped %u overlong %u stops %u", dropped, overlong, flow_stops) == 3);
+    test_line("flow clear\n");
+}
+
+static void run(unsigned int lag, unsigned int* dropped, unsigned int* overlong)
+{
+    unsigned int flow_stops;
+
+    memset(&host, 0, sizeof(host));
+    host.lag = -1;
+    host.lag_after_stop = lag;
+    host.pos = host.len = 0;
+    now_ns = next_byte_ns = 0;
+    pending = 0;
+    runs = 0;
+    last_seq = -1;
+    out_of_order = 0;
+    stops = goes = 0;
+
+    main_loop();
+
+    CHECK(out_of_order == 0);
+    CHECK(stops > 0 && goes == stops);
+    flow_counts(dropped, overlong, &flow_stops);
+    CHECK(flow_stops == stops);
+    //Every line sent runs or is counted, an overlong one is counted as dropped if lines wait before it
+    CHECK(runs + *dropped + *overlong == LINES + host.overlong_sent);
+    printf("host lag %2u bytes: %u lines run, %u dropped, %u overlong, %u stops, %.1f s\n",
+           lag, runs, *dropped, *overlong, stops, (double)now_ns * 1e-9);
+}
+
+int main(void)
+{
+    unsigned int dropped;
+    unsigned int overlong;
+
+    TinyCmd_SendChar = test_send;
+    TinyCmd_FlowControl = test_flow;
+    TinyCmd_Add_Cmd(&Set);
+    TinyCmd_Add_Cmd(&TinyCmd_Flow_Cmd);
+
+    //Within the room above CMD_FLOW_HIGH (the last byte of TinyCmd_buf.input ends the line): nothing lost
+    //but the overlong lines, up to the last byte of the room
+    for (unsigned int lag = 0; lag <= CMD_BUF_SIZE - 1 - CMD_FLOW_HIGH; lag++) {
+        run(lag, &dropped, &overlong);
+        CHECK(runs == LINES);
+        CHECK(dropped + overlong == host.overlong_sent);
+    }
+
+    //Beyond it: lines are lost, but counted, and the others still run whole and in order
+    run(CMD_BUF_SIZE - CMD_FLOW_HIGH, &dropped, &overlong);
+    CHECK(runs < LINES);
+    run(CMD_BUF_SIZE, &dropped, &overlong);
+    CHECK(runs < LINES);
+    CHECK(dropped > host.overlong_sent);
+
+    return test_end();
+}
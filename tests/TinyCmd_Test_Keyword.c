@@ -0,0 +1,104 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Keyword.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * TinyCmd_Arg_Keyword() on tables built by TinyCmd_Keywords_Init(), on const tables never built and on a table
+ * too big for its slots: every keyword is found at its index with and without case, in the same slot as others
+ * of its length and first and last characters, and words matching none are refused.
+ */
+
+// flags: -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Test.h"
+
+//"CW", "cw" and "Cw" share a slot, so do "sat" and "Sit"
+static const char* const Words[] = {"ON", "OFF", "Blink", "CW", "CCW", "Stop", "Status", "Reset", "cw", "sat", "Sit"};
+static TinyCmd_Keywords Keys = TINYCMD_KEYWORDS(Words, 0);
+static TinyCmd_Keywords Keys_Nocase = TINYCMD_KEYWORDS(Words, 1);
+static const TinyCmd_Keywords Keys_Const = TINYCMD_KEYWORDS(Words, 0);
+
+static const char* const Many[] = {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m"};
+static TinyCmd_Keywords Keys_Many = TINYCMD_KEYWORDS(Many, 0);
+
+#define WORDS (int)(sizeof(Words) / sizeof(Words[0]))
+
+static int keyword(const TinyCmd_Keywords* keys, const char* arg)
+{
+    static char copy[16];
+
+    snprintf(copy, sizeof(copy), "%s", arg);
+    TinyCmd_buf.arg[0] = copy;
+    return TinyCmd_Arg_Keyword(keys, 0);
+}
+
+static void check_case(const TinyCmd_Keywords* keys)
+{
+    for (int i = 0; i < WORDS; i++) {
+        CHECK(keyword(keys, Words[i]) == i);
+    }
+    CHECK(keyword(keys, "on") == -1);
+    CHECK(keyword(keys, "Cw") == -1);
+    CHECK(keyword(keys, "SIT") == -1);
+    CHECK(keyword(keys, "Left") == -1);
+    CHECK(keyword(keys, "O") == -1);
+    CHECK(keyword(keys, "ONN") == -1);
+    CHECK(keyword(keys, "Statu") == -1);
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+
+    CHECK(TinyCmd_Keywords_Init(&Keys) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Keywords_Init(&Keys_Nocase) == TINYCMD_SUCCESS);
+    CHECK(Keys.built && !Keys_Const.built);
+    check_case(&Keys);
+    check_case(&Keys_Const);
+
+    //Ignoring case the first of the keywords equal to the argument is found
+    for (int i = 0; i < WORDS - 3; i++) {
+        CHECK(keyword(&Keys_Nocase, Words[i]) == i);
+    }
+    CHECK(keyword(&Keys_Nocase, "on") == 0);
+    CHECK(keyword(&Keys_Nocase, "bLINK") == 2);
+    CHECK(keyword(&Keys_Nocase, "Cw") == 3 || keyword(&Keys_Nocase, "Cw") == 8);
+    CHECK(keyword(&Keys_Nocase, "SAT") == 9);
+    CHECK(keyword(&Keys_Nocase, "sit") == 10);
+    CHECK(keyword(&Keys_Nocase, "Left") == -1);
+
+    //Building again gives the same slots
+    CHECK(TinyCmd_Keywords_Init(&Keys) == TINYCMD_SUCCESS);
+    check_case(&Keys);
+
+    //More keywords than 3/4 of the slots are compared one by one
+    CHECK(TinyCmd_Keywords_Init(&Keys_Many) == TINYCMD_FAILED);
+    CHECK(!Keys_Many.built);
+    CHECK(keyword(&Keys_Many, "a") == 0);
+    CHECK(keyword(&Keys_Many, "m") == 12);
+    CHECK(keyword(&Keys_Many, "n") == -1);
+
+    CHECK(TinyCmd_Keywords_Init(NULL) == TINYCMD_FAILED);
+    CHECK(TinyCmd_Arg_Keyword(NULL, 0) == -1);
+    TinyCmd_buf.arg[0] = NULL;
+    CHECK(TinyCmd_Arg_Keyword(&Keys, 0) == -1);
+    CHECK(TinyCmd_Arg_Keyword(&Keys, CMD_MAX_PARAMS) == -1);
+
+    return test_end();
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Report.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Conformance of TinyCmd_Report, TinyCmd_Report_P and TinyCmd_Report_Fmt against snprintf:
+ * every integer conversion (d, i, u, x, X, o, c) with every length ("", l, ll), flags ('-', '0'),
+ * widths from 0 to 24 and the edge values of each type, then %s, %% and %f.
+ * %f rounds an exact half away from zero, the C library rounds it to even: those cases are checked apart.
+ */
+
+// flags: -DCMD_NO_DEBUG_ECHO
+
+#include <limits.h>
+#include <math.h>
+#include "TinyCmd_Test.h"
+
+//Integer arguments are passed as the type of the length modifier
+enum { LEN_INT, LEN_LONG, LEN_LLONG };
+
+static const long long signed_values[] = {
+    0, 1, -1, 7, -42, 255, 4096, 65535, -65536, INT_MAX, INT_MIN,
+    LONG_MAX, LONG_MIN, LLONG_MAX, LLONG_MIN, 123456789012LL, -987654321098LL,
+};
+
+static const unsigned long long unsigned_values[] = {
+    0, 1, 8, 0xA5, 0xFF, 0x1000, 0xDEADBEEF, UINT_MAX, ULONG_MAX, ULLONG_MAX, 01234567012345ULL,
+};
+
+static const char* const flag_sets[] = {"", "-", "0", "-0"};
+
+//Run format with one argument through the three report functions and snprintf, and compare
+#define CHECK_ALL(format, arg) do { \
+    char check_exp[128]; \
+    TinyCmd_Fmt check_fmt; \
+    snprintf(check_exp, sizeof(check_exp), (format), arg); \
+    test_clear(); \
+    TinyCmd_Report((format), arg); \
+    CHECK_STR(test_out, check_exp); \
+    test_clear(); \
+    TinyCmd_Report_P((format), arg); \
+    CHECK_STR(test_out, check_exp); \
+    CHECK(TinyCmd_Fmt_Compile(&check_fmt, (format)) == TINYCMD_SUCCESS); \
+    test_clear(); \
+    TinyCmd_Report_Fmt(&check_fmt, arg); \
+    CHECK_STR(test_out, check_exp); \
+} while (0)
+
+static void check_integer(const char* flags, int width, int length, char conv, long long value)
+{
+    static const char* const lengths[] = {"", "l", "ll"};
+    char format[32];
+
+    snprintf(format, sizeof(format), "[%%%s%.0d%s%c]", flags, width, lengths[length], conv);
+    if (conv == 'd' || conv == 'i') {
+        if (length == LEN_LLONG) {
+            CHECK_ALL(format, value);
+        } else if (length == LEN_LONG) {
+            CHECK_ALL(format, (long)value);
+        } else {
+            CHECK_ALL(format, (int)value);
+        }
+    } else {
+        if (length == LEN_LLONG) {
+            CHECK_ALL(format, (unsigned long long)value);
+        } else if (length == LEN_LONG) {
+            CHECK_ALL(format, (unsigned long)value);
+        } else {
+            CHECK_ALL(format, (unsigned int)value);
+        }
+    }
+}
+
+static void check_integers(void)
+{
+    static const char signed_convs[] = "di";
+    static const char unsigned_convs[] = "uxXo";
+
+    for (unsigned f = 0; f < sizeof(flag_sets) / sizeof(flag_sets[0]); f++) {
+        for (int width = 0; width <= 24; width += (width < 12 ? 1 : 6)) {
+            for (int length = LEN_INT; length <= LEN_LLONG; length++) {
+                for (unsigned c = 0; signed_convs[c]; c++) {
+                    for (unsigned v = 0; v < sizeof(signed_values) / sizeof(signed_values[0]); v++) {
+                        check_integer(flag_sets[f], width, length, signed_convs[c], signed_values[v]);
+                    }
+                }
+                for (unsigned c = 0; unsigned_convs[c]; c++) {
+                    for (unsigned v = 0; v < sizeof(unsigned_values) / sizeof(unsigned_values[0]); v++) {
+                        check_integer(flag_sets[f], width, length, unsigned_convs[c], (long long)unsigned_values[v]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+//'0' is undefined for %c and %s in C, so only '-' and the width are checked
+static void check_chars_and_strings(void)
+{
+    static const char* const strings[] = {"", "a", "LED", "a longer string than the width"};
+    static const char chars[] = {'a', 'Z', ' ', '~'};
+    char format[32];
+
+    for (int width = 0; width <= 12; width++) {
+        for (int left = 0; left <= 1; left++) {
+            snprintf(format, sizeof(format), "<%%%s%.0dc>", left ? "-" : "", width);
+            for (unsigned i = 0; i < sizeof(chars); i++) {
+                CHECK_ALL(format, chars[i]);
+            }
+            snprintf(format, sizeof(format), "<%%%s%.0ds>", left ? "-" : "", width);
+            for (unsigned i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+                CHECK_ALL(format, strings[i]);
+            }
+        }
+    }
+}
+
+//Values with an exact binary form, so the digits are the same as the ones of the C library.
+//An exact half is rounded away from zero, where the C library rounds it to even: these are checked on their own.
+static void check_floats(void)
+{
+    static const double values[] = {0.0, 1.0, -1.0, 0.5, -2.25, 0.125, 1024.0625, -65535.75, 3.0e9, 0.1, -7.3};
+    char format[32];
+
+    for (int precision = 0; precision <= 6; precision++) {
+        for (int width = 0; width <= 14; width += 7) {
+            for (unsigned f = 0; f < sizeof(flag_sets) / sizeof(flag_sets[0]); f++) {
+                snprintf(format, sizeof(format), "{%%%s%.0d.%df}", flag_sets[f], width, precision);
+                for (unsigned i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+                    double scaled = fabs(values[i]) * pow(10.0, precision);
+                    if (scaled - floor(scaled) == 0.5) {
+                        continue;
+                    }
+                    CHECK_ALL(format, values[i]);
+                }
+            }
+        }
+    }
+    CHECK_ALL("%f", 2.5);
+
+    test_clear();
+    TinyCmd_Report("%.0f %.2f %.3f", 0.5, 0.125, 1024.0625);
+    CHECK_STR(test_out, "1 0.13 1024.063");
+}
+
+//Several conversions and literal text in one format
+static void check_mixed(void)
+{
+    char expected[128];
+
+    snprintf(expected, sizeof(expected), "reg %08X=%-6u|%5.2f%% %c %lld %lx %o\n",
+             0xBEEFu, 42u, -1.5, 'k', LLONG_MIN, 0xFFFFFFFFUL, 8u);
+    test_clear();
+    TinyCmd_Report("reg %08X=%-6u|%5.2f%% %c %lld %lx %o\n", 0xBEEFu, 42u, -1.5, 'k', LLONG_MIN, 0xFFFFFFFFUL, 8u);
+    CHECK_STR(test_out, expected);
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+
+    check_integers();
+    check_chars_and_strings();
+    check_floats();
+    check_mixed();
+    return test_end();
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Section.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Commands registered by TINYCMD_REGISTER next to commands added by TinyCmd_Add_Cmd: dispatch and
+ * abbreviations before TinyCmd_Section_Init() (scan of the section) and after it (binary search of
+ * its sorted index), and Tab completion over both. TinyCmd_Test_Complete.c runs with an empty section.
+ * A registered command with subcommands and an urgent subcommand, given to TINYCMD_REGISTER after the callback.
+ */
+
+// flags: -DCMD_USE_SECTION -DCMD_USE_ABBREV -DCMD_USE_LINE_EDIT -DCMD_USE_SUB -DCMD_USE_PRIORITY -DCMD_NO_DEBUG_ECHO
+
+#include "TinyCmd_Test.h"
+
+//Name of the command that ran last
+static const char* ran;
+
+#define TEST_CALLBACK(fn, name) \
+    static TinyCmd_CallBack_Ret fn(void) \
+    { \
+        ran = name; \
+        return TINYCMD_SUCCESS; \
+    }
+
+TEST_CALLBACK(Zeta_Callback, "zeta")
+TEST_CALLBACK(Motor_Callback, "motor")
+TEST_CALLBACK(Alpha_Callback, "Alpha")
+TEST_CALLBACK(Mode_Callback, "mode")
+TEST_CALLBACK(Led_Callback, "LED")
+TEST_CALLBACK(Reset_Callback, "reset")
+TEST_CALLBACK(Beta_Callback, "beta")
+TEST_CALLBACK(Led2_Callback, "led2")
+TEST_CALLBACK(Help_Callback, "help")
+TEST_CALLBACK(Stop_Callback, "motor stop")
+TEST_CALLBACK(Speed_Callback, "motor speed")
+
+//Out of order, TinyCmd_Section_Init() sorts them
+static TinyCmd_Command Stop = {.command = "stop", .callback = &Stop_Callback, .priority = TINYCMD_PRIORITY_URGENT};
+static TinyCmd_Command Speed = {.command = "speed", .callback = &Speed_Callback};
+static TinyCmd_Command* Motor_Sub[] = {&Stop, &Speed};
+
+//Registered out of order and in mixed case, the linker keeps the order of the definitions
+TINYCMD_REGISTER("zeta", Zeta_Callback);
+TINYCMD_REGISTER("motor", Motor_Callback, TINYCMD_SUB(Motor_Sub));
+TINYCMD_REGISTER("Alpha", Alpha_Callback);
+TINYCMD_REGISTER("mode", Mode_Callback);
+TINYCMD_REGISTER("LED", Led_Callback);
+TINYCMD_REGISTER("reset", Reset_Callback);
+
+static TinyCmd_Command Beta = {.command = "beta", .callback = &Beta_Callback};
+static TinyCmd_Command Led2 = {.command = "led2", .callback = &Led2_Callback};
+static TinyCmd_Command Help = {.command = "help", .callback = &Help_Callback};
+
+//Run a line, return the name of the command that ran or "" for none
+static const char* run(const char* line)
+{
+    ran = "";
+    test_line(line);
+    return ran;
+}
+
+static void check_dispatch(void)
+{
+    //Exact names of both kinds
+    CHECK_STR(run("zeta\n"), "zeta");
+    CHECK_STR(run("motor 1 2\n"), "motor");
+    CHECK_STR(run("Alpha\n"), "Alpha");
+    CHECK_STR(run("mode\n"), "mode");
+    CHECK_STR(run("LED on\n"), "LED");
+    CHECK_STR(run("reset\n"), "reset");
+    CHECK_STR(run("beta\n"), "beta");
+    CHECK_STR(run("led2\n"), "led2");
+    CHECK_STR(run("help\n"), "help");
+
+    //Unique prefixes ignoring case, in the section and in the list
+    CHECK_STR(run("al\n"), "Alpha");
+    CHECK_STR(run("MOT\n"), "motor");
+    CHECK_STR(run("z\n"), "zeta");
+    CHECK_STR(run("res\n"), "reset");
+    CHECK_STR(run("b\n"), "beta");
+    CHECK_STR(run("HE\n"), "help");
+
+    //Ambiguous within the section, and across the section and the list
+    CHECK_STR(run("mo\n"), "");
+    CHECK_STR(run("le\n"), "");
+
+    CHECK_STR(run("xyz\n"), "");
+    CHECK_STR(run("motors\n"), "");
+}
+
+static void check_sub(void)
+{
+    CHECK_STR(run("motor speed 3\n"), "motor speed");
+    CHECK_STR(run("motor fast\n"), "motor");
+
+    //The urgent subcommand runs from TinyCmd_PutChar(), before the handler sees the line
+    ran = "";
+    for (const char* c = "motor stop\n"; *c != '\0'; c++) {
+        TinyCmd_PutChar(*c);
+    }
+    CHECK_STR(ran, "motor stop");
+    ran = "";
+    TinyCmd_Handler();
+    CHECK_STR(ran, "");
+}
+
+//The line being edited
+static const char* line(void)
+{
+    static char copy[64];
+    unsigned long len = TinyCmd_buf.length < sizeof(copy) - 1 ? TinyCmd_buf.length : sizeof(copy) - 1;
+    memcpy(copy, TinyCmd_buf.input, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+static void check_completion(void)
+{
+    test_line("Ze\t");
+    CHECK_STR(line(), "zeta ");
+    test_line("\n");
+
+    test_line("rE\t");
+    CHECK_STR(line(), "reset ");
+    test_line("\n");
+
+    //"mode" and "motor" agree on "mo", the next Tab lists both
+    test_line("m\t");
+    CHECK_STR(line(), "mo");
+    test_clear();
+    test_line("\t");
+    CHECK(strstr(test_out, "mode") != NULL && strstr(test_out, "motor") != NULL);
+    test_line("\n");
+
+    //"LED" from the section and "led2" from the list
+    test_line("l\t");
+    CHECK(strcmp(line(), "LED") == 0 || strcmp(line(), "led") == 0);
+    test_clear();
+    test_line("\t");
+    CHECK(strstr(test_out, "LED") != NULL && strstr(test_out, "led2") != NULL);
+    test_line("\n");
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+
+    CHECK(TinyCmd_Add_Cmd(&Help) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&Led2) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Add_Cmd(&Beta) == TINYCMD_SUCCESS);
+
+    //The section is scanned until its index is sorted
+    check_dispatch();
+    check_completion();
+    check_sub();
+
+    CHECK(TinyCmd_Section_Init() == TINYCMD_SUCCESS);
+    CHECK(Motor_Sub[0] == &Speed && Motor_Sub[1] == &Stop);
+    //Prefixes of subcommands are searched in the sorted table
+    CHECK_STR(run("MOT sp\n"), "motor speed");
+    CHECK_STR(run("mot s\n"), "motor");
+    check_dispatch();
+    check_completion();
+    check_sub();
+
+    //Sorting again gives the same index
+    CHECK(TinyCmd_Section_Init() == TINYCMD_SUCCESS);
+    check_dispatch();
+
+    return test_end();
+}
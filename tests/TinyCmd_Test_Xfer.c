@@ -0,0 +1,494 @@
+/*
+ * Copyright 2024 Civic_Crab
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File: TinyCmd_Test_Xfer.c
+ * Author: Civic_Crab
+ *
+ * Description:
+ * Loopback test of the binary transfer. The test is the host at the other end of the port: it sends chunks into
+ * TinyCmd_PutChar() and reads the ACK and NAK from TinyCmd_SendChar (rx), or reads the chunks and answers
+ * them (tx). The link between them flips, drops and inserts bytes, drops whole chunks and loses ACKs;
+ * the payload must still arrive whole and in order, and the port must go back to command lines.
+ * The clean transfers are timed and their throughput printed.
+ */
+
+// flags: -DCMD_USE_XFER -DCMD_NO_DEBUG_ECHO
+
+#include <stdint.h>
+#include <time.h>
+#include "TinyCmd_Test.h"
+
+#define PAYLOAD_SIZE 40000UL
+#define CHUNKS(len) (((len) + CMD_XFER_CHUNK - 1) / CMD_XFER_CHUNK)
+//Rounds of the host loop before a transfer is taken as stuck
+#define MAX_ROUNDS 200000UL
+
+#define SYNC 0x5A
+#define ACK  0x06
+#define NAK  0x15
+#define CAN  0x18
+
+static unsigned char payload[PAYLOAD_SIZE];
+static unsigned char received[PAYLOAD_SIZE];
+
+//Link errors*****************************************************************//
+
+static uint64_t rng_state = 0x2545F4914F6CDD1Dull;
+
+static unsigned int rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned int)rng_state;
+}
+
+//One chunk in error_rate is damaged on the link, 0 for a clean link
+static unsigned int error_rate;
+static unsigned long errors_injected;
+
+typedef enum {
+    LINK_OK = 0,
+    LINK_FLIP,      //one bit of the payload flipped
+    LINK_CRC,       //the CRC damaged
+    LINK_DROP,      //the whole chunk lost
+    LINK_SHORT,     //one byte lost
+    LINK_NOISE,     //noise with a sync byte before the chunk
+    LINK_ERRORS,
+} Link_Error;
+
+static Link_Error link_pick(void)
+{
+    if (error_rate == 0 || rng() % error_rate != 0) {
+        return LINK_OK;
+    }
+    errors_injected++;
+    return (Link_Error)(1 + rng() % (LINK_ERRORS - 1));
+}
+
+//Bitwise CRC-16/CCITT, independent of the tables of TinyCmd.c
+static unsigned short crc16(unsigned short crc, unsigned char c)
+{
+    crc ^= (unsigned short)c << 8;
+    for (int i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (unsigned short)((crc << 1) ^ 0x1021) : (unsigned short)(crc << 1);
+    }
+    return crc;
+}
+
+static unsigned long millis_now;
+
+static unsigned long test_millis(void)
+{
+    return millis_now;
+}
+
+//Device receives*************************************************************//
+
+static unsigned long sink_next;
+static unsigned long sink_calls;
+static TinyCmd_Status sink_refuse;
+
+static TinyCmd_Status test_sink(unsigned long offset, const unsigned char* data, TinyCmd_Counter_Type len)
+{
+    CHECK(offset == sink_next);
+    CHECK(len > 0 && len <= CMD_XFER_CHUNK);
+    if (sink_refuse || offset + len > PAYLOAD_SIZE) {
+        return TINYCMD_FAILED;
+    }
+    memcpy(received + offset, data, len);
+    sink_next = offset + len;
+    sink_calls++;
+    return TINYCMD_SUCCESS;
+}
+
+static void put_bytes(const unsigned char* data, unsigned long len)
+{
+    for (unsigned long i = 0; i < len; i++) {
+        CHECK(TinyCmd_PutChar((char)data[i]) == TINYCMD_FAILED);
+    }
+}
+
+//Send chunk index of payload to the device through the link, returns the bytes put on the wire
+static unsigned long host_chunk(unsigned long index, unsigned long total)
+{
+    unsigned char frame[CMD_XFER_CHUNK + 5];
+    unsigned long start = index * CMD_XFER_CHUNK;
+    unsigned char len = (unsigned char)((total - start < CMD_XFER_CHUNK) ? total - start : CMD_XFER_CHUNK);
+    unsigned short crc = 0xFFFF;
+    unsigned long size = (unsigned long)len + 5;
+
+    frame[0] = SYNC;
+    frame[1] = (unsigned char)index;
+    frame[2] = len;
+    memcpy(frame + 3, payload + start, len);
+    for (unsigned long i = 1; i < 3 + (unsigned long)len; i++) {
+        crc = crc16(crc, frame[i]);
+    }
+    frame[3 + len] = (unsigned char)(crc & 0xFF);
+    frame[4 + len] = (unsigned char)(crc >> 8);
+
+    switch (link_pick()) {
+        case LINK_FLIP:
+            frame[3 + rng() % len] ^= (unsigned char)(1u << (rng() % 8));
+            break;
+        case LINK_CRC:
+            frame[3 + len] ^= 0xFF;
+            break;
+        case LINK_DROP:
+            return 0;
+        case LINK_SHORT: {
+            unsigned long at = 1 + rng() % (size - 1);
+            memmove(frame + at, frame + at + 1, size - at - 1);
+            size--;
+            break;
+        }
+        case LINK_NOISE: {
+            static const unsigned char noise[] = {SYNC, 0x00, 0x07};
+            put_bytes(noise, sizeof(noise));
+            break;
+        }
+        default:
+            break;
+    }
+    put_bytes(frame, size);
+    return size;
+}
+
+//Host side of a transfer into the device: go back N with the window of the device.
+//The device started by TinyCmd_Xfer_Recv() or "rx" has sent its ACK 0xFF already.
+static void host_send(unsigned long total)
+{
+    unsigned long chunks = CHUNKS(total);
+    unsigned long base = 0;
+    unsigned long next = 0;
+    unsigned long rounds = 0;
+
+    while (base < chunks && rounds++ < MAX_ROUNDS) {
+        TinyCmd_Status progress = TINYCMD_FAILED;
+
+        test_clear();
+        while (next < chunks && next - base < CMD_XFER_WINDOW) {
+            host_chunk(next++, total);
+        }
+
+        //Replies of the device, the sequence numbers are the low 8 bits of the chunk index
+        for (unsigned long i = 0; i + 1 < test_out_len; i += 2) {
+            unsigned char type = (unsigned char)test_out[i];
+            unsigned long index = base + (unsigned char)((unsigned char)test_out[i + 1] - (unsigned char)base);
+            if (type == ACK && index < next) {
+                base = index + 1;
+                progress = TINYCMD_SUCCESS;
+            } else if (type == NAK && index <= next) {
+                base = next = index;
+                progress = TINYCMD_SUCCESS;
+            } else {
+                CHECK(type == ACK || type == NAK);
+            }
+        }
+
+        //Nothing heard and nothing more to send: the device times out and NAKs the chunk it expects
+        if (!progress && (next == chunks || next - base >= CMD_XFER_WINDOW)) {
+            millis_now += CMD_XFER_TIMEOUT;
+            test_clear();
+            CHECK(TinyCmd_Xfer_Poll() == TINYCMD_SUCCESS);
+            CHECK(test_out_len == 2 && (unsigned char)test_out[0] == NAK);
+            base = next = base + (unsigned char)((unsigned char)test_out[1] - (unsigned char)base);
+        }
+    }
+    CHECK(rounds < MAX_ROUNDS);
+}
+
+static void check_receive(unsigned long total, unsigned int rate)
+{
+    memset(received, 0, sizeof(received));
+    sink_next = 0;
+    error_rate = rate;
+    test_clear();
+    CHECK(TinyCmd_Xfer_Recv(test_sink, total) == TINYCMD_SUCCESS);
+    CHECK(test_out_len == 2 && (unsigned char)test_out[0] == ACK && (unsigned char)test_out[1] == 0xFF);
+    CHECK(TinyCmd_Xfer_Recv(test_sink, total) == TINYCMD_FAILED);
+
+    host_send(total);
+    CHECK(sink_next == total);
+    CHECK(memcmp(received, payload, total) == 0);
+    CHECK(TinyCmd_Xfer_Poll() == TINYCMD_FAILED);
+}
+
+//Device sends****************************************************************//
+
+//Host receiver: the chunk being parsed
+static struct {
+    unsigned char state;
+    unsigned char seq;
+    unsigned char len;
+    unsigned char pos;
+    unsigned short crc;
+    unsigned char data[CMD_XFER_CHUNK];
+} host_rx;
+
+static unsigned long host_expected;
+static unsigned char host_nak_sent;
+
+static void host_reply(unsigned char type, unsigned char seq)
+{
+    const unsigned char reply[2] = {type, seq};
+    //A lost ACK is made up for by the next one, or by the NAK after the timeout
+    if (type == ACK && link_pick() != LINK_OK) {
+        return;
+    }
+    put_bytes(reply, 2);
+}
+
+static void host_frame(unsigned long total)
+{
+    unsigned long start = host_expected * CMD_XFER_CHUNK;
+
+    if (host_rx.crc == 0 && host_rx.seq == (unsigned char)host_expected && start < total) {
+        CHECK(host_rx.len == ((total - start < CMD_XFER_CHUNK) ? total - start : CMD_XFER_CHUNK));
+        memcpy(received + start, host_rx.data, host_rx.len);
+        host_reply(ACK, host_rx.seq);
+        host_expected++;
+        host_nak_sent = 0;
+    } else if (!host_nak_sent) {
+        host_reply(NAK, (unsigned char)host_expected);
+        host_nak_sent = 1;
+    }
+}
+
+static void host_byte(unsigned char c, unsigned long total)
+{
+    switch (host_rx.state) {
+        case 0:
+            if (c == SYNC) {
+                host_rx.crc = 0xFFFF;
+                host_rx.state = 1;
+            }
+            break;
+        case 1:
+            host_rx.seq = c;
+            host_rx.crc = crc16(host_rx.crc, c);
+            host_rx.state = 2;
+            break;
+        case 2:
+            host_rx.len = c;
+            host_rx.pos = 0;
+            host_rx.crc = crc16(host_rx.crc, c);
+            host_rx.state = (c == 0 || c > CMD_XFER_CHUNK) ? 0 : 3;
+            break;
+        case 3:
+            host_rx.data[host_rx.pos++] = c;
+            host_rx.crc = crc16(host_rx.crc, c);
+            if (host_rx.pos == host_rx.len) {
+                host_rx.state = 4;
+            }
+            break;
+        case 4:
+            host_rx.crc ^= c;
+            host_rx.state = 5;
+            break;
+        default:
+            host_rx.crc ^= (unsigned short)c << 8;
+            host_rx.state = 0;
+            host_frame(total);
+            break;
+    }
+}
+
+//Host side of a transfer out of the device started by TinyCmd_Xfer_Send() or "tx"
+static void host_receive(unsigned long total)
+{
+    static unsigned char wire[CMD_XFER_WINDOW * (CMD_XFER_CHUNK + 5)];
+    unsigned long rounds = 0;
+
+    memset(&host_rx, 0, sizeof(host_rx));
+    host_expected = 0;
+    host_nak_sent = 0;
+
+    while (rounds++ < MAX_ROUNDS) {
+        unsigned long len;
+
+        test_clear();
+        if (TinyCmd_Xfer_Poll() == TINYCMD_FAILED) {
+            break;
+        }
+        CHECK(test_out_len <= sizeof(wire));
+        len = test_out_len < sizeof(wire) ? test_out_len : sizeof(wire);
+        memcpy(wire, test_out, len);
+
+        if (len == 0) {
+            //Window full and nothing heard back: the host times out and NAKs the chunk it expects
+            memset(&host_rx, 0, sizeof(host_rx));
+            put_bytes((const unsigned char[]){NAK, (unsigned char)host_expected}, 2);
+            continue;
+        }
+        switch (link_pick()) {
+            case LINK_FLIP:
+            case LINK_CRC:
+                wire[rng() % len] ^= (unsigned char)(1u << (rng() % 8));
+                break;
+            case LINK_DROP:
+                len = 0;
+                break;
+            case LINK_SHORT:
+                len--;
+                break;
+            default:
+                break;
+        }
+        for (unsigned long i = 0; i < len; i++) {
+            host_byte(wire[i], total);
+        }
+    }
+    CHECK(rounds < MAX_ROUNDS);
+}
+
+static void check_send(unsigned long total, unsigned int rate)
+{
+    memset(received, 0, sizeof(received));
+    error_rate = rate;
+    CHECK(TinyCmd_Xfer_Send(payload, total) == TINYCMD_SUCCESS);
+    CHECK(TinyCmd_Xfer_Send(payload, total) == TINYCMD_FAILED);
+
+    host_receive(total);
+    CHECK(host_expected == CHUNKS(total));
+    CHECK(memcmp(received, payload, total) == 0);
+}
+
+//Commands and aborts*********************************************************//
+
+static int ping_count;
+
+static TinyCmd_CallBack_Ret ping_callback(void)
+{
+    ping_count++;
+    return TINYCMD_SUCCESS;
+}
+
+static TinyCmd_Command Ping = {.command = "ping", .callback = &ping_callback};
+
+static void check_commands(void)
+{
+    char line[64];
+
+    //rx: the port is binary until the last chunk, then lines run again
+    TinyCmd_XferSink = test_sink;
+    sink_next = 0;
+    error_rate = 0;
+    test_clear();
+    test_line("rx 1000\n");
+    CHECK(test_out_len == 2 && (unsigned char)test_out[0] == ACK && (unsigned char)test_out[1] == 0xFF);
+    test_line("ping\n");
+    CHECK(ping_count == 0);
+    host_send(1000);
+    CHECK(sink_next == 1000 && memcmp(received, payload, 1000) == 0);
+    test_line("ping\n");
+    CHECK(ping_count == 1);
+
+    //tx from an address given as text
+    snprintf(line, sizeof(line), "tx 0x%lx 777\n", (unsigned long)(uintptr_t)payload);
+    test_line(line);
+    host_receive(777);
+    CHECK(host_expected == CHUNKS(777) && memcmp(received, payload, 777) == 0);
+    test_line("ping\n");
+    CHECK(ping_count == 2);
+
+    //A sink that refuses a chunk aborts with CAN
+    sink_next = 0;
+    sink_refuse = TINYCMD_SUCCESS;
+    CHECK(TinyCmd_Xfer_Recv(test_sink, 500) == TINYCMD_SUCCESS);
+    test_clear();
+    host_chunk(0, 500);
+    CHECK(test_out_len == 2 && (unsigned char)test_out[0] == CAN && (unsigned char)test_out[1] == CAN);
+    CHECK(TinyCmd_Xfer_Poll() == TINYCMD_FAILED);
+    sink_refuse = TINYCMD_FAILED;
+
+    //Two CAN from the host abort a transfer, a single one does not. TinyCmd_Xfer_Abort sends two
+    CHECK(TinyCmd_Xfer_Recv(test_sink, 500) == TINYCMD_SUCCESS);
+    put_bytes((const unsigned char[]){CAN, SYNC, CAN, 0x00}, 4);
+    CHECK(TinyCmd_Xfer_Poll() == TINYCMD_SUCCESS);
+    put_bytes((const unsigned char[]){CAN, CAN}, 2);
+    CHECK(TinyCmd_Xfer_Poll() == TINYCMD_FAILED);
+    CHECK(TinyCmd_Xfer_Send(payload, 500) == TINYCMD_SUCCESS);
+    test_clear();
+    TinyCmd_Xfer_Abort();
+    CHECK(test_out_len == 2 && (unsigned char)test_out[0] == CAN && (unsigned char)test_out[1] == CAN);
+    CHECK(TinyCmd_Xfer_Poll() == TINYCMD_FAILED);
+
+    test_line("ping\n");
+    CHECK(ping_count == 3);
+}
+
+//Throughput******************************************************************//
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void throughput(void)
+{
+    double t = seconds();
+    for (int i = 0; i < 10; i++) {
+        check_receive(PAYLOAD_SIZE, 0);
+    }
+    t = seconds() - t;
+    printf("rx %lu bytes x10: %.1f MB/s, %lu chunk calls\n", PAYLOAD_SIZE, 10.0 * PAYLOAD_SIZE / t / 1e6, sink_calls);
+
+    t = seconds();
+    for (int i = 0; i < 10; i++) {
+        check_send(PAYLOAD_SIZE, 0);
+    }
+    t = seconds() - t;
+    printf("tx %lu bytes x10: %.1f MB/s\n", PAYLOAD_SIZE, 10.0 * PAYLOAD_SIZE / t / 1e6);
+    printf("wire overhead %.1f%% (5 bytes per %d byte chunk, 2 bytes per ACK)\n",
+           100.0 * (5.0 + 2.0) / CMD_XFER_CHUNK, CMD_XFER_CHUNK);
+}
+
+int main(void)
+{
+    TinyCmd_SendChar = test_send;
+    TinyCmd_Millis = test_millis;
+    TinyCmd_Add_Cmd(&Ping);
+    TinyCmd_Add_Cmd(&TinyCmd_Rx_Cmd);
+    TinyCmd_Add_Cmd(&TinyCmd_Tx_Cmd);
+    for (unsigned long i = 0; i < PAYLOAD_SIZE; i++) {
+        payload[i] = (unsigned char)rng();
+    }
+
+    //Sizes around the chunk and the 256 chunk wrap of the sequence number
+    check_receive(1, 0);
+    check_receive(CMD_XFER_CHUNK, 0);
+    check_receive(CMD_XFER_CHUNK + 1, 0);
+    check_receive(PAYLOAD_SIZE, 0);
+    check_send(1, 0);
+    check_send(CMD_XFER_CHUNK * CMD_XFER_WINDOW, 0);
+    check_send(PAYLOAD_SIZE, 0);
+
+    //Damaged links, every kind of error many times over
+    for (unsigned int rate = 2; rate <= 32; rate *= 2) {
+        check_receive(PAYLOAD_SIZE, rate);
+        check_send(PAYLOAD_SIZE, rate);
+    }
+    printf("%lu link errors injected\n", errors_injected);
+
+    check_commands();
+    throughput();
+    return test_end();
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 Civic_Crab
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+File: TinyCmd_Arduino_Sync.py
+
+Description:
+Copy TinyCmd.c and TinyCmd.h from the root of the repository into every Arduino sketch
+folder under Demo/Arduino that has a TinyCmd_Settings.h. The Arduino IDE builds a copy
+of the sketch folder, so the sketch can't include the core by a relative path.
+
+Usage:
+  python3 TinyCmd_Arduino_Sync.py           copy the core into the sketches
+  python3 TinyCmd_Arduino_Sync.py --check   only list the sketches whose copy is out of date, exit 1 if any
+"""
+
+import argparse
+import os
+import shutil
+import sys
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+SKETCHES = os.path.join(ROOT, "Demo", "Arduino")
+CORE = ("TinyCmd.c", "TinyCmd.h")
+
+
+def sketches():
+    for name in sorted(os.listdir(SKETCHES)):
+        path = os.path.join(SKETCHES, name)
+        if os.path.isfile(os.path.join(path, "TinyCmd_Settings.h")):
+            yield path
+
+
+def same(a, b):
+    if not os.path.isfile(b):
+        return False
+    with open(a, "rb") as fa, open(b, "rb") as fb:
+        return fa.read() == fb.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Copy the TinyCmd core into the Arduino sketches")
+    parser.add_argument("--check", action="store_true", help="only check that the copies are up to date")
+    args = parser.parse_args()
+
+    stale = 0
+    for sketch in sketches():
+        for name in CORE:
+            src = os.path.join(ROOT, name)
+            dst = os.path.join(sketch, name)
+            if same(src, dst):
+                continue
+            rel = os.path.relpath(dst, ROOT)
+            if args.check:
+                print("%s: out of date, run make arduino" % rel)
+                stale += 1
+            else:
+                shutil.copyfile(src, dst)
+                print("%s: copied" % rel)
+
+    return 1 if stale else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
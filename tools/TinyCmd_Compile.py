@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 Civic_Crab
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+File: TinyCmd_Compile.py
+
+Description:
+Compile a TinyCmd script (one command per line, '#' comments) into the binary
+form run by TinyCmd_Compiled_Run() (CMD_USE_SCRIPT).
+
+  The command names are stored once and looked up by TinyCmd_Compiled_Load().
+  Every argument keeps its text for TinyCmd_Arg_Check() and keywords, and the
+  results of the number parsers of TinyCmd.c (str_to_uint, str_to_float) are
+  stored next to it, so TinyCmd_Arg_To_Num() gives the same values as for the
+  text without parsing it.
+
+Usage:
+  python3 TinyCmd_Compile.py script.txt -o script.tcs
+  python3 TinyCmd_Compile.py script.txt -o script.h --c-array Bringup_Script
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"TCS"
+VERSION = 1
+
+COMPILED_UINT = 0x01
+COMPILED_NEGATIVE = 0x02
+COMPILED_FLOAT = 0x04   # the value is the signed magnitude
+COMPILED_DOUBLE = 0x08  # the value follows as a double
+
+U64 = (1 << 64) - 1
+
+
+def str_to_uint(text):
+    """Same as str_to_uint() in TinyCmd.c: (magnitude, negative), None on overflow or a bare 0x."""
+    i = 0
+    negative = False
+    if text[i:i + 1] == "-":
+        negative = True
+        i += 1
+    elif text[i:i + 1] == "+":
+        i += 1
+
+    result = 0
+    if text[i:i + 1] == "0" and text[i + 1:i + 2].lower() == "x":
+        i += 2
+        digits = i
+        while i < len(text) and text[i].lower() in "0123456789abcdef":
+            if result >> 60:
+                return None
+            result = (result << 4) | int(text[i], 16)
+            i += 1
+        if i == digits:
+            return None
+        return result, negative
+
+    while i < len(text) and text[i] in "0123456789":
+        new_result = (result * 10 + int(text[i])) & U64
+        if new_result < result:
+            return None
+        result = new_result
+        i += 1
+    return result, negative
+
+
+def pow10(exponent):
+    """Same as TinyCmd_pow(10.0, exponent): exponentiation by squaring."""
+    if exponent == 0:
+        return 1.0
+    result = 1.0
+    base = 10.0
+    n = abs(exponent)
+    while n > 0:
+        if n % 2 == 1:
+            result *= base
+        base *= base
+        n //= 2
+    return 1.0 / result if exponent < 0 else result
+
+
+def str_to_float(text):
+    """Same as str_to_float() in TinyCmd.c, done in the same order on doubles. None if it fails."""
+    i = 0
+    n = len(text)
+    while i < n and text[i] in " \t\n\v\f\r":
+        i += 1
+    sign = 1.0
+    if text[i:i + 1] == "-":
+        sign = -1.0
+        i += 1
+    elif text[i:i + 1] == "+":
+        i += 1
+
+    value = 0.0
+    while i < n and text[i] in "0123456789":
+        value = value * 10.0 + (ord(text[i]) - 48)
+        i += 1
+
+    fractional = 0.0
+    if text[i:i + 1] == ".":
+        i += 1
+        place = 0.1
+        while i < n and text[i] in "0123456789":
+            fractional += (ord(text[i]) - 48) * place
+            place *= 0.1
+            i += 1
+
+    exponent = 0.0
+    exponent_sign = 1.0
+    if text[i:i + 1].lower() == "e":
+        i += 1
+        if text[i:i + 1] == "-":
+            exponent_sign = -1.0
+            i += 1
+        elif text[i:i + 1] == "+":
+            i += 1
+        while i < n and text[i] in "0123456789":
+            if exponent < 1000.0:
+                exponent = exponent * 10.0 + (ord(text[i]) - 48)
+            i += 1
+
+    value = (value + fractional) * sign
+    result = value * pow10(int(exponent * exponent_sign))
+    return result if i == n else None
+
+
+def compile_arg(text):
+    raw = text.encode("ascii")
+    if len(raw) > 255:
+        raise ValueError("argument longer than 255 characters: " + text[:16] + "...")
+    flags = 0
+    magnitude = 0
+    negative = text.startswith("-")
+    parsed = str_to_uint(text)
+    if parsed is not None:
+        magnitude, negative = parsed
+        flags |= COMPILED_UINT
+    if negative:
+        flags |= COMPILED_NEGATIVE
+    # The magnitude in as few bytes as it needs, the count is in the upper bits of flags
+    tail = magnitude.to_bytes(8, "little").rstrip(b"\0")
+    flags |= len(tail) << 4
+
+    value = str_to_float(text)
+    if value is not None:
+        # An integer is rebuilt from the magnitude by the device, compare the bits to keep -0.0 and the rounding
+        same = float(magnitude) * (-1.0 if negative else 1.0)
+        if struct.pack("<d", same) == struct.pack("<d", value):
+            flags |= COMPILED_FLOAT
+        else:
+            flags |= COMPILED_DOUBLE
+            tail += struct.pack("<d", value)
+    return bytes([flags, len(raw)]) + raw + b"\0" + tail
+
+
+def compile_script(lines, max_params):
+    names = []
+    index = {}
+    body = bytearray()
+    for number, line in enumerate(lines, 1):
+        line = line.strip(" \r\n")
+        if not line or line.startswith("#"):
+            continue
+        words = [w for w in line.split(" ") if w]
+        name, args = words[0], words[1:]
+        if len(args) > max_params:
+            raise ValueError("line %d: more than %d arguments" % (number, max_params))
+        if name not in index:
+            if len(names) == 255:
+                raise ValueError("line %d: more than 255 command names" % number)
+            index[name] = len(names)
+            names.append(name)
+        body += bytes([index[name], len(args)])
+        for arg in args:
+            body += compile_arg(arg)
+
+    head = MAGIC + bytes([VERSION, len(names)])
+    for name in names:
+        head += name.encode("ascii") + b"\0"
+    return head + bytes(body)
+
+
+def c_array(name, data):
+    out = ["//Compiled by tools/TinyCmd_Compile.py, run it by TinyCmd_Compiled_Load() and TinyCmd_Compiled_Run()",
+           "const unsigned char %s[%d] = {" % (name, len(data))]
+    for i in range(0, len(data), 16):
+        out.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile a TinyCmd script for TinyCmd_Compiled_Run()")
+    parser.add_argument("script", nargs="?", help="text script, stdin when it is omitted")
+    parser.add_argument("-o", "--output", required=True, help="compiled script")
+    parser.add_argument("--c-array", metavar="NAME", help="write a C array named NAME instead of binary")
+    parser.add_argument("--max-params", type=int, default=3, help="CMD_MAX_PARAMS of the device, default 3")
+    args = parser.parse_args()
+
+    src = open(args.script) if args.script else sys.stdin
+    with src:
+        try:
+            data = compile_script(src, args.max_params)
+        except ValueError as e:
+            sys.exit(str(e))
+
+    if args.c_array:
+        with open(args.output, "w") as f:
+            f.write(c_array(args.c_array, data))
+    else:
+        with open(args.output, "wb") as f:
+            f.write(data)
+
+
+if __name__ == "__main__":
+    main()
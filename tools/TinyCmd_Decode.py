@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 Civic_Crab
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+File: TinyCmd_Decode.py
+
+Description:
+Host side decoder for the TinyCmd binary outputs.
+
+  stream: decode the "stream" command output (binary frames or delta text)
+          into CSV rows, one row per sample.
+  defer:  rebuild the text of TinyCmd_Report_Id() frames from the format
+          table, other output is passed through.
+
+Usage:
+  python3 TinyCmd_Decode.py stream [--text] [--long-bits 32] [--scale 1,100] [input]
+  python3 TinyCmd_Decode.py defer --table formats.h [--long-bits 32] [input]
+
+The input is a capture file of the serial port, or stdin when it is omitted.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+STREAM_FRAME_SYNC = 0xA5
+DEFER_FRAME_SYNC = 0xA6
+
+# X(ID, "format") entries of a TINYCMD_FMT_ENUM/TINYCMD_FMT_TABLE list
+FMT_ENTRY = re.compile(r'\(\s*[A-Za-z_]\w*\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+# Conversions of TinyCmd_Report: flags, width, precision, length, conversion
+FMT_CONV = re.compile(r"%([-0]*)(\d*)(\.\d*)?(l{0,2})([diuxXocsf%])?", re.S)
+
+
+def stream_bin_rows(data, stats):
+    """Yield the sample rows of the binary stream frames found in data."""
+    pos = 0
+    last_seq = None
+    while pos + 3 <= len(data):
+        if data[pos] != STREAM_FRAME_SYNC:
+            pos += 1
+            continue
+        seq, n = data[pos + 1], data[pos + 2]
+        end = pos + 3 + 4 * n
+        if end >= len(data):
+            break
+        check = 0
+        for b in data[pos + 1:end]:
+            check ^= b
+        if check != data[end]:
+            stats["bad"] += 1
+            pos += 1
+            continue
+        if last_seq is not None and seq != (last_seq + 1) & 0xFF:
+            stats["lost"] += (seq - last_seq - 1) & 0xFF
+        last_seq = seq
+        yield struct.unpack("<%di" % n, bytes(data[pos + 3:end]))
+        pos = end + 1
+
+
+def stream_text_rows(data, stats, bits=32):
+    """Yield the sample rows of the delta encoded text stream found in data.
+
+    The deltas wrap around modulo the width of long on the target (bits).
+    """
+    span = 1 << bits
+    half = span >> 1
+    last = None
+    for raw in data.decode("ascii", "replace").splitlines():
+        line = raw.strip()
+        if not line:
+            continue
+        key = line.startswith("=")
+        fields = (line[1:] if key else line).split(",")
+        try:
+            values = [int(f) if f else 0 for f in fields]
+        except ValueError:
+            # Not a stream row, such as a command echo
+            continue
+        if key:
+            last = values
+        elif last is None or len(values) != len(last):
+            # Wait for the next keyframe
+            stats["bad"] += 1
+            continue
+        else:
+            last = [(a + d + half) % span - half for a, d in zip(last, values)]
+        yield tuple(last)
+
+
+def cmd_stream(args, data):
+    stats = {"bad": 0, "lost": 0}
+    scale = [float(s) for s in args.scale.split(",")] if args.scale else []
+    if args.text:
+        rows = stream_text_rows(data, stats, args.long_bits)
+    else:
+        rows = stream_bin_rows(data, stats)
+    out = sys.stdout
+    for row in rows:
+        values = []
+        for i, v in enumerate(row):
+            values.append(repr(v / scale[i]) if i < len(scale) and scale[i] != 1 else str(v))
+        out.write(",".join(values) + "\n")
+    sys.stderr.write("bad frames %d, lost frames %d\n" % (stats["bad"], stats["lost"]))
+
+
+def load_formats(path):
+    """Read the format strings of the X(ID, "format") table in path, in order."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    formats = []
+    for m in FMT_ENTRY.finditer(text):
+        formats.append(m.group(1).encode("latin-1").decode("unicode_escape"))
+    return formats
+
+
+def defer_frame(data, pos, formats, long_bits=32):
+    """Decode the frame starting at data[pos], return (text, next pos) or None."""
+    if pos + 2 > len(data) or data[pos + 1] >= len(formats):
+        return None
+    fmt = formats[data[pos + 1]]
+    pos += 2
+    out = []
+    last = 0
+    for m in FMT_CONV.finditer(fmt):
+        flags, width, precision, length, conv = m.groups()
+        end = m.end()
+        if conv is None:
+            if precision is None or length:
+                continue
+            # "%.N" followed by any other character is "%.Nf", that character is dropped
+            conv = "f"
+            end = min(end + 1, len(fmt))
+        out.append(fmt[last:m.start()])
+        last = end
+        if precision is not None and conv != "f":
+            precision = None
+        spec = "%" + flags + width + (precision or "")
+        if conv in "diuxXo":
+            size = 8 if length == "ll" else long_bits // 8 if length == "l" else 4
+            if pos + size > len(data):
+                return None
+            value = int.from_bytes(data[pos:pos + size], "little", signed=conv in "di")
+            pos += size
+            out.append((spec + ("d" if conv in "diu" else conv)) % value)
+        elif conv == "c":
+            if pos + 1 > len(data):
+                return None
+            out.append((spec + "c") % chr(data[pos]))
+            pos += 1
+        elif conv == "f":
+            if pos + 4 > len(data):
+                return None
+            out.append((spec + "f") % struct.unpack("<f", bytes(data[pos:pos + 4]))[0])
+            pos += 4
+        elif conv == "s":
+            end = data.find(b"\0", pos)
+            if end < 0:
+                return None
+            out.append((spec + "s") % data[pos:end].decode("latin-1"))
+            pos = end + 1
+        else:
+            out.append("%")
+    out.append(fmt[last:])
+    return "".join(out), pos
+
+
+def cmd_defer(args, data):
+    formats = load_formats(args.table)
+    out = sys.stdout
+    pos = 0
+    while pos < len(data):
+        if data[pos] == DEFER_FRAME_SYNC:
+            frame = defer_frame(data, pos, formats, args.long_bits)
+            if frame is not None:
+                out.write(frame[0])
+                pos = frame[1]
+                continue
+        out.write(chr(data[pos]))
+        pos += 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode TinyCmd binary outputs")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("stream", help="decode the stream command output")
+    p.add_argument("--text", action="store_true", help="input is delta encoded text")
+    p.add_argument("--long-bits", type=int, default=32, help="width of long on the target, 32 or 64 (text mode)")
+    p.add_argument("--scale", help="comma separated scale of each streamed variable")
+    p.add_argument("input", nargs="?", help="capture file")
+    p.set_defaults(func=cmd_stream)
+
+    p = sub.add_parser("defer", help="decode TinyCmd_Report_Id() output")
+    p.add_argument("--table", required=True, help="source file of the format table")
+    p.add_argument("--long-bits", type=int, default=32, help="width of long on the target, 32 or 64")
+    p.add_argument("input", nargs="?", help="capture file")
+    p.set_defaults(func=cmd_defer)
+
+    args = parser.parse_args()
+    if args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    args.func(args, data)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 Civic_Crab
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+File: TinyCmd_Footprint.py
+
+Description:
+Print the static memory footprint of TinyCmd.c for each configuration profile.
+
+  flash: text + data of the object file
+  RAM:   data + bss of the object file
+  stack: deepest call path from TinyCmd_Handler and TinyCmd_Report, from the
+         call graph written by GCC (-fcallgraph-info=su, GCC 10 or later).
+         Callbacks called through pointers are not included.
+
+Usage:
+  python3 TinyCmd_Footprint.py [--cc gcc] [--cflags "-Os"] [--profile NAME=-DFLAG ...]
+  python3 TinyCmd_Footprint.py --cc avr-gcc --cflags "-Os -mmcu=atmega328p"
+"""
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+PROFILES = [
+    ("default", []),
+    ("min", ["-DCMD_PROFILE_MIN"]),
+    ("full", ["-DCMD_USE_STREAM", "-DCMD_USE_DUMP", "-DCMD_USE_XFER", "-DCMD_USE_DEFER_REPORT", "-DCMD_USE_ABBREV",
+              "-DCMD_USE_SUB", "-DCMD_USE_LINE_EDIT", "-DCMD_USE_ALIAS", "-DCMD_USE_SCRIPT", "-DCMD_USE_CACHE",
+              "-DCMD_USE_PRIORITY", "-DCMD_USE_FLOW", "-DCMD_USE_TIMING"]),
+]
+
+ENTRIES = ("TinyCmd_Handler", "TinyCmd_Report")
+
+CI_NODE = re.compile(r'node: \{ title: "([^"]+)" label: "[^"]*\\n(\d+) bytes')
+CI_EDGE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+
+
+def size_tool(cc):
+    """avr-gcc -> avr-size, arm-none-eabi-gcc -> arm-none-eabi-size, gcc -> size"""
+    prefix = cc[:-len("gcc")] if cc.endswith("gcc") else ""
+    return prefix + "size"
+
+
+def object_size(size, obj):
+    out = subprocess.run([size, obj], check=True, capture_output=True, text=True).stdout
+    text, data, bss = (int(v) for v in out.splitlines()[1].split()[:3])
+    return text, data, bss
+
+
+def stack_depth(ci_file):
+    """Deepest stack of the entry functions, walking the call graph."""
+    frames = {}
+    calls = {}
+    with open(ci_file) as f:
+        for line in f:
+            m = CI_NODE.match(line)
+            if m:
+                frames[m.group(1)] = int(m.group(2))
+                continue
+            m = CI_EDGE.match(line)
+            if m:
+                calls.setdefault(m.group(1), set()).add(m.group(2))
+
+    def depth(node, path):
+        if node in path:
+            return 0  # recursion, counted once
+        best = 0
+        for callee in calls.get(node, ()):
+            best = max(best, depth(callee, path | {node}))
+        return frames.get(node, 0) + best
+
+    result = {}
+    for node in frames:
+        name = node.rsplit(":", 1)[-1]
+        if name in ENTRIES:
+            result[name] = depth(node, frozenset())
+    return result
+
+
+def measure(cc, cflags, defines, tmp):
+    obj = os.path.join(tmp, "TinyCmd.o")
+    cmd = [cc] + cflags + defines + ["-I", ROOT, "-c", os.path.join(ROOT, "TinyCmd.c"), "-o", obj,
+                                     "-fcallgraph-info=su"]
+    subprocess.run(cmd, check=True, cwd=tmp)
+    text, data, bss = object_size(size_tool(cc), obj)
+    ci = [f for f in os.listdir(tmp) if f.endswith(".ci")]
+    stack = stack_depth(os.path.join(tmp, ci[0])) if ci else {}
+    return text + data, data + bss, stack
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Print the RAM, flash and stack usage of the TinyCmd profiles")
+    parser.add_argument("--cc", default="gcc", help="C compiler, e.g. avr-gcc or arm-none-eabi-gcc")
+    parser.add_argument("--cflags", default="-Os", help="compiler flags")
+    parser.add_argument("--profile", action="append", default=[], metavar="NAME=-DFLAG,-DFLAG",
+                        help="measure another profile")
+    args = parser.parse_args()
+
+    profiles = list(PROFILES)
+    for p in args.profile:
+        name, _, flags = p.partition("=")
+        profiles.append((name, [f for f in flags.split(",") if f]))
+
+    if shutil.which(args.cc) is None:
+        sys.exit("compiler not found: " + args.cc)
+
+    print("%-10s %8s %8s %10s %10s" % ("profile", "flash", "RAM", "stack:Hdl", "stack:Rpt"))
+    for name, defines in profiles:
+        tmp = tempfile.mkdtemp()
+        try:
+            flash, ram, stack = measure(args.cc, args.cflags.split(), defines, tmp)
+        finally:
+            shutil.rmtree(tmp, ignore_errors=True)
+        print("%-10s %8d %8d %10s %10s" % (name, flash, ram,
+                                           stack.get("TinyCmd_Handler", "-"), stack.get("TinyCmd_Report", "-")))
+
+
+if __name__ == "__main__":
+    main()